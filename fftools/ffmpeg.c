@@ -71,6 +71,7 @@
 #include "libavutil/bprint.h"
 #include "libavutil/dict.h"
 #include "libavutil/mem.h"
+#include "libavutil/threadpool.h"
 #include "libavutil/time.h"
 
 #include "libavformat/avformat.h"
@@ -339,12 +340,15 @@ static void ffmpeg_cleanup(int ret)
     hw_device_free_all();
 
     av_freep(&filter_nbthreads);
+    av_freep(&filter_thread_type);
 
     av_freep(&input_files);
     av_freep(&output_files);
 
     uninit_opts();
 
+    av_thread_pool_set_shared(0);
+
     avformat_network_deinit();
 
     if (received_sigterm) {
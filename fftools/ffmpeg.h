@@ -731,6 +731,7 @@ extern float max_error_rate;
 
 extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern char *filter_thread_type;
 extern int vstats_version;
 extern int auto_conversion_filters;
 
@@ -1896,6 +1896,12 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
     if (!fgt->graph)
         return AVERROR(ENOMEM);
 
+    if (filter_thread_type) {
+        ret = av_opt_set(fgt->graph, "thread_type", filter_thread_type, 0);
+        if (ret < 0)
+            goto fail;
+    }
+
     if (simple) {
         OutputFilterPriv *ofp = ofp_from_ofilter(fg->outputs[0]);
 
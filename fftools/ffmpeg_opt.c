@@ -42,11 +42,13 @@
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/avutil.h"
+#include "libavutil/cpu.h"
 #include "libavutil/mathematics.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/stereo3d.h"
+#include "libavutil/threadpool.h"
 
 HWDevice *filter_hw_device;
 
@@ -75,6 +77,7 @@ int stdin_interaction = 1;
 float max_error_rate  = 2.0/3;
 char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
+char *filter_thread_type;
 int vstats_version = 2;
 int auto_conversion_filters = 1;
 int64_t stats_period = 500000;
@@ -414,6 +417,44 @@ static int opt_filter_threads(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_filter_thread_type(void *optctx, const char *opt, const char *arg)
+{
+    av_free(filter_thread_type);
+    filter_thread_type = av_strdup(arg);
+    return filter_thread_type ? 0 : AVERROR(ENOMEM);
+}
+
+static int opt_task_slots(void *optctx, const char *opt, const char *arg)
+{
+    Scheduler *sch = optctx;
+    int nb_slots;
+
+    if (!strcmp(arg, "auto")) {
+        nb_slots = av_cpu_count();
+    } else {
+        double num;
+        int ret = parse_number(opt, arg, OPT_TYPE_INT, 0, INT_MAX, &num);
+        if (ret < 0)
+            return ret;
+        nb_slots = num;
+    }
+
+    sch_set_task_slots(sch, nb_slots);
+    return 0;
+}
+
+static int opt_shared_threads(void *optctx, const char *opt, const char *arg)
+{
+    double nb_threads;
+    int ret;
+
+    ret = parse_number(opt, arg, OPT_TYPE_INT, 0, INT_MAX, &nb_threads);
+    if (ret < 0)
+        return ret;
+
+    return av_thread_pool_set_shared(nb_threads);
+}
+
 static int opt_abort_on(void *optctx, const char *opt, const char *arg)
 {
     static const AVOption opts[] = {
@@ -1683,6 +1724,15 @@ const OptionDef options[] = {
     { "filter_complex_threads", OPT_TYPE_INT, OPT_EXPERT,
         { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "filter_thread_type",     OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_filter_thread_type },
+        "allowed threading types of filtergraphs", "types" },
+    { "task_slots",             OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_task_slots },
+        "maximum number of simultaneously running decoding/filtering/encoding tasks", "number|auto" },
+    { "shared_threads",         OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_shared_threads },
+        "run slice threading of all codecs, filters and scalers on one pool of this many threads", "number" },
     { "lavfi",               OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
         { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
@@ -69,6 +69,10 @@ typedef struct SchTask {
 
     pthread_t           thread;
     int                 thread_running;
+
+    // this task currently occupies one of Scheduler.task_slots;
+    // only accessed from the task's own thread
+    int                 has_slot;
 } SchTask;
 
 typedef struct SchDecOutput {
@@ -311,21 +315,142 @@ struct Scheduler {
     pthread_mutex_t     schedule_lock;
 
     atomic_int_least64_t last_dts;
+
+    /* Bounded pool of run slots for CPU-bound tasks, see task_slot_acquire().
+     * nb_task_slots == 0 means that the number of running tasks is unlimited.
+     * task_slots_free is protected by task_slots_lock and may become negative
+     * when tasks reclaim their slot after a blocking send. */
+    int                 nb_task_slots;
+    int                 task_slots_free;
+    pthread_mutex_t     task_slots_lock;
+    pthread_cond_t      task_slots_cond;
 };
 
+/**
+ * Obtain a run slot for the task, if the scheduler is limiting the number of
+ * simultaneously running tasks.
+ *
+ * Only decoders, filtergraphs and encoders compete for slots; demuxers and
+ * muxers spend most of their time in I/O and always run freely.
+ *
+ * @param wait if 0, the slot is taken even if none are free. This must be used
+ *             when the caller might be holding a lock other tasks can wait on,
+ *             otherwise a deadlock could occur.
+ */
+static void task_slot_acquire(SchTask *task, int wait)
+{
+    Scheduler *sch = task->parent;
+
+    if (!sch->nb_task_slots || task->has_slot ||
+        task->node.type == SCH_NODE_TYPE_DEMUX ||
+        task->node.type == SCH_NODE_TYPE_MUX)
+        return;
+
+    pthread_mutex_lock(&sch->task_slots_lock);
+
+    while (wait && sch->task_slots_free <= 0 && !atomic_load(&sch->terminate))
+        pthread_cond_wait(&sch->task_slots_cond, &sch->task_slots_lock);
+
+    sch->task_slots_free--;
+    task->has_slot = 1;
+
+    pthread_mutex_unlock(&sch->task_slots_lock);
+}
+
+static void task_slot_release(SchTask *task)
+{
+    Scheduler *sch;
+
+    if (!task || !task->has_slot)
+        return;
+
+    sch = task->parent;
+
+    pthread_mutex_lock(&sch->task_slots_lock);
+
+    if (++sch->task_slots_free > 0)
+        pthread_cond_signal(&sch->task_slots_cond);
+    task->has_slot = 0;
+
+    pthread_mutex_unlock(&sch->task_slots_lock);
+}
+
+/**
+ * Send data to a thread queue on behalf of a task, giving up the task's run
+ * slot for the time the send blocks on a full queue (whose consumer may itself
+ * be waiting for a slot).
+ *
+ * @param task the sending task, NULL when not called from any task's thread
+ */
+static int task_tq_send(SchTask *task, ThreadQueue *tq, unsigned int stream_idx,
+                        void *data)
+{
+    int had_slot = task && task->has_slot;
+    int ret;
+
+    if (had_slot)
+        task_slot_release(task);
+
+    ret = tq_send(tq, stream_idx, data);
+
+    // the sender may be holding locks here, so it must not wait for a slot
+    if (had_slot)
+        task_slot_acquire(task, 0);
+
+    return ret;
+}
+
+/**
+ * Lock a mutex that may be held by another task while it is blocked in
+ * task_tq_send(). The slot must be given up for the duration of the wait,
+ * since the thread queue consumer that the lock holder waits for might need it.
+ */
+static void task_mutex_lock(SchTask *task, pthread_mutex_t *mutex)
+{
+    int had_slot = task && task->has_slot;
+
+    if (had_slot)
+        task_slot_release(task);
+
+    pthread_mutex_lock(mutex);
+
+    if (had_slot)
+        task_slot_acquire(task, 0);
+}
+
+/**
+ * Receive from a thread queue on behalf of a task. The task gives up its run
+ * slot while waiting for input and waits for a free slot once it gets some.
+ */
+static int task_tq_receive(SchTask *task, ThreadQueue *tq, int *stream_idx,
+                           void *data)
+{
+    int ret;
+
+    task_slot_release(task);
+
+    ret = tq_receive(tq, stream_idx, data);
+
+    task_slot_acquire(task, 1);
+
+    return ret;
+}
+
 /**
  * Wait until this task is allowed to proceed.
  *
  * @retval 0 the caller should proceed
  * @retval 1 the caller should terminate
  */
-static int waiter_wait(Scheduler *sch, SchWaiter *w)
+static int waiter_wait(Scheduler *sch, SchTask *task, SchWaiter *w)
 {
     int terminate;
 
     if (!atomic_load(&w->choked))
         return 0;
 
+    task_slot_release(task);
+
     pthread_mutex_lock(&w->lock);
 
     while (atomic_load(&w->choked) && !atomic_load(&sch->terminate))
@@ -335,6 +460,8 @@ static int waiter_wait(Scheduler *sch, SchWaiter *w)
 
     pthread_mutex_unlock(&w->lock);
 
+    task_slot_acquire(task, 1);
+
     return terminate;
 }
 
@@ -574,6 +701,9 @@ void sch_free(Scheduler **psch)
     pthread_mutex_destroy(&sch->mux_done_lock);
     pthread_cond_destroy(&sch->mux_done_cond);
 
+    pthread_mutex_destroy(&sch->task_slots_lock);
+    pthread_cond_destroy(&sch->task_slots_cond);
+
     av_freep(psch);
 }
 
@@ -610,12 +740,28 @@ Scheduler *sch_alloc(void)
     if (ret)
         goto fail;
 
+    ret = pthread_mutex_init(&sch->task_slots_lock, NULL);
+    if (ret)
+        goto fail;
+
+    ret = pthread_cond_init(&sch->task_slots_cond, NULL);
+    if (ret)
+        goto fail;
+
     return sch;
 fail:
     sch_free(&sch);
     return NULL;
 }
 
+void sch_set_task_slots(Scheduler *sch, int nb_slots)
+{
+    av_assert0(sch->state == SCH_STATE_UNINIT);
+
+    sch->nb_task_slots   = FFMAX(nb_slots, 0);
+    sch->task_slots_free = sch->nb_task_slots;
+}
+
 int sch_sdp_filename(Scheduler *sch, const char *sdp_filename)
 {
     av_freep(&sch->sdp_filename);
@@ -1659,7 +1805,7 @@ int sch_wait(Scheduler *sch, uint64_t timeout_us, int64_t *transcode_ts)
     return ret || err;
 }
 
-static int enc_open(Scheduler *sch, SchEnc *enc, const AVFrame *frame)
+static int enc_open(Scheduler *sch, SchTask *task, SchEnc *enc, const AVFrame *frame)
 {
     int ret;
 
@@ -1675,7 +1821,7 @@ static int enc_open(Scheduler *sch, SchEnc *enc, const AVFrame *frame)
         av_assert0(enc->sq_idx[0] >= 0);
         sq = &sch->sq_enc[enc->sq_idx[0]];
 
-        pthread_mutex_lock(&sq->lock);
+        task_mutex_lock(task, &sq->lock);
 
         sq_frame_samples(sq->sq, enc->sq_idx[1], ret);
 
@@ -1685,7 +1831,8 @@ static int enc_open(Scheduler *sch, SchEnc *enc, const AVFrame *frame)
     return 0;
 }
 
-static int send_to_enc_thread(Scheduler *sch, SchEnc *enc, AVFrame *frame)
+static int send_to_enc_thread(Scheduler *sch, SchTask *task,
+                              SchEnc *enc, AVFrame *frame)
 {
     int ret;
 
@@ -1697,14 +1844,15 @@ static int send_to_enc_thread(Scheduler *sch, SchEnc *enc, AVFrame *frame)
     if (enc->in_finished)
         return AVERROR_EOF;
 
-    ret = tq_send(enc->queue, 0, frame);
+    ret = task_tq_send(task, enc->queue, 0, frame);
     if (ret < 0)
         enc->in_finished = 1;
 
     return ret;
 }
 
-static int send_to_enc_sq(Scheduler *sch, SchEnc *enc, AVFrame *frame)
+static int send_to_enc_sq(Scheduler *sch, SchTask *task,
+                          SchEnc *enc, AVFrame *frame)
 {
     SchSyncQueue *sq = &sch->sq_enc[enc->sq_idx[0]];
     int ret = 0;
@@ -1734,7 +1882,7 @@ static int send_to_enc_sq(Scheduler *sch, SchEnc *enc, AVFrame *frame)
         }
     }
 
-    pthread_mutex_lock(&sq->lock);
+    task_mutex_lock(task, &sq->lock);
 
     ret = sq_send(sq->sq, enc->sq_idx[1], SQFRAME(frame));
     if (ret < 0)
@@ -1752,7 +1900,7 @@ static int send_to_enc_sq(Scheduler *sch, SchEnc *enc, AVFrame *frame)
         }
 
         enc = &sch->enc[sq->enc_idx[ret]];
-        ret = send_to_enc_thread(sch, enc, sq->frame);
+        ret = send_to_enc_thread(sch, task, enc, sq->frame);
         if (ret < 0) {
             av_frame_unref(sq->frame);
             if (ret != AVERROR_EOF)
@@ -1766,7 +1914,7 @@ static int send_to_enc_sq(Scheduler *sch, SchEnc *enc, AVFrame *frame)
     if (ret < 0) {
         // close all encoders fed from this sync queue
         for (unsigned i = 0; i < sq->nb_enc_idx; i++) {
-            int err = send_to_enc_thread(sch, &sch->enc[sq->enc_idx[i]], NULL);
+            int err = send_to_enc_thread(sch, task, &sch->enc[sq->enc_idx[i]], NULL);
 
             // if the sync queue error is EOF and closing the encoder
             // produces a more serious error, make sure to pick the latter
@@ -1780,10 +1928,11 @@ finish:
     return ret;
 }
 
-static int send_to_enc(Scheduler *sch, SchEnc *enc, AVFrame *frame)
+static int send_to_enc(Scheduler *sch, SchTask *task,
+                       SchEnc *enc, AVFrame *frame)
 {
     if (enc->open_cb && frame && !enc->opened) {
-        int ret = enc_open(sch, enc, frame);
+        int ret = enc_open(sch, task, enc, frame);
         if (ret < 0)
             return ret;
         enc->opened = 1;
@@ -1795,9 +1944,9 @@ static int send_to_enc(Scheduler *sch, SchEnc *enc, AVFrame *frame)
         }
     }
 
-    return (enc->sq_idx[0] >= 0)                ?
-           send_to_enc_sq    (sch, enc, frame)  :
-           send_to_enc_thread(sch, enc, frame);
+    return (enc->sq_idx[0] >= 0)                      ?
+           send_to_enc_sq    (sch, task, enc, frame)  :
+           send_to_enc_thread(sch, task, enc, frame);
 }
 
 static int mux_queue_packet(SchMux *mux, SchMuxStream *ms, AVPacket *pkt)
@@ -1836,8 +1985,8 @@ static int mux_queue_packet(SchMux *mux, SchMuxStream *ms, AVPacket *pkt)
     return 0;
 }
 
-static int send_to_mux(Scheduler *sch, SchMux *mux, unsigned stream_idx,
-                       AVPacket *pkt)
+static int send_to_mux(Scheduler *sch, SchTask *task, SchMux *mux,
+                       unsigned stream_idx, AVPacket *pkt)
 {
     SchMuxStream *ms = &mux->streams[stream_idx];
     int64_t dts = (pkt && pkt->dts != AV_NOPTS_VALUE)                                    ?
@@ -1871,7 +2020,7 @@ static int send_to_mux(Scheduler *sch, SchMux *mux, unsigned stream_idx,
         if (ms->init_eof)
             return AVERROR_EOF;
 
-        ret = tq_send(mux->queue, stream_idx, pkt);
+        ret = task_tq_send(task, mux->queue, stream_idx, pkt);
         if (ret < 0)
             return ret;
     } else
@@ -1913,7 +2062,7 @@ demux_stream_send_to_dst(Scheduler *sch, const SchedulerNode dst,
         goto finish;
 
     ret = (dst.type == SCH_NODE_TYPE_MUX) ?
-          send_to_mux(sch, &sch->mux[dst.idx], dst.idx_stream, pkt) :
+          send_to_mux(sch, NULL, &sch->mux[dst.idx], dst.idx_stream, pkt) :
           tq_send(sch->dec[dst.idx].queue, 0, pkt);
     if (ret == AVERROR_EOF)
         goto finish;
@@ -1922,7 +2071,7 @@ demux_stream_send_to_dst(Scheduler *sch, const SchedulerNode dst,
 
 finish:
     if (dst.type == SCH_NODE_TYPE_MUX)
-        send_to_mux(sch, &sch->mux[dst.idx], dst.idx_stream, NULL);
+        send_to_mux(sch, NULL, &sch->mux[dst.idx], dst.idx_stream, NULL);
     else
         tq_send_finish(sch->dec[dst.idx].queue, 0);
 
@@ -2015,7 +2164,7 @@ int sch_demux_send(Scheduler *sch, unsigned demux_idx, AVPacket *pkt,
     av_assert0(demux_idx < sch->nb_demux);
     d = &sch->demux[demux_idx];
 
-    terminate = waiter_wait(sch, &d->waiter);
+    terminate = waiter_wait(sch, &d->task, &d->waiter);
     if (terminate)
         return AVERROR_EXIT;
 
@@ -2058,7 +2207,7 @@ int sch_mux_receive(Scheduler *sch, unsigned mux_idx, AVPacket *pkt)
     av_assert0(mux_idx < sch->nb_mux);
     mux = &sch->mux[mux_idx];
 
-    ret = tq_receive(mux->queue, &stream_idx, pkt);
+    ret = task_tq_receive(&mux->task, mux->queue, &stream_idx, pkt);
     pkt->stream_index = stream_idx;
     return ret;
 }
@@ -2152,7 +2301,7 @@ int sch_dec_receive(Scheduler *sch, unsigned dec_idx, AVPacket *pkt)
         dec->expect_end_ts = 0;
     }
 
-    ret = tq_receive(dec->queue, &dummy, pkt);
+    ret = task_tq_receive(&dec->task, dec->queue, &dummy, pkt);
     av_assert0(dummy <= 0);
 
     // got a flush packet, on the next call to this function the decoder
@@ -2163,11 +2312,11 @@ int sch_dec_receive(Scheduler *sch, unsigned dec_idx, AVPacket *pkt)
     return ret;
 }
 
-static int send_to_filter(Scheduler *sch, SchFilterGraph *fg,
+static int send_to_filter(Scheduler *sch, SchTask *task, SchFilterGraph *fg,
                           unsigned in_idx, AVFrame *frame)
 {
     if (frame)
-        return tq_send(fg->queue, in_idx, frame);
+        return task_tq_send(task, fg->queue, in_idx, frame);
 
     if (!fg->inputs[in_idx].send_finished) {
         fg->inputs[in_idx].send_finished = 1;
@@ -2180,7 +2329,7 @@ static int send_to_filter(Scheduler *sch, SchFilterGraph *fg,
     return 0;
 }
 
-static int dec_send_to_dst(Scheduler *sch, const SchedulerNode dst,
+static int dec_send_to_dst(Scheduler *sch, SchTask *task, const SchedulerNode dst,
                            uint8_t *dst_finished, AVFrame *frame)
 {
     int ret;
@@ -2192,8 +2341,8 @@ static int dec_send_to_dst(Scheduler *sch, const SchedulerNode dst,
         goto finish;
 
     ret = (dst.type == SCH_NODE_TYPE_FILTER_IN) ?
-          send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, frame) :
-          send_to_enc(sch, &sch->enc[dst.idx], frame);
+          send_to_filter(sch, task, &sch->filters[dst.idx], dst.idx_stream, frame) :
+          send_to_enc(sch, task, &sch->enc[dst.idx], frame);
     if (ret == AVERROR_EOF)
         goto finish;
 
@@ -2201,9 +2350,9 @@ static int dec_send_to_dst(Scheduler *sch, const SchedulerNode dst,
 
 finish:
     if (dst.type == SCH_NODE_TYPE_FILTER_IN)
-        send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, NULL);
+        send_to_filter(sch, task, &sch->filters[dst.idx], dst.idx_stream, NULL);
     else
-        send_to_enc(sch, &sch->enc[dst.idx], NULL);
+        send_to_enc(sch, task, &sch->enc[dst.idx], NULL);
 
     *dst_finished = 1;
 
@@ -2240,7 +2389,7 @@ int sch_dec_send(Scheduler *sch, unsigned dec_idx,
                 return ret;
         }
 
-        ret = dec_send_to_dst(sch, o->dst[i], finished, to_send);
+        ret = dec_send_to_dst(sch, &dec->task, o->dst[i], finished, to_send);
         if (ret < 0) {
             av_frame_unref(to_send);
             if (ret == AVERROR_EOF) {
@@ -2270,7 +2419,7 @@ static int dec_done(Scheduler *sch, unsigned dec_idx)
         SchDecOutput *o = &dec->outputs[i];
 
         for (unsigned j = 0; j < o->nb_dst; j++) {
-            int err = dec_send_to_dst(sch, o->dst[j], &o->dst_finished[j], NULL);
+            int err = dec_send_to_dst(sch, &dec->task, o->dst[j], &o->dst_finished[j], NULL);
             if (err < 0 && err != AVERROR_EOF)
                 ret = err_merge(ret, err);
         }
@@ -2287,13 +2436,13 @@ int sch_enc_receive(Scheduler *sch, unsigned enc_idx, AVFrame *frame)
     av_assert0(enc_idx < sch->nb_enc);
     enc = &sch->enc[enc_idx];
 
-    ret = tq_receive(enc->queue, &dummy, frame);
+    ret = task_tq_receive(&enc->task, enc->queue, &dummy, frame);
     av_assert0(dummy <= 0);
 
     return ret;
 }
 
-static int enc_send_to_dst(Scheduler *sch, const SchedulerNode dst,
+static int enc_send_to_dst(Scheduler *sch, SchTask *task, const SchedulerNode dst,
                            uint8_t *dst_finished, AVPacket *pkt)
 {
     int ret;
@@ -2305,8 +2454,8 @@ static int enc_send_to_dst(Scheduler *sch, const SchedulerNode dst,
         goto finish;
 
     ret = (dst.type == SCH_NODE_TYPE_MUX) ?
-          send_to_mux(sch, &sch->mux[dst.idx], dst.idx_stream, pkt) :
-          tq_send(sch->dec[dst.idx].queue, 0, pkt);
+          send_to_mux(sch, task, &sch->mux[dst.idx], dst.idx_stream, pkt) :
+          task_tq_send(task, sch->dec[dst.idx].queue, 0, pkt);
     if (ret == AVERROR_EOF)
         goto finish;
 
@@ -2314,7 +2463,7 @@ static int enc_send_to_dst(Scheduler *sch, const SchedulerNode dst,
 
 finish:
     if (dst.type == SCH_NODE_TYPE_MUX)
-        send_to_mux(sch, &sch->mux[dst.idx], dst.idx_stream, NULL);
+        send_to_mux(sch, task, &sch->mux[dst.idx], dst.idx_stream, NULL);
     else
         tq_send_finish(sch->dec[dst.idx].queue, 0);
 
@@ -2344,7 +2493,7 @@ int sch_enc_send(Scheduler *sch, unsigned enc_idx, AVPacket *pkt)
                 return ret;
         }
 
-        ret = enc_send_to_dst(sch, enc->dst[i], finished, to_send);
+        ret = enc_send_to_dst(sch, &enc->task, enc->dst[i], finished, to_send);
         if (ret < 0) {
             av_packet_unref(to_send);
             if (ret == AVERROR_EOF)
@@ -2364,7 +2513,7 @@ static int enc_done(Scheduler *sch, unsigned enc_idx)
     tq_receive_finish(enc->queue, 0);
 
     for (unsigned i = 0; i < enc->nb_dst; i++) {
-        int err = enc_send_to_dst(sch, enc->dst[i], &enc->dst_finished[i], NULL);
+        int err = enc_send_to_dst(sch, &enc->task, enc->dst[i], &enc->dst_finished[i], NULL);
         if (err < 0 && err != AVERROR_EOF)
             ret = err_merge(ret, err);
     }
@@ -2396,14 +2545,14 @@ int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
     }
 
     if (*in_idx == fg->nb_inputs) {
-        int terminate = waiter_wait(sch, &fg->waiter);
+        int terminate = waiter_wait(sch, &fg->task, &fg->waiter);
         return terminate ? AVERROR_EOF : AVERROR(EAGAIN);
     }
 
     while (1) {
         int ret, idx;
 
-        ret = tq_receive(fg->queue, &idx, frame);
+        ret = task_tq_receive(&fg->task, fg->queue, &idx, frame);
         if (idx < 0)
             return AVERROR_EOF;
         else if (ret >= 0) {
@@ -2448,9 +2597,9 @@ int sch_filter_send(Scheduler *sch, unsigned fg_idx, unsigned out_idx, AVFrame *
     av_assert0(out_idx < fg->nb_outputs);
     dst = fg->outputs[out_idx].dst;
 
-    return (dst.type == SCH_NODE_TYPE_ENC)                                    ?
-           send_to_enc   (sch, &sch->enc[dst.idx],                     frame) :
-           send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, frame);
+    return (dst.type == SCH_NODE_TYPE_ENC)                                              ?
+           send_to_enc   (sch, &fg->task, &sch->enc[dst.idx],                     frame) :
+           send_to_filter(sch, &fg->task, &sch->filters[dst.idx], dst.idx_stream, frame);
 }
 
 static int filter_done(Scheduler *sch, unsigned fg_idx)
@@ -2463,9 +2612,9 @@ static int filter_done(Scheduler *sch, unsigned fg_idx)
 
     for (unsigned i = 0; i < fg->nb_outputs; i++) {
         SchedulerNode dst = fg->outputs[i].dst;
-        int err = (dst.type == SCH_NODE_TYPE_ENC)                                   ?
-                  send_to_enc   (sch, &sch->enc[dst.idx],                     NULL) :
-                  send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, NULL);
+        int err = (dst.type == SCH_NODE_TYPE_ENC)                                             ?
+                  send_to_enc   (sch, &fg->task, &sch->enc[dst.idx],                     NULL) :
+                  send_to_filter(sch, &fg->task, &sch->filters[dst.idx], dst.idx_stream, NULL);
 
         if (err < 0 && err != AVERROR_EOF)
             ret = err_merge(ret, err);
@@ -2489,7 +2638,7 @@ int sch_filter_command(Scheduler *sch, unsigned fg_idx, AVFrame *frame)
     av_assert0(fg_idx < sch->nb_filters);
     fg = &sch->filters[fg_idx];
 
-    return send_to_filter(sch, fg, fg->nb_inputs, frame);
+    return send_to_filter(sch, NULL, fg, fg->nb_inputs, frame);
 }
 
 static int task_cleanup(Scheduler *sch, SchedulerNode node)
@@ -2511,7 +2660,12 @@ static void *task_wrapper(void *arg)
     int ret;
     int err = 0;
 
+    task_slot_acquire(task, 1);
+
     ret = task->func(task->func_arg);
+
+    task_slot_release(task);
+
     if (ret < 0)
         av_log(task->func_arg, AV_LOG_ERROR,
                "Task finished with error code: %d (%s)\n", ret, av_err2str(ret));
@@ -2557,6 +2711,11 @@ int sch_stop(Scheduler *sch, int64_t *finish_ts)
 
     atomic_store(&sch->terminate, 1);
 
+    // wake up tasks waiting for a run slot
+    pthread_mutex_lock(&sch->task_slots_lock);
+    pthread_cond_broadcast(&sch->task_slots_cond);
+    pthread_mutex_unlock(&sch->task_slots_lock);
+
     for (unsigned type = 0; type < 2; type++)
         for (unsigned i = 0; i < (type ? sch->nb_demux : sch->nb_filters); i++) {
             SchWaiter *w = type ? &sch->demux[i].waiter : &sch->filters[i].waiter;
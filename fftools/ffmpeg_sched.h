@@ -289,6 +289,19 @@ void sch_mux_stream_buffering(Scheduler *sch, unsigned mux_idx, unsigned stream_
  */
 int sch_mux_stream_ready(Scheduler *sch, unsigned mux_idx, unsigned stream_idx);
 
+/**
+ * Limit the number of decoding, filtering and encoding tasks that are allowed
+ * to run at the same time. Tasks that are waiting for input, or for their
+ * downstream to accept output, do not count towards the limit.
+ *
+ * This avoids oversubscribing the CPU with scheduler threads in transcodes
+ * with a large number of outputs, where the codecs and filters also run their
+ * own worker threads. Must be called before sch_start().
+ *
+ * @param nb_slots maximum number of running tasks, 0 for no limit (default)
+ */
+void sch_set_task_slots(Scheduler *sch, int nb_slots);
+
 /**
  * Set the file path for the SDP.
  *
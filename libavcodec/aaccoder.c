@@ -62,7 +62,8 @@
 
 #include "libavcodec/aaccoder_trellis.h"
 
-typedef float (*quantize_and_encode_band_func)(struct AACEncContext *s, PutBitContext *pb,
+typedef float (*quantize_and_encode_band_func)(struct AACEncContext *s, AACEncSearchContext *sc,
+                                               PutBitContext *pb,
                                                const float *in, float *quant, const float *scaled,
                                                int size, int scale_idx, int cb,
                                                const float lambda, const float uplim,
@@ -74,7 +75,7 @@ typedef float (*quantize_and_encode_band_func)(struct AACEncContext *s, PutBitCo
  * @return quantization distortion
  */
 static av_always_inline float quantize_and_encode_band_cost_template(
-                                struct AACEncContext *s,
+                                struct AACEncContext *s, AACEncSearchContext *sc,
                                 PutBitContext *pb, const float *in, float *out,
                                 const float *scaled, int size, int scale_idx,
                                 int cb, const float lambda, const float uplim,
@@ -108,10 +109,10 @@ static av_always_inline float quantize_and_encode_band_cost_template(
         return cost * lambda;
     }
     if (!scaled) {
-        s->aacdsp.abs_pow34(s->scoefs, in, size);
-        scaled = s->scoefs;
+        s->aacdsp.abs_pow34(sc->scoefs, in, size);
+        scaled = sc->scoefs;
     }
-    s->aacdsp.quant_bands(s->qcoefs, in, scaled, size, !BT_UNSIGNED, aac_cb_maxval[cb], Q34, ROUNDING);
+    s->aacdsp.quant_bands(sc->qcoefs, in, scaled, size, !BT_UNSIGNED, aac_cb_maxval[cb], Q34, ROUNDING);
     if (BT_UNSIGNED) {
         off = 0;
     } else {
@@ -119,7 +120,7 @@ static av_always_inline float quantize_and_encode_band_cost_template(
     }
     for (int i = 0; i < size; i += dim) {
         const float *vec;
-        int *quants = s->qcoefs + i;
+        int *quants = sc->qcoefs + i;
         int curidx = 0;
         int curbits;
         float quantized, rd = 0.0f;
@@ -193,7 +194,8 @@ static av_always_inline float quantize_and_encode_band_cost_template(
     return cost;
 }
 
-static inline float quantize_and_encode_band_cost_NONE(struct AACEncContext *s, PutBitContext *pb,
+static inline float quantize_and_encode_band_cost_NONE(struct AACEncContext *s, AACEncSearchContext *sc,
+                                                PutBitContext *pb,
                                                 const float *in, float *quant, const float *scaled,
                                                 int size, int scale_idx, int cb,
                                                 const float lambda, const float uplim,
@@ -204,13 +206,13 @@ static inline float quantize_and_encode_band_cost_NONE(struct AACEncContext *s,
 
 #define QUANTIZE_AND_ENCODE_BAND_COST_FUNC(NAME, BT_ZERO, BT_UNSIGNED, BT_PAIR, BT_ESC, BT_NOISE, BT_STEREO, ROUNDING) \
 static float quantize_and_encode_band_cost_ ## NAME(                                         \
-                                struct AACEncContext *s,                                     \
+                                struct AACEncContext *s, AACEncSearchContext *sc,            \
                                 PutBitContext *pb, const float *in, float *quant,            \
                                 const float *scaled, int size, int scale_idx,                \
                                 int cb, const float lambda, const float uplim,               \
                                 int *bits, float *energy) {                                  \
     return quantize_and_encode_band_cost_template(                                           \
-                                s, pb, in, quant, scaled, size, scale_idx,                   \
+                                s, sc, pb, in, quant, scaled, size, scale_idx,               \
                                 BT_ESC ? ESC_BT : cb, lambda, uplim, bits, energy,           \
                                 BT_ZERO, BT_UNSIGNED, BT_PAIR, BT_ESC, BT_NOISE, BT_STEREO,  \
                                 ROUNDING);                                                   \
@@ -266,13 +268,14 @@ static const quantize_and_encode_band_func quantize_and_encode_band_cost_rtz_arr
     quantize_and_encode_band_cost_STEREO,
 };
 
-float ff_quantize_and_encode_band_cost(struct AACEncContext *s, PutBitContext *pb,
+float ff_quantize_and_encode_band_cost(struct AACEncContext *s, AACEncSearchContext *sc,
+                                       PutBitContext *pb,
                                        const float *in, float *quant, const float *scaled,
                                        int size, int scale_idx, int cb,
                                        const float lambda, const float uplim,
                                        int *bits, float *energy)
 {
-    return quantize_and_encode_band_cost_arr[cb](s, pb, in, quant, scaled, size,
+    return quantize_and_encode_band_cost_arr[cb](s, sc, pb, in, quant, scaled, size,
                                                  scale_idx, cb, lambda, uplim,
                                                  bits, energy);
 }
@@ -281,7 +284,7 @@ static inline void quantize_and_encode_band(struct AACEncContext *s, PutBitConte
                                             const float *in, float *out, int size, int scale_idx,
                                             int cb, const float lambda, int rtz)
 {
-    (rtz ? quantize_and_encode_band_cost_rtz_arr : quantize_and_encode_band_cost_arr)[cb](s, pb, in, out, NULL, size, scale_idx, cb,
+    (rtz ? quantize_and_encode_band_cost_rtz_arr : quantize_and_encode_band_cost_arr)[cb](s, s->search, pb, in, out, NULL, size, scale_idx, cb,
                                      lambda, INFINITY, NULL, NULL);
 }
 
@@ -311,7 +314,7 @@ static void encode_window_bands_info(AACEncContext *s, SingleChannelElement *sce
     float next_minrd = INFINITY;
     int next_mincb = 0;
 
-    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
+    s->aacdsp.abs_pow34(s->search->scoefs, sce->coeffs, 1024);
     start = win*128;
     for (cb = 0; cb < CB_TOT_ALL; cb++) {
         path[0][cb].cost     = 0.0f;
@@ -343,8 +346,8 @@ static void encode_window_bands_info(AACEncContext *s, SingleChannelElement *sce
                 }
                 for (w = 0; w < group_len; w++) {
                     FFPsyBand *band = &s->psy.ch[s->cur_channel].psy_bands[(win+w)*16+swb];
-                    rd += quantize_band_cost(s, &sce->coeffs[start + w*128],
-                                             &s->scoefs[start + w*128], size,
+                    rd += quantize_band_cost(s, s->search, &sce->coeffs[start + w*128],
+                                             &s->search->scoefs[start + w*128], size,
                                              sce->sf_idx[(win+w)*16+swb], aac_cb_out_map[cb],
                                              lambda / band->threshold, INFINITY, NULL, NULL);
                 }
@@ -456,9 +459,10 @@ static void set_special_band_scalefactors(AACEncContext *s, SingleChannelElement
 }
 
 static void search_for_quantizers_anmr(AVCodecContext *avctx, AACEncContext *s,
-                                       SingleChannelElement *sce,
-                                       const float lambda)
+                                       AACEncSearchContext *sc,
+                                       SingleChannelElement *sce)
 {
+    const float lambda = sc->lambda;
     int q, w, w2, g, start = 0;
     int i, j;
     int idx;
@@ -522,7 +526,7 @@ static void search_for_quantizers_anmr(AVCodecContext *avctx, AACEncContext *s,
         }
     }
     idx = 1;
-    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
+    s->aacdsp.abs_pow34(sc->scoefs, sce->coeffs, 1024);
     for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
         start = w*128;
         for (g = 0; g < sce->ics.num_swb; g++) {
@@ -534,7 +538,7 @@ static void search_for_quantizers_anmr(AVCodecContext *avctx, AACEncContext *s,
             qmin = INT_MAX;
             qmax = 0.0f;
             for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
-                FFPsyBand *band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
+                FFPsyBand *band = &s->psy.ch[sc->cur_channel].psy_bands[(w+w2)*16+g];
                 if (band->energy <= band->threshold || band->threshold == 0.0f) {
                     sce->zeroes[(w+w2)*16+g] = 1;
                     continue;
@@ -562,13 +566,13 @@ static void search_for_quantizers_anmr(AVCodecContext *avctx, AACEncContext *s,
                     maxscale = av_clip(minscale+1, 1, TRELLIS_STATES);
                     minscale = av_clip(maxscale-1, 0, TRELLIS_STATES - 1);
                 }
-                maxval = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], s->scoefs+start);
+                maxval = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], sc->scoefs+start);
                 for (q = minscale; q < maxscale; q++) {
                     float dist = 0;
                     int cb = find_min_book(maxval, sce->sf_idx[w*16+g]);
                     for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
-                        FFPsyBand *band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
-                        dist += quantize_band_cost(s, coefs + w2*128, s->scoefs + start + w2*128, sce->ics.swb_sizes[g],
+                        FFPsyBand *band = &s->psy.ch[sc->cur_channel].psy_bands[(w+w2)*16+g];
+                        dist += quantize_band_cost(s, sc, coefs + w2*128, sc->scoefs + start + w2*128, sce->ics.swb_sizes[g],
                                                    q + q0, cb, lambda / band->threshold, INFINITY, NULL, NULL);
                     }
                     minrd = FFMIN(minrd, dist);
@@ -616,9 +620,10 @@ static void search_for_quantizers_anmr(AVCodecContext *avctx, AACEncContext *s,
 }
 
 static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
-                                       SingleChannelElement *sce,
-                                       const float lambda)
+                                       AACEncSearchContext *sc,
+                                       SingleChannelElement *sce)
 {
+    const float lambda = sc->lambda;
     int start = 0, i, w, w2, g;
     int destbits = avctx->bit_rate * 1024.0 / avctx->sample_rate / avctx->ch_layout.nb_channels * (lambda / 120.f);
     float dists[128] = { 0 }, uplims[128] = { 0 };
@@ -639,7 +644,7 @@ static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
             int nz = 0;
             float uplim = 0.0f;
             for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
-                FFPsyBand *band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
+                FFPsyBand *band = &s->psy.ch[sc->cur_channel].psy_bands[(w+w2)*16+g];
                 uplim += band->threshold;
                 if (band->energy <= band->threshold || band->threshold == 0.0f) {
                     sce->zeroes[(w+w2)*16+g] = 1;
@@ -668,13 +673,13 @@ static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
 
     if (!allz)
         return;
-    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
-    ff_quantize_band_cost_cache_init(s);
+    s->aacdsp.abs_pow34(sc->scoefs, sce->coeffs, 1024);
+    ff_quantize_band_cost_cache_init(sc);
 
     for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
         start = w*128;
         for (g = 0; g < sce->ics.num_swb; g++) {
-            const float *scaled = s->scoefs + start;
+            const float *scaled = sc->scoefs + start;
             maxvals[w*16+g] = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], scaled);
             start += sce->ics.swb_sizes[g];
         }
@@ -694,7 +699,7 @@ static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
                 start = w*128;
                 for (g = 0; g < sce->ics.num_swb; g++) {
                     const float *coefs = sce->coeffs + start;
-                    const float *scaled = s->scoefs + start;
+                    const float *scaled = sc->scoefs + start;
                     int bits = 0;
                     int cb;
                     float dist = 0.0f;
@@ -707,7 +712,7 @@ static void search_for_quantizers_fast(AVCodecContext *avctx, AACEncContext *s,
                     cb = find_min_book(maxvals[w*16+g], sce->sf_idx[w*16+g]);
                     for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
                         int b;
-                        dist += quantize_band_cost_cached(s, w + w2, g,
+                        dist += quantize_band_cost_cached(s, sc, w + w2, g,
                                                           coefs + w2*128,
                                                           scaled + w2*128,
                                                           sce->ics.swb_sizes[g],
@@ -768,8 +773,8 @@ static void search_for_pns(AACEncContext *s, AVCodecContext *avctx, SingleChanne
     int w, g, w2, i;
     int wlen = 1024 / sce->ics.num_windows;
     int bandwidth, cutoff;
-    float *PNS = &s->scoefs[0*128], *PNS34 = &s->scoefs[1*128];
-    float *NOR34 = &s->scoefs[3*128];
+    float *PNS = &s->search->scoefs[0*128], *PNS34 = &s->search->scoefs[1*128];
+    float *NOR34 = &s->search->scoefs[3*128];
     uint8_t nextband[128];
     const float lambda = s->lambda;
     const float freq_mult = avctx->sample_rate*0.5f/wlen;
@@ -876,7 +881,7 @@ static void search_for_pns(AACEncContext *s, AVCodecContext *avctx, SingleChanne
                 pns_energy += pns_senergy;
                 s->aacdsp.abs_pow34(NOR34, &sce->coeffs[start_c], sce->ics.swb_sizes[g]);
                 s->aacdsp.abs_pow34(PNS34, PNS, sce->ics.swb_sizes[g]);
-                dist1 += quantize_band_cost(s, &sce->coeffs[start_c],
+                dist1 += quantize_band_cost(s, s->search, &sce->coeffs[start_c],
                                             NOR34,
                                             sce->ics.swb_sizes[g],
                                             sce->sf_idx[(w+w2)*16+g],
@@ -904,13 +909,14 @@ static void search_for_pns(AACEncContext *s, AVCodecContext *avctx, SingleChanne
     }
 }
 
-static void mark_pns(AACEncContext *s, AVCodecContext *avctx, SingleChannelElement *sce)
+static void mark_pns(AACEncContext *s, AACEncSearchContext *sc,
+                     AVCodecContext *avctx, SingleChannelElement *sce)
 {
     FFPsyBand *band;
     int w, g, w2;
     int wlen = 1024 / sce->ics.num_windows;
     int bandwidth, cutoff;
-    const float lambda = s->lambda;
+    const float lambda = sc->lambda;
     const float freq_mult = avctx->sample_rate*0.5f/wlen;
     const float spread_threshold = FFMIN(0.75f, NOISE_SPREAD_THRESHOLD*FFMAX(0.5f, lambda/100.f));
     const float pns_transient_energy_r = FFMIN(0.7f, lambda / 140.f);
@@ -948,7 +954,7 @@ static void mark_pns(AACEncContext *s, AVCodecContext *avctx, SingleChannelEleme
                 continue;
             }
             for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
-                band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
+                band = &s->psy.ch[sc->cur_channel].psy_bands[(w+w2)*16+g];
                 sfb_energy += band->energy;
                 spread     = FFMIN(spread, band->spread);
                 threshold  += band->threshold;
@@ -979,9 +985,9 @@ static void search_for_ms(AACEncContext *s, ChannelElement *cpe)
 {
     int start = 0, i, w, w2, g, sid_sf_boost, prev_mid, prev_side;
     uint8_t nextband0[128], nextband1[128];
-    float *M   = s->scoefs + 128*0, *S   = s->scoefs + 128*1;
-    float *L34 = s->scoefs + 128*2, *R34 = s->scoefs + 128*3;
-    float *M34 = s->scoefs + 128*4, *S34 = s->scoefs + 128*5;
+    float *M   = s->search->scoefs + 128*0, *S   = s->search->scoefs + 128*1;
+    float *L34 = s->search->scoefs + 128*2, *R34 = s->search->scoefs + 128*3;
+    float *M34 = s->search->scoefs + 128*4, *S34 = s->search->scoefs + 128*5;
     const float lambda = s->lambda;
     const float mslambda = FFMIN(1.0f, lambda / 120.f);
     SingleChannelElement *sce0 = &cpe->ch[0];
@@ -1060,25 +1066,25 @@ static void search_for_ms(AACEncContext *s, ChannelElement *cpe)
                         s->aacdsp.abs_pow34(R34, sce1->coeffs+start+(w+w2)*128, sce0->ics.swb_sizes[g]);
                         s->aacdsp.abs_pow34(M34, M,                         sce0->ics.swb_sizes[g]);
                         s->aacdsp.abs_pow34(S34, S,                         sce0->ics.swb_sizes[g]);
-                        dist1 += quantize_band_cost(s, &sce0->coeffs[start + (w+w2)*128],
+                        dist1 += quantize_band_cost(s, s->search, &sce0->coeffs[start + (w+w2)*128],
                                                     L34,
                                                     sce0->ics.swb_sizes[g],
                                                     sce0->sf_idx[w*16+g],
                                                     sce0->band_type[w*16+g],
                                                     lambda / (band0->threshold + FLT_MIN), INFINITY, &b1, NULL);
-                        dist1 += quantize_band_cost(s, &sce1->coeffs[start + (w+w2)*128],
+                        dist1 += quantize_band_cost(s, s->search, &sce1->coeffs[start + (w+w2)*128],
                                                     R34,
                                                     sce1->ics.swb_sizes[g],
                                                     sce1->sf_idx[w*16+g],
                                                     sce1->band_type[w*16+g],
                                                     lambda / (band1->threshold + FLT_MIN), INFINITY, &b2, NULL);
-                        dist2 += quantize_band_cost(s, M,
+                        dist2 += quantize_band_cost(s, s->search, M,
                                                     M34,
                                                     sce0->ics.swb_sizes[g],
                                                     mididx,
                                                     midcb,
                                                     lambda / (minthr + FLT_MIN), INFINITY, &b3, NULL);
-                        dist2 += quantize_band_cost(s, S,
+                        dist2 += quantize_band_cost(s, s->search, S,
                                                     S34,
                                                     sce1->ics.swb_sizes[g],
                                                     sididx,
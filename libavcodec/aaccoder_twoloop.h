@@ -64,14 +64,14 @@ static inline int ff_pns_bits(SingleChannelElement *sce, int w, int g)
  */
 static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                                           AACEncContext *s,
-                                          SingleChannelElement *sce,
-                                          const float lambda)
+                                          AACEncSearchContext *sc,
+                                          SingleChannelElement *sce)
 {
+    const float lambda = sc->lambda;
     int start = 0, i, w, w2, g, recomprd;
     int destbits = avctx->bit_rate * 1024.0 / avctx->sample_rate
         / ((avctx->flags & AV_CODEC_FLAG_QSCALE) ? 2.0f : avctx->ch_layout.nb_channels)
         * (lambda / 120.f);
-    int refbits = destbits;
     int toomanybits, toofewbits;
     char nzs[128];
     uint8_t nextband[128];
@@ -125,12 +125,12 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
         zeroscale = 1.f;
     }
 
-    if (s->psy.bitres.alloc >= 0) {
+    if (sc->bitres_alloc >= 0) {
         /**
          * Psy granted us extra bits to use, from the reservoire
          * adjust for lambda except what psy already did
          */
-        destbits = s->psy.bitres.alloc
+        destbits = sc->bitres_alloc
             * (lambda / (avctx->global_quality ? avctx->global_quality : 120));
     }
 
@@ -140,7 +140,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
          * No need to be overly precise, this only controls RD
          * adjustment CB limits when going overboard
          */
-        if (s->options.mid_side && s->cur_type == TYPE_CPE)
+        if (s->options.mid_side && sc->cur_type == TYPE_CPE)
             destbits *= 2;
 
         /**
@@ -174,28 +174,10 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
         int wlen = 1024 / sce->ics.num_windows;
         int bandwidth;
 
-        /**
-         * Scale, psy gives us constant quality, this LP only scales
-         * bitrate by lambda, so we save bits on subjectively unimportant HF
-         * rather than increase quantization noise. Adjust nominal bitrate
-         * to effective bitrate according to encoding parameters,
-         * AAC_CUTOFF_FROM_BITRATE is calibrated for effective bitrate.
-         */
-        float rate_bandwidth_multiplier = 1.5f;
-        int frame_bit_rate = (avctx->flags & AV_CODEC_FLAG_QSCALE)
-            ? (refbits * rate_bandwidth_multiplier * avctx->sample_rate / 1024)
-            : (avctx->bit_rate / avctx->ch_layout.nb_channels);
-
-        /** Compensate for extensions that increase efficiency */
-        if (s->options.pns || s->options.intensity_stereo)
-            frame_bit_rate *= 1.15f;
-
-        if (avctx->cutoff > 0) {
+        if (avctx->cutoff > 0)
             bandwidth = avctx->cutoff;
-        } else {
-            bandwidth = FFMAX(3000, AAC_CUTOFF_FROM_BITRATE(frame_bit_rate, 1, avctx->sample_rate));
-            s->psy.cutoff = bandwidth;
-        }
+        else
+            bandwidth = ff_aac_twoloop_bandwidth(avctx, s, lambda);
 
         cutoff = bandwidth * 2 * wlen / avctx->sample_rate;
         pns_start_pos = NOISE_LOW_LIMIT * 2 * wlen / avctx->sample_rate;
@@ -219,7 +201,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
             int nz = 0;
             float uplim = 0.0f, energy = 0.0f, spread = 0.0f;
             for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
-                FFPsyBand *band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
+                FFPsyBand *band = &s->psy.ch[sc->cur_channel].psy_bands[(w+w2)*16+g];
                 if (start >= cutoff || band->energy <= (band->threshold * zeroscale) || band->threshold == 0.0f) {
                     sce->zeroes[(w+w2)*16+g] = 1;
                     continue;
@@ -231,7 +213,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
             } else {
                 nz = 0;
                 for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
-                    FFPsyBand *band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
+                    FFPsyBand *band = &s->psy.ch[sc->cur_channel].psy_bands[(w+w2)*16+g];
                     if (band->energy <= (band->threshold * zeroscale) || band->threshold == 0.0f)
                         continue;
                     uplim += band->threshold;
@@ -289,15 +271,15 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
 
     if (!allz)
         return;
-    s->aacdsp.abs_pow34(s->scoefs, sce->coeffs, 1024);
-    ff_quantize_band_cost_cache_init(s);
+    s->aacdsp.abs_pow34(sc->scoefs, sce->coeffs, 1024);
+    ff_quantize_band_cost_cache_init(sc);
 
     for (i = 0; i < sizeof(minsf) / sizeof(minsf[0]); ++i)
         minsf[i] = 0;
     for (w = 0; w < sce->ics.num_windows; w += sce->ics.group_len[w]) {
         start = w*128;
         for (g = 0;  g < sce->ics.num_swb; g++) {
-            const float *scaled = s->scoefs + start;
+            const float *scaled = sc->scoefs + start;
             int minsfidx;
             maxvals[w*16+g] = find_max_val(sce->ics.group_len[w], sce->ics.swb_sizes[g], scaled);
             if (maxvals[w*16+g] > 0) {
@@ -374,7 +356,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                 start = w*128;
                 for (g = 0;  g < sce->ics.num_swb; g++) {
                     const float *coefs = &sce->coeffs[start];
-                    const float *scaled = &s->scoefs[start];
+                    const float *scaled = &sc->scoefs[start];
                     int bits = 0;
                     int cb;
                     float dist = 0.0f;
@@ -392,7 +374,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                     for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
                         int b;
                         float sqenergy;
-                        dist += quantize_band_cost_cached(s, w + w2, g, coefs + w2*128,
+                        dist += quantize_band_cost_cached(s, sc, w + w2, g, coefs + w2*128,
                                                    scaled + w2*128,
                                                    sce->ics.swb_sizes[g],
                                                    sce->sf_idx[w*16+g],
@@ -455,7 +437,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                     start = w*128;
                     for (g = 0;  g < sce->ics.num_swb; g++) {
                         const float *coefs = sce->coeffs + start;
-                        const float *scaled = s->scoefs + start;
+                        const float *scaled = sc->scoefs + start;
                         int bits = 0;
                         int cb;
                         float dist = 0.0f;
@@ -473,7 +455,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                         for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
                             int b;
                             float sqenergy;
-                            dist += quantize_band_cost_cached(s, w + w2, g, coefs + w2*128,
+                            dist += quantize_band_cost_cached(s, sc, w + w2, g, coefs + w2*128,
                                                     scaled + w2*128,
                                                     sce->ics.swb_sizes[g],
                                                     sce->sf_idx[w*16+g],
@@ -595,7 +577,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                     prev = sce->sf_idx[0];
                 if (!sce->zeroes[w*16+g]) {
                     const float *coefs = sce->coeffs + start;
-                    const float *scaled = s->scoefs + start;
+                    const float *scaled = sc->scoefs + start;
                     int cmb = find_min_book(maxvals[w*16+g], sce->sf_idx[w*16+g]);
                     int mindeltasf = FFMAX(0, prev - SCALE_MAX_DIFF);
                     int maxdeltasf = FFMIN(SCALE_MAX_POS - SCALE_DIV_512, prev + SCALE_MAX_DIFF);
@@ -627,7 +609,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                             for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
                                 int b;
                                 float sqenergy;
-                                dist += quantize_band_cost_cached(s, w + w2, g, coefs + w2*128,
+                                dist += quantize_band_cost_cached(s, sc, w + w2, g, coefs + w2*128,
                                                         scaled + w2*128,
                                                         sce->ics.swb_sizes[g],
                                                         sce->sf_idx[w*16+g]-1,
@@ -664,7 +646,7 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
                                 for (w2 = 0; w2 < sce->ics.group_len[w]; w2++) {
                                     int b;
                                     float sqenergy;
-                                    dist += quantize_band_cost_cached(s, w + w2, g, coefs + w2*128,
+                                    dist += quantize_band_cost_cached(s, sc, w + w2, g, coefs + w2*128,
                                                             scaled + w2*128,
                                                             sce->ics.swb_sizes[g],
                                                             sce->sf_idx[w*16+g]+1,
@@ -398,12 +398,12 @@ static int put_audio_specific_config(AVCodecContext *avctx)
     return 0;
 }
 
-void ff_quantize_band_cost_cache_init(struct AACEncContext *s)
+void ff_quantize_band_cost_cache_init(AACEncSearchContext *sc)
 {
-    ++s->quantize_band_cost_cache_generation;
-    if (s->quantize_band_cost_cache_generation == 0) {
-        memset(s->quantize_band_cost_cache, 0, sizeof(s->quantize_band_cost_cache));
-        s->quantize_band_cost_cache_generation = 1;
+    ++sc->quantize_band_cost_cache_generation;
+    if (sc->quantize_band_cost_cache_generation == 0) {
+        memset(sc->quantize_band_cost_cache, 0, sizeof(sc->quantize_band_cost_cache));
+        sc->quantize_band_cost_cache_generation = 1;
     }
 }
 
@@ -826,6 +826,36 @@ static void copy_input_samples(AACEncContext *s, const AVFrame *frame)
     }
 }
 
+/**
+ * Pick quantizers for a channel, after all channel elements were analyzed.
+ * Each slice thread searches with its own search state.
+ */
+static int search_channel(AVCodecContext *avctx, void *arg, int ch, int threadnr)
+{
+    AACEncContext *s = avctx->priv_data;
+    AACEncSearchContext *sc = &s->search[threadnr];
+    SingleChannelElement *sce;
+    int i, chans, start_ch = 0;
+
+    for (i = 0; ; i++) {
+        chans = s->chan_map[i + 1] == TYPE_CPE ? 2 : 1;
+        if (ch < start_ch + chans)
+            break;
+        start_ch += chans;
+    }
+    sce = &s->cpe[i].ch[ch - start_ch];
+
+    sc->lambda       = s->lambda;
+    sc->bitres_alloc = s->bitres_alloc[i];
+    sc->cur_type     = s->chan_map[i + 1];
+    sc->cur_channel  = ch;
+    if (s->options.pns && s->coder->mark_pns)
+        s->coder->mark_pns(s, sc, avctx, sce);
+    s->coder->search_for_quantizers(avctx, s, sc, sce);
+
+    return 0;
+}
+
 static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                             const AVFrame *frame, int *got_packet_ptr)
 {
@@ -961,7 +991,6 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             put_bitstream_info(s, LIBAVCODEC_IDENT);
         start_ch = 0;
         target_bits = 0;
-        memset(chan_el_counter, 0, sizeof(chan_el_counter));
         for (i = 0; i < s->chan_map[0]; i++) {
             FFPsyWindowInfo* wi = windows + start_ch;
             const float *coeffs[2];
@@ -971,8 +1000,6 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             cpe->common_window = 0;
             memset(cpe->is_mask, 0, sizeof(cpe->is_mask));
             memset(cpe->ms_mask, 0, sizeof(cpe->ms_mask));
-            put_bits(&s->pb, 3, tag);
-            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             for (ch = 0; ch < chans; ch++) {
                 sce = &cpe->ch[ch];
                 coeffs[ch] = sce->coeffs;
@@ -994,13 +1021,25 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                     * (s->lambda / (avctx->global_quality ? avctx->global_quality : 120));
                 s->psy.bitres.alloc /= chans;
             }
-            s->cur_type = tag;
-            for (ch = 0; ch < chans; ch++) {
-                s->cur_channel = start_ch + ch;
-                if (s->options.pns && s->coder->mark_pns)
-                    s->coder->mark_pns(s, avctx, &cpe->ch[ch]);
-                s->coder->search_for_quantizers(avctx, s, &cpe->ch[ch], s->lambda);
-            }
+            s->bitres_alloc[i] = s->psy.bitres.alloc;
+            /* The quantizer search of an element narrows the bandwidth the
+             * following elements are analyzed with, apply it right away as
+             * the searches only run once all elements were analyzed. */
+            if (s->options.coder == AAC_CODER_TWOLOOP && avctx->cutoff <= 0)
+                s->psy.cutoff = ff_aac_twoloop_bandwidth(avctx, s, s->lambda);
+            start_ch += chans;
+        }
+        avctx->execute2(avctx, search_channel, NULL, NULL, s->channels);
+
+        start_ch = 0;
+        memset(chan_el_counter, 0, sizeof(chan_el_counter));
+        for (i = 0; i < s->chan_map[0]; i++) {
+            FFPsyWindowInfo* wi = windows + start_ch;
+            tag      = s->chan_map[i+1];
+            chans    = tag == TYPE_CPE ? 2 : 1;
+            cpe      = &s->cpe[i];
+            put_bits(&s->pb, 3, tag);
+            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             if (chans > 1
                 && wi[0].window_type[0] == wi[1].window_type[0]
                 && wi[0].window_shape   == wi[1].window_shape) {
@@ -1198,6 +1237,7 @@ static av_cold int aac_encode_end(AVCodecContext *avctx)
     av_freep(&s->buffer.samples);
     av_freep(&s->cpe);
     av_freep(&s->fdsp);
+    av_freep(&s->search);
     ff_af_queue_close(&s->afq);
     return 0;
 }
@@ -1386,6 +1426,11 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
 
     ff_af_queue_init(avctx, &s->afq);
 
+    s->search = av_calloc(avctx->active_thread_type & FF_THREAD_SLICE ?
+                          avctx->thread_count : 1, sizeof(*s->search));
+    if (!s->search)
+        return AVERROR(ENOMEM);
+
     return 0;
 }
 
@@ -1424,7 +1469,7 @@ const FFCodec ff_aac_encoder = {
     .p.type         = AVMEDIA_TYPE_AUDIO,
     .p.id           = AV_CODEC_ID_AAC,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_SMALL_LAST_FRAME,
+                      AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_SLICE_THREADS,
     .priv_data_size = sizeof(AACEncContext),
     .init           = aac_encode_init,
     FF_CODEC_ENCODE_CB(aac_encode_frame),
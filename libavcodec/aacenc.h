@@ -158,11 +158,36 @@ typedef struct ChannelElement {
     SingleChannelElement ch[2];
 } ChannelElement;
 
+typedef struct AACQuantizeBandCostCacheEntry {
+    float rd;
+    float energy;
+    int bits;
+    char cb;
+    char rtz;
+    uint16_t generation;
+} AACQuantizeBandCostCacheEntry;
+
+/**
+ * State of a quantizer search. Each slice thread searches with its own.
+ */
+typedef struct AACEncSearchContext {
+    int cur_channel;                             ///< channel being searched
+    enum RawDataBlockType cur_type;              ///< channel group type cur_channel belongs to
+    float lambda;                                ///< rate-distortion tradeoff of the search
+    int bitres_alloc;                            ///< psy bit allocation of the channel, -1 if none
+
+    DECLARE_ALIGNED(32, int,   qcoefs)[96];      ///< quantized coefficients
+    DECLARE_ALIGNED(32, float, scoefs)[1024];    ///< scaled coefficients
+
+    uint16_t quantize_band_cost_cache_generation;
+    AACQuantizeBandCostCacheEntry quantize_band_cost_cache[256][128]; ///< memoization area for quantize_band_cost
+} AACEncSearchContext;
+
 struct AACEncContext;
 
 typedef struct AACCoefficientsEncoder {
     void (*search_for_quantizers)(AVCodecContext *avctx, struct AACEncContext *s,
-                                  SingleChannelElement *sce, const float lambda);
+                                  AACEncSearchContext *sc, SingleChannelElement *sce);
     void (*encode_window_bands_info)(struct AACEncContext *s, SingleChannelElement *sce,
                                      int win, int group_len, const float lambda);
     void (*quantize_and_encode_band)(struct AACEncContext *s, PutBitContext *pb, const float *in, float *out, int size,
@@ -178,7 +203,8 @@ typedef struct AACCoefficientsEncoder {
     void (*ltp_insert_new_frame)(struct AACEncContext *s);
     void (*set_special_band_scalefactors)(struct AACEncContext *s, SingleChannelElement *sce);
     void (*search_for_pns)(struct AACEncContext *s, AVCodecContext *avctx, SingleChannelElement *sce);
-    void (*mark_pns)(struct AACEncContext *s, AVCodecContext *avctx, SingleChannelElement *sce);
+    void (*mark_pns)(struct AACEncContext *s, AACEncSearchContext *sc,
+                     AVCodecContext *avctx, SingleChannelElement *sce);
     void (*search_for_tns)(struct AACEncContext *s, SingleChannelElement *sce);
     void (*search_for_ltp)(struct AACEncContext *s, SingleChannelElement *sce, int common_window);
     void (*search_for_ms)(struct AACEncContext *s, ChannelElement *cpe);
@@ -188,15 +214,6 @@ typedef struct AACCoefficientsEncoder {
 
 extern const AACCoefficientsEncoder ff_aac_coders[];
 
-typedef struct AACQuantizeBandCostCacheEntry {
-    float rd;
-    float energy;
-    int bits;
-    char cb;
-    char rtz;
-    uint16_t generation;
-} AACQuantizeBandCostCacheEntry;
-
 typedef struct AACPCEInfo {
     AVChannelLayout layout;
     int num_ele[4];                              ///< front, side, back, lfe
@@ -239,23 +256,20 @@ typedef struct AACEncContext {
     int last_frame_pb_count;                     ///< number of bits for the previous frame
     float lambda_sum;                            ///< sum(lambda), for Qvg reporting
     int lambda_count;                            ///< count(lambda), for Qvg reporting
-    enum RawDataBlockType cur_type;              ///< channel group type cur_channel belongs to
 
     AudioFrameQueue afq;
-    DECLARE_ALIGNED(32, int,   qcoefs)[96];      ///< quantized coefficients
-    DECLARE_ALIGNED(32, float, scoefs)[1024];    ///< scaled coefficients
-
-    uint16_t quantize_band_cost_cache_generation;
-    AACQuantizeBandCostCacheEntry quantize_band_cost_cache[256][128]; ///< memoization area for quantize_band_cost
 
     AACEncDSPContext aacdsp;
 
     struct {
         float *samples;
     } buffer;
+
+    AACEncSearchContext *search;                 ///< search state of each slice thread, [0] also used out of searches
+    int bitres_alloc[16];                        ///< psy bit allocation of each channel element in the pass
 } AACEncContext;
 
-void ff_quantize_band_cost_cache_init(struct AACEncContext *s);
+void ff_quantize_band_cost_cache_init(AACEncSearchContext *sc);
 
 
 #endif /* AVCODEC_AACENC_H */
@@ -40,8 +40,8 @@ struct AACISError ff_aac_is_encoding_err(AACEncContext *s, ChannelElement *cpe,
     SingleChannelElement *sce1 = &cpe->ch[1];
     float *L = use_pcoeffs ? sce0->pcoeffs : sce0->coeffs;
     float *R = use_pcoeffs ? sce1->pcoeffs : sce1->coeffs;
-    float *L34 = &s->scoefs[256*0], *R34 = &s->scoefs[256*1];
-    float *IS  = &s->scoefs[256*2], *I34 = &s->scoefs[256*3];
+    float *L34 = &s->search->scoefs[256*0], *R34 = &s->search->scoefs[256*1];
+    float *IS  = &s->search->scoefs[256*2], *I34 = &s->search->scoefs[256*3];
     float dist1 = 0.0f, dist2 = 0.0f;
     struct AACISError is_error = {0};
 
@@ -64,17 +64,17 @@ struct AACISError ff_aac_is_encoding_err(AACEncContext *s, ChannelElement *cpe,
         s->aacdsp.abs_pow34(I34, IS,                   sce0->ics.swb_sizes[g]);
         maxval = find_max_val(1, sce0->ics.swb_sizes[g], I34);
         is_band_type = find_min_book(maxval, is_sf_idx);
-        dist1 += quantize_band_cost(s, &L[start + (w+w2)*128], L34,
+        dist1 += quantize_band_cost(s, s->search, &L[start + (w+w2)*128], L34,
                                     sce0->ics.swb_sizes[g],
                                     sce0->sf_idx[w*16+g],
                                     sce0->band_type[w*16+g],
                                     s->lambda / band0->threshold, INFINITY, NULL, NULL);
-        dist1 += quantize_band_cost(s, &R[start + (w+w2)*128], R34,
+        dist1 += quantize_band_cost(s, s->search, &R[start + (w+w2)*128], R34,
                                     sce1->ics.swb_sizes[g],
                                     sce1->sf_idx[w*16+g],
                                     sce1->band_type[w*16+g],
                                     s->lambda / band1->threshold, INFINITY, NULL, NULL);
-        dist2 += quantize_band_cost(s, IS, I34, sce0->ics.swb_sizes[g],
+        dist2 += quantize_band_cost(s, s->search, IS, I34, sce0->ics.swb_sizes[g],
                                     is_sf_idx, is_band_type,
                                     s->lambda / minthr, INFINITY, NULL, NULL);
         for (i = 0; i < sce0->ics.swb_sizes[g]; i++) {
@@ -161,8 +161,8 @@ void ff_aac_search_for_ltp(AACEncContext *s, SingleChannelElement *sce,
 {
     int w, g, w2, i, start = 0, count = 0;
     int saved_bits = -(15 + FFMIN(sce->ics.max_sfb, MAX_LTP_LONG_SFB));
-    float *C34 = &s->scoefs[128*0], *PCD = &s->scoefs[128*1];
-    float *PCD34 = &s->scoefs[128*2];
+    float *C34 = &s->search->scoefs[128*0], *PCD = &s->search->scoefs[128*1];
+    float *PCD34 = &s->search->scoefs[128*2];
     const int max_ltp = FFMIN(sce->ics.max_sfb, MAX_LTP_LONG_SFB);
 
     if (sce->ics.window_sequence[0] == EIGHT_SHORT_SEQUENCE) {
@@ -192,10 +192,10 @@ void ff_aac_search_for_ltp(AACEncContext *s, SingleChannelElement *sce,
                     PCD[i] = sce->coeffs[start+(w+w2)*128+i] - sce->lcoeffs[start+(w+w2)*128+i];
                 s->aacdsp.abs_pow34(C34,  &sce->coeffs[start+(w+w2)*128],  sce->ics.swb_sizes[g]);
                 s->aacdsp.abs_pow34(PCD34, PCD, sce->ics.swb_sizes[g]);
-                dist1 += quantize_band_cost(s, &sce->coeffs[start+(w+w2)*128], C34, sce->ics.swb_sizes[g],
+                dist1 += quantize_band_cost(s, s->search, &sce->coeffs[start+(w+w2)*128], C34, sce->ics.swb_sizes[g],
                                             sce->sf_idx[(w+w2)*16+g], sce->band_type[(w+w2)*16+g],
                                             s->lambda/band->threshold, INFINITY, &bits_tmp1, NULL);
-                dist2 += quantize_band_cost(s, PCD, PCD34, sce->ics.swb_sizes[g],
+                dist2 += quantize_band_cost(s, s->search, PCD, PCD34, sce->ics.swb_sizes[g],
                                             sce->sf_idx[(w+w2)*16+g],
                                             sce->band_type[(w+w2)*16+g],
                                             s->lambda/band->threshold, INFINITY, &bits_tmp2, NULL);
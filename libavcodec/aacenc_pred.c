@@ -234,9 +234,9 @@ void ff_aac_search_for_pred(AACEncContext *s, SingleChannelElement *sce)
 {
     int sfb, i, count = 0, cost_coeffs = 0, cost_pred = 0;
     const int pmax = FFMIN(sce->ics.max_sfb, ff_aac_pred_sfb_max[s->samplerate_index]);
-    float *O34  = &s->scoefs[128*0], *P34 = &s->scoefs[128*1];
-    float *SENT = &s->scoefs[128*2], *S34 = &s->scoefs[128*3];
-    float *QERR = &s->scoefs[128*4];
+    float *O34  = &s->search->scoefs[128*0], *P34 = &s->search->scoefs[128*1];
+    float *SENT = &s->search->scoefs[128*2], *S34 = &s->search->scoefs[128*3];
+    float *QERR = &s->search->scoefs[128*4];
 
     if (sce->ics.window_sequence[0] == EIGHT_SHORT_SEQUENCE) {
         sce->ics.predictor_present = 0;
@@ -271,7 +271,7 @@ void ff_aac_search_for_pred(AACEncContext *s, SingleChannelElement *sce)
 
         /* Normal coefficients */
         s->aacdsp.abs_pow34(O34, &sce->coeffs[start_coef], num_coeffs);
-        dist1 = ff_quantize_and_encode_band_cost(s, NULL, &sce->coeffs[start_coef], NULL,
+        dist1 = ff_quantize_and_encode_band_cost(s, s->search, NULL, &sce->coeffs[start_coef], NULL,
                                                  O34, num_coeffs, sce->sf_idx[sfb],
                                                  cb_n, s->lambda / band->threshold, INFINITY, &cost1, NULL);
         cost_coeffs += cost1;
@@ -284,7 +284,7 @@ void ff_aac_search_for_pred(AACEncContext *s, SingleChannelElement *sce)
             cb_p = av_clip(find_min_book(find_max_val(1, num_coeffs, S34), sce->sf_idx[sfb]), cb_min, cb_max);
         else
             cb_p = cb_n;
-        ff_quantize_and_encode_band_cost(s, NULL, SENT, QERR, S34, num_coeffs,
+        ff_quantize_and_encode_band_cost(s, s->search, NULL, SENT, QERR, S34, num_coeffs,
                                          sce->sf_idx[sfb], cb_p, s->lambda / band->threshold, INFINITY,
                                          &cost2, NULL);
 
@@ -296,7 +296,7 @@ void ff_aac_search_for_pred(AACEncContext *s, SingleChannelElement *sce)
             cb_p = av_clip(find_min_book(find_max_val(1, num_coeffs, P34), sce->sf_idx[sfb]), cb_min, cb_max);
         else
             cb_p = cb_n;
-        dist2 = ff_quantize_and_encode_band_cost(s, NULL, &sce->prcoeffs[start_coef], NULL,
+        dist2 = ff_quantize_and_encode_band_cost(s, s->search, NULL, &sce->prcoeffs[start_coef], NULL,
                                                  P34, num_coeffs, sce->sf_idx[sfb],
                                                  cb_p, s->lambda / band->threshold, INFINITY, NULL, NULL);
         for (i = 0; i < num_coeffs; i++)
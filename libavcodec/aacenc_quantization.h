@@ -34,28 +34,29 @@
 #include "put_bits.h"
 
 
-float ff_quantize_and_encode_band_cost(AACEncContext *s, PutBitContext *pb,
+float ff_quantize_and_encode_band_cost(AACEncContext *s, AACEncSearchContext *sc,
+                                       PutBitContext *pb,
                                        const float *in, float *quant, const float *scaled,
                                        int size, int scale_idx, int cb,
                                        const float lambda, const float uplim,
                                        int *bits, float *energy);
 
-static inline float quantize_band_cost(struct AACEncContext *s, const float *in,
-                                const float *scaled, int size, int scale_idx,
+static inline float quantize_band_cost(struct AACEncContext *s, AACEncSearchContext *sc,
+                                const float *in, const float *scaled, int size, int scale_idx,
                                 int cb, const float lambda, const float uplim,
                                 int *bits, float *energy)
 {
-    return ff_quantize_and_encode_band_cost(s, NULL, in, NULL, scaled, size, scale_idx,
+    return ff_quantize_and_encode_band_cost(s, sc, NULL, in, NULL, scaled, size, scale_idx,
                                             cb, lambda, uplim, bits, energy);
 }
 
-static inline int quantize_band_cost_bits(struct AACEncContext *s, const float *in,
-                                const float *scaled, int size, int scale_idx,
+static inline int quantize_band_cost_bits(struct AACEncContext *s, AACEncSearchContext *sc,
+                                const float *in, const float *scaled, int size, int scale_idx,
                                 int cb, const float lambda, const float uplim,
                                 int *bits, float *energy)
 {
     int auxbits;
-    ff_quantize_and_encode_band_cost(s, NULL, in, NULL, scaled, size, scale_idx,
+    ff_quantize_and_encode_band_cost(s, sc, NULL, in, NULL, scaled, size, scale_idx,
                                      cb, 0.0f, uplim, &auxbits, energy);
     if (bits) {
         *bits = auxbits;
@@ -241,6 +241,37 @@ static av_always_inline int lcg_random(unsigned previous_val)
     return v.s;
 }
 
+/**
+ * Bandwidth the two-loop quantizer search limits channels to, and which it
+ * hands to the psychoacoustic model, when the user didn't set a cutoff.
+ */
+static inline int ff_aac_twoloop_bandwidth(const AVCodecContext *avctx,
+                                           const AACEncContext *s,
+                                           const float lambda)
+{
+    int refbits = avctx->bit_rate * 1024.0 / avctx->sample_rate
+        / ((avctx->flags & AV_CODEC_FLAG_QSCALE) ? 2.0f : avctx->ch_layout.nb_channels)
+        * (lambda / 120.f);
+
+    /**
+     * Scale, psy gives us constant quality, this LP only scales
+     * bitrate by lambda, so we save bits on subjectively unimportant HF
+     * rather than increase quantization noise. Adjust nominal bitrate
+     * to effective bitrate according to encoding parameters,
+     * AAC_CUTOFF_FROM_BITRATE is calibrated for effective bitrate.
+     */
+    float rate_bandwidth_multiplier = 1.5f;
+    int frame_bit_rate = (avctx->flags & AV_CODEC_FLAG_QSCALE)
+        ? (refbits * rate_bandwidth_multiplier * avctx->sample_rate / 1024)
+        : (avctx->bit_rate / avctx->ch_layout.nb_channels);
+
+    /** Compensate for extensions that increase efficiency */
+    if (s->options.pns || s->options.intensity_stereo)
+        frame_bit_rate *= 1.15f;
+
+    return FFMAX(3000, AAC_CUTOFF_FROM_BITRATE(frame_bit_rate, 1, avctx->sample_rate));
+}
+
 #define ERROR_IF(cond, ...) \
     if (cond) { \
         av_log(avctx, AV_LOG_ERROR, __VA_ARGS__); \
@@ -85,6 +85,7 @@ typedef struct EXRContext {
     PutByteContext pb;
 
     EXRScanlineData *scanline;
+    int *scanline_ret;                ///< return value of each scanline job
 
     Float2HalfTables f2h_tables;
 } EXRContext;
@@ -130,8 +131,9 @@ static av_cold int encode_init(AVCodecContext *avctx)
         av_assert0(0);
     }
 
-    s->scanline = av_calloc(s->nb_scanlines, sizeof(*s->scanline));
-    if (!s->scanline)
+    s->scanline     = av_calloc(s->nb_scanlines, sizeof(*s->scanline));
+    s->scanline_ret = av_calloc(s->nb_scanlines, sizeof(*s->scanline_ret));
+    if (!s->scanline || !s->scanline_ret)
         return AVERROR(ENOMEM);
 
     return 0;
@@ -150,6 +152,7 @@ static av_cold int encode_close(AVCodecContext *avctx)
     }
 
     av_freep(&s->scanline);
+    av_freep(&s->scanline_ret);
 
     return 0;
 }
@@ -217,130 +220,129 @@ static int64_t rle_compress(uint8_t *out, int64_t out_size,
     return o;
 }
 
-static int encode_scanline_rle(EXRContext *s, const AVFrame *frame)
+static int encode_scanline_rle(AVCodecContext *avctx, void *arg, int y, int threadnr)
 {
+    EXRContext *s = avctx->priv_data;
+    const AVFrame *frame = arg;
     const int64_t element_size = s->pixel_type == EXR_HALF ? 2LL : 4LL;
+    EXRScanlineData *scanline = &s->scanline[y];
+    int64_t tmp_size = element_size * s->planes * frame->width;
+    int64_t max_compressed_size = tmp_size * 3 / 2;
 
-    for (int y = 0; y < frame->height; y++) {
-        EXRScanlineData *scanline = &s->scanline[y];
-        int64_t tmp_size = element_size * s->planes * frame->width;
-        int64_t max_compressed_size = tmp_size * 3 / 2;
-
-        av_fast_padded_malloc(&scanline->uncompressed_data, &scanline->uncompressed_size, tmp_size);
-        if (!scanline->uncompressed_data)
-            return AVERROR(ENOMEM);
-
-        av_fast_padded_malloc(&scanline->tmp, &scanline->tmp_size, tmp_size);
-        if (!scanline->tmp)
-            return AVERROR(ENOMEM);
+    av_fast_padded_malloc(&scanline->uncompressed_data, &scanline->uncompressed_size, tmp_size);
+    if (!scanline->uncompressed_data)
+        return AVERROR(ENOMEM);
 
-        av_fast_padded_malloc(&scanline->compressed_data, &scanline->compressed_size, max_compressed_size);
-        if (!scanline->compressed_data)
-            return AVERROR(ENOMEM);
+    av_fast_padded_malloc(&scanline->tmp, &scanline->tmp_size, tmp_size);
+    if (!scanline->tmp)
+        return AVERROR(ENOMEM);
 
-        switch (s->pixel_type) {
-        case EXR_FLOAT:
-            for (int p = 0; p < s->planes; p++) {
-                int ch = s->ch_order[p];
+    av_fast_padded_malloc(&scanline->compressed_data, &scanline->compressed_size, max_compressed_size);
+    if (!scanline->compressed_data)
+        return AVERROR(ENOMEM);
 
-                memcpy(scanline->uncompressed_data + frame->width * 4 * p,
-                       frame->data[ch] + y * frame->linesize[ch], frame->width * 4);
-            }
-            break;
-        case EXR_HALF:
-            for (int p = 0; p < s->planes; p++) {
-                int ch = s->ch_order[p];
-                uint16_t *dst = (uint16_t *)(scanline->uncompressed_data + frame->width * 2 * p);
-                const uint32_t *src = (const uint32_t *)(frame->data[ch] + y * frame->linesize[ch]);
+    switch (s->pixel_type) {
+    case EXR_FLOAT:
+        for (int p = 0; p < s->planes; p++) {
+            int ch = s->ch_order[p];
 
-                for (int x = 0; x < frame->width; x++)
-                    dst[x] = float2half(src[x], &s->f2h_tables);
-            }
-            break;
+            memcpy(scanline->uncompressed_data + frame->width * 4 * p,
+                   frame->data[ch] + y * frame->linesize[ch], frame->width * 4);
+        }
+        break;
+    case EXR_HALF:
+        for (int p = 0; p < s->planes; p++) {
+            int ch = s->ch_order[p];
+            uint16_t *dst = (uint16_t *)(scanline->uncompressed_data + frame->width * 2 * p);
+            const uint32_t *src = (const uint32_t *)(frame->data[ch] + y * frame->linesize[ch]);
+
+            for (int x = 0; x < frame->width; x++)
+                dst[x] = float2half(src[x], &s->f2h_tables);
         }
+        break;
+    }
 
-        reorder_pixels(scanline->tmp, scanline->uncompressed_data, tmp_size);
-        predictor(scanline->tmp, tmp_size);
-        scanline->actual_size = rle_compress(scanline->compressed_data,
-                                             max_compressed_size,
-                                             scanline->tmp, tmp_size);
+    reorder_pixels(scanline->tmp, scanline->uncompressed_data, tmp_size);
+    predictor(scanline->tmp, tmp_size);
+    scanline->actual_size = rle_compress(scanline->compressed_data,
+                                         max_compressed_size,
+                                         scanline->tmp, tmp_size);
 
-        if (scanline->actual_size <= 0 || scanline->actual_size >= tmp_size) {
-            FFSWAP(uint8_t *, scanline->uncompressed_data, scanline->compressed_data);
-            FFSWAP(int, scanline->uncompressed_size, scanline->compressed_size);
-            scanline->actual_size = tmp_size;
-        }
+    if (scanline->actual_size <= 0 || scanline->actual_size >= tmp_size) {
+        FFSWAP(uint8_t *, scanline->uncompressed_data, scanline->compressed_data);
+        FFSWAP(int, scanline->uncompressed_size, scanline->compressed_size);
+        scanline->actual_size = tmp_size;
     }
 
     return 0;
 }
 
-static int encode_scanline_zip(EXRContext *s, const AVFrame *frame)
+static int encode_scanline_zip(AVCodecContext *avctx, void *arg, int y, int threadnr)
 {
+    EXRContext *s = avctx->priv_data;
+    const AVFrame *frame = arg;
     const int64_t element_size = s->pixel_type == EXR_HALF ? 2LL : 4LL;
+    EXRScanlineData *scanline = &s->scanline[y];
+    const int scanline_height = FFMIN(s->scanline_height, frame->height - y * s->scanline_height);
+    int64_t tmp_size = element_size * s->planes * frame->width * scanline_height;
+    int64_t max_compressed_size = tmp_size * 3 / 2;
+    unsigned long actual_size, source_size;
+
+    av_fast_padded_malloc(&scanline->uncompressed_data, &scanline->uncompressed_size, tmp_size);
+    if (!scanline->uncompressed_data)
+        return AVERROR(ENOMEM);
 
-    for (int y = 0; y < s->nb_scanlines; y++) {
-        EXRScanlineData *scanline = &s->scanline[y];
-        const int scanline_height = FFMIN(s->scanline_height, frame->height - y * s->scanline_height);
-        int64_t tmp_size = element_size * s->planes * frame->width * scanline_height;
-        int64_t max_compressed_size = tmp_size * 3 / 2;
-        unsigned long actual_size, source_size;
-
-        av_fast_padded_malloc(&scanline->uncompressed_data, &scanline->uncompressed_size, tmp_size);
-        if (!scanline->uncompressed_data)
-            return AVERROR(ENOMEM);
-
-        av_fast_padded_malloc(&scanline->tmp, &scanline->tmp_size, tmp_size);
-        if (!scanline->tmp)
-            return AVERROR(ENOMEM);
+    av_fast_padded_malloc(&scanline->tmp, &scanline->tmp_size, tmp_size);
+    if (!scanline->tmp)
+        return AVERROR(ENOMEM);
 
-        av_fast_padded_malloc(&scanline->compressed_data, &scanline->compressed_size, max_compressed_size);
-        if (!scanline->compressed_data)
-            return AVERROR(ENOMEM);
+    av_fast_padded_malloc(&scanline->compressed_data, &scanline->compressed_size, max_compressed_size);
+    if (!scanline->compressed_data)
+        return AVERROR(ENOMEM);
 
-        switch (s->pixel_type) {
-        case EXR_FLOAT:
-            for (int l = 0; l < scanline_height; l++) {
-                const int scanline_size = frame->width * 4 * s->planes;
+    switch (s->pixel_type) {
+    case EXR_FLOAT:
+        for (int l = 0; l < scanline_height; l++) {
+            const int scanline_size = frame->width * 4 * s->planes;
 
-                for (int p = 0; p < s->planes; p++) {
-                    int ch = s->ch_order[p];
+            for (int p = 0; p < s->planes; p++) {
+                int ch = s->ch_order[p];
 
-                    memcpy(scanline->uncompressed_data + scanline_size * l + p * frame->width * 4,
-                           frame->data[ch] + (y * s->scanline_height + l) * frame->linesize[ch],
-                           frame->width * 4);
-                }
+                memcpy(scanline->uncompressed_data + scanline_size * l + p * frame->width * 4,
+                       frame->data[ch] + (y * s->scanline_height + l) * frame->linesize[ch],
+                       frame->width * 4);
             }
-            break;
-        case EXR_HALF:
-            for (int l = 0; l < scanline_height; l++) {
-                const int scanline_size = frame->width * 2 * s->planes;
+        }
+        break;
+    case EXR_HALF:
+        for (int l = 0; l < scanline_height; l++) {
+            const int scanline_size = frame->width * 2 * s->planes;
 
-                for (int p = 0; p < s->planes; p++) {
-                    int ch = s->ch_order[p];
-                    uint16_t *dst = (uint16_t *)(scanline->uncompressed_data + scanline_size * l + p * frame->width * 2);
-                    const uint32_t *src = (const uint32_t *)(frame->data[ch] + (y * s->scanline_height + l) * frame->linesize[ch]);
+            for (int p = 0; p < s->planes; p++) {
+                int ch = s->ch_order[p];
+                uint16_t *dst = (uint16_t *)(scanline->uncompressed_data + scanline_size * l + p * frame->width * 2);
+                const uint32_t *src = (const uint32_t *)(frame->data[ch] + (y * s->scanline_height + l) * frame->linesize[ch]);
 
-                    for (int x = 0; x < frame->width; x++)
-                        dst[x] = float2half(src[x], &s->f2h_tables);
-                }
+                for (int x = 0; x < frame->width; x++)
+                    dst[x] = float2half(src[x], &s->f2h_tables);
             }
-            break;
         }
+        break;
+    }
 
-        reorder_pixels(scanline->tmp, scanline->uncompressed_data, tmp_size);
-        predictor(scanline->tmp, tmp_size);
-        source_size = tmp_size;
-        actual_size = max_compressed_size;
-        compress(scanline->compressed_data, &actual_size,
-                 scanline->tmp, source_size);
-
-        scanline->actual_size = actual_size;
-        if (scanline->actual_size >= tmp_size) {
-            FFSWAP(uint8_t *, scanline->uncompressed_data, scanline->compressed_data);
-            FFSWAP(int, scanline->uncompressed_size, scanline->compressed_size);
-            scanline->actual_size = tmp_size;
-        }
+    reorder_pixels(scanline->tmp, scanline->uncompressed_data, tmp_size);
+    predictor(scanline->tmp, tmp_size);
+    source_size = tmp_size;
+    actual_size = max_compressed_size;
+    if (compress(scanline->compressed_data, &actual_size,
+                 scanline->tmp, source_size) != Z_OK)
+        return AVERROR_EXTERNAL;
+
+    scanline->actual_size = actual_size;
+    if (scanline->actual_size >= tmp_size) {
+        FFSWAP(uint8_t *, scanline->uncompressed_data, scanline->compressed_data);
+        FFSWAP(int, scanline->uncompressed_size, scanline->compressed_size);
+        scanline->actual_size = tmp_size;
     }
 
     return 0;
@@ -436,16 +438,23 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
         /* nothing to do */
         break;
     case EXR_RLE:
-        encode_scanline_rle(s, frame);
+        avctx->execute2(avctx, encode_scanline_rle, (void *)frame, s->scanline_ret,
+                        frame->height);
         break;
     case EXR_ZIP16:
     case EXR_ZIP1:
-        encode_scanline_zip(s, frame);
+        avctx->execute2(avctx, encode_scanline_zip, (void *)frame, s->scanline_ret,
+                        s->nb_scanlines);
         break;
     default:
         av_assert0(0);
     }
 
+    for (int y = 0; y < s->nb_scanlines; y++) {
+        if (s->scanline_ret[y] < 0)
+            return s->scanline_ret[y];
+    }
+
     switch (s->compression) {
     case EXR_RAW:
         offset = bytestream2_tell_p(pb) + avctx->height * 8LL;
@@ -547,6 +556,7 @@ const FFCodec ff_exr_encoder = {
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_EXR,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .init           = encode_init,
     FF_CODEC_ENCODE_CB(encode_frame),
@@ -96,12 +96,15 @@ typedef struct FFV1SliceContext {
         struct {
             int slice_reset_contexts;
             int slice_damaged;
+            const uint8_t *slice_buf;    ///< coded slice including its trailer
+            int slice_buf_size;
         };
 
         // encoder-only
         struct {
             uint64_t rc_stat[256][2];
             uint64_t (*rc_stat2[MAX_QUANT_TABLES])[32][2];
+            uint32_t crc;                ///< CRC of the first ac_byte_count bytes
         };
     };
 } FFV1SliceContext;
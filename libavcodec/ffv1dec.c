@@ -274,6 +274,27 @@ static int decode_slice(AVCodecContext *c, void *arg)
     const int      si = sc - f->slices;
     GetBitContext gb;
 
+    if (f->ec) {
+        unsigned crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE), 0,
+                              sc->slice_buf, sc->slice_buf_size);
+        if (crc) {
+            int64_t ts = p->pts != AV_NOPTS_VALUE ? p->pts : p->pkt_dts;
+            av_log(f->avctx, AV_LOG_ERROR, "slice CRC mismatch %X!", crc);
+            if (ts != AV_NOPTS_VALUE && c->pkt_timebase.num) {
+                av_log(f->avctx, AV_LOG_ERROR, "at %f seconds\n", ts*av_q2d(c->pkt_timebase));
+            } else if (ts != AV_NOPTS_VALUE) {
+                av_log(f->avctx, AV_LOG_ERROR, "at %"PRId64"\n", ts);
+            } else {
+                av_log(f->avctx, AV_LOG_ERROR, "\n");
+            }
+            slice_set_damaged(f, sc);
+        }
+        if (c->debug & FF_DEBUG_PICT_INFO) {
+            av_log(c, AV_LOG_DEBUG, "slice %d, CRC: 0x%08"PRIX32"\n", si,
+                   AV_RB32(sc->slice_buf + sc->slice_buf_size - 4));
+        }
+    }
+
     if (!(p->flags & AV_FRAME_FLAG_KEY) && f->last_picture.f)
         ff_progress_frame_await(&f->last_picture, si);
 
@@ -944,24 +965,9 @@ static int decode_frame(AVCodecContext *avctx, AVFrame *rframe,
         }
         buf_p -= v;
 
-        if (f->ec) {
-            unsigned crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE), 0, buf_p, v);
-            if (crc) {
-                int64_t ts = avpkt->pts != AV_NOPTS_VALUE ? avpkt->pts : avpkt->dts;
-                av_log(f->avctx, AV_LOG_ERROR, "slice CRC mismatch %X!", crc);
-                if (ts != AV_NOPTS_VALUE && avctx->pkt_timebase.num) {
-                    av_log(f->avctx, AV_LOG_ERROR, "at %f seconds\n", ts*av_q2d(avctx->pkt_timebase));
-                } else if (ts != AV_NOPTS_VALUE) {
-                    av_log(f->avctx, AV_LOG_ERROR, "at %"PRId64"\n", ts);
-                } else {
-                    av_log(f->avctx, AV_LOG_ERROR, "\n");
-                }
-                slice_set_damaged(f, sc);
-            }
-            if (avctx->debug & FF_DEBUG_PICT_INFO) {
-                av_log(avctx, AV_LOG_DEBUG, "slice %d, CRC: 0x%08"PRIX32"\n", i, AV_RB32(buf_p + v - 4));
-            }
-        }
+        // the CRC is checked by the slice thread
+        sc->slice_buf      = buf_p;
+        sc->slice_buf_size = v;
 
         if (i) {
             ff_init_range_decoder(&sc->c, buf_p, v);
@@ -853,8 +853,14 @@ static av_cold int encode_init(AVCodecContext *avctx)
         int plane_count = 1 + 2*s->chroma_planes + s->transparency;
         int max_h_slices = AV_CEIL_RSHIFT(avctx->width , s->chroma_h_shift);
         int max_v_slices = AV_CEIL_RSHIFT(avctx->height, s->chroma_v_shift);
+        int min_slices = 0, best_h_slices = 0, best_v_slices = 0;
         s->num_v_slices = (avctx->width > 352 || avctx->height > 288 || !avctx->slices) ? 2 : 1;
 
+        // Unspecified slices, use enough of them to keep all slice threads busy
+        if (!avctx->slices && !(avctx->flags & AV_CODEC_FLAG_BITEXACT) &&
+            avctx->active_thread_type & FF_THREAD_SLICE)
+            min_slices = FFMIN(avctx->thread_count, MAX_SLICES);
+
         s->num_v_slices = FFMIN(s->num_v_slices, max_v_slices);
 
         for (; s->num_v_slices < 32; s->num_v_slices++) {
@@ -869,10 +875,23 @@ static av_cold int encode_init(AVCodecContext *avctx)
                     if (  ff_need_new_slices(avctx->width , s->num_h_slices, s->chroma_h_shift)
                         ||ff_need_new_slices(avctx->height, s->num_v_slices, s->chroma_v_shift))
                         continue;
-                if (avctx->slices == s->num_h_slices * s->num_v_slices && avctx->slices <= MAX_SLICES || !avctx->slices)
+                if (avctx->slices == s->num_h_slices * s->num_v_slices && avctx->slices <= MAX_SLICES)
                     goto slices_ok;
+                if (!avctx->slices && s->num_h_slices * s->num_v_slices <= MAX_SLICES) {
+                    if (s->num_h_slices * s->num_v_slices >= min_slices)
+                        goto slices_ok;
+                    if (s->num_h_slices * s->num_v_slices > best_h_slices * best_v_slices) {
+                        best_h_slices = s->num_h_slices;
+                        best_v_slices = s->num_v_slices;
+                    }
+                }
             }
         }
+        if (best_h_slices) {
+            s->num_h_slices = best_h_slices;
+            s->num_v_slices = best_v_slices;
+            goto slices_ok;
+        }
         av_log(avctx, AV_LOG_ERROR,
                "Unsupported number %d of slices requested, please specify a "
                "supported number with -slices (ex:4,6,9,12,16, ...)\n",
@@ -1128,6 +1147,10 @@ retry:
         goto retry;
     }
 
+    if (f->ec)
+        sc->crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE), 0,
+                         sc->c.bytestream_start, sc->ac_byte_count);
+
     return 0;
 }
 
@@ -1251,7 +1274,8 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
         if (f->ec) {
             unsigned v;
             buf_p[bytes++] = 0;
-            v = av_crc(av_crc_get_table(AV_CRC_32_IEEE), 0, buf_p, bytes);
+            v = av_crc(av_crc_get_table(AV_CRC_32_IEEE), sc->crc,
+                       buf_p + sc->ac_byte_count, bytes - sc->ac_byte_count);
             AV_WL32(buf_p + bytes, v);
             bytes += 4;
         }
@@ -120,7 +120,8 @@ typedef struct FlacEncodeContext {
     FlacFrame frame;
     CompressionOptions options;
     AVCodecContext *avctx;
-    LPCContext lpc_ctx;
+    LPCContext *lpc_ctx;                    ///< one for each slice thread
+    int nb_lpc_ctx;
     struct AVMD5 *md5ctx;
     uint8_t *md5_buffer;
     unsigned int md5_buffer_size;
@@ -464,8 +465,15 @@ static av_cold int flac_encode_init(AVCodecContext *avctx)
         }
     }
 
-    ret = ff_lpc_init(&s->lpc_ctx, avctx->frame_size,
-                      s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+    s->lpc_ctx = av_calloc(avctx->thread_count, sizeof(*s->lpc_ctx));
+    if (!s->lpc_ctx)
+        return AVERROR(ENOMEM);
+    for (; s->nb_lpc_ctx < avctx->thread_count; s->nb_lpc_ctx++) {
+        ret = ff_lpc_init(&s->lpc_ctx[s->nb_lpc_ctx], avctx->frame_size,
+                          s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+        if (ret < 0)
+            return ret;
+    }
 
     ff_bswapdsp_init(&s->bdsp);
     ff_flacencdsp_init(&s->flac_dsp);
@@ -950,7 +958,7 @@ static int lpc_encode_choose_datapath(FlacEncodeContext *s, int32_t bps,
     return subframe_count_exact(s, sub, 0);                 \
 }
 
-static int encode_residual_ch(FlacEncodeContext *s, int ch)
+static int encode_residual_ch(FlacEncodeContext *s, LPCContext *lpc, int ch)
 {
     int i, n;
     int min_order, max_order, opt_order, omethod;
@@ -1048,7 +1056,7 @@ static int encode_residual_ch(FlacEncodeContext *s, int ch)
         for (i = 0; i < n; i++)
             smp[i] = smp_33bps[i] >> 1;
 
-    opt_order = ff_lpc_calc_coefs(&s->lpc_ctx, smp, n, min_order, max_order,
+    opt_order = ff_lpc_calc_coefs(lpc, smp, n, min_order, max_order,
                                   s->options.lpc_coeff_precision, coefs, shift, s->options.lpc_type,
                                   s->options.lpc_passes, omethod,
                                   MIN_LPC_SHIFT, MAX_LPC_SHIFT, 0);
@@ -1206,15 +1214,28 @@ static int count_frame_header(FlacEncodeContext *s)
 }
 
 
+static int encode_residual_thread(AVCodecContext *avctx, void *arg,
+                                  int ch, int threadnr)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    uint64_t *count = arg;
+
+    count[ch] = encode_residual_ch(s, &s->lpc_ctx[threadnr], ch);
+    return 0;
+}
+
+
 static int encode_frame(FlacEncodeContext *s)
 {
     int ch;
-    uint64_t count;
+    uint64_t count, ch_count[FLAC_MAX_CHANNELS];
 
     count = count_frame_header(s);
 
+    s->avctx->execute2(s->avctx, encode_residual_thread, ch_count, NULL,
+                       s->channels);
     for (ch = 0; ch < s->channels; ch++)
-        count += encode_residual_ch(s, ch);
+        count += ch_count[ch];
 
     count += (8 - (count & 7)) & 7; // byte alignment
     count += 16;                    // CRC-16
@@ -1705,7 +1726,9 @@ static av_cold int flac_encode_close(AVCodecContext *avctx)
 
     av_freep(&s->md5ctx);
     av_freep(&s->md5_buffer);
-    ff_lpc_end(&s->lpc_ctx);
+    for (int i = 0; i < s->nb_lpc_ctx; i++)
+        ff_lpc_end(&s->lpc_ctx[i]);
+    av_freep(&s->lpc_ctx);
     return 0;
 }
 
@@ -1754,7 +1777,7 @@ const FFCodec ff_flac_encoder = {
     .p.type         = AVMEDIA_TYPE_AUDIO,
     .p.id           = AV_CODEC_ID_FLAC,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_SMALL_LAST_FRAME |
+                      AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .priv_data_size = sizeof(FlacEncodeContext),
     .init           = flac_encode_init,
@@ -876,16 +876,7 @@ void ff_hevc_hls_filter(HEVCLocalContext *lc, const HEVCLayerContext *l,
     const HEVCSPS   *const sps = pps->sps;
     const HEVCContext *const s = lc->parent;
     int x_end = x >= sps->width  - ctb_size;
-    int skip = 0;
-    if (s->avctx->skip_loop_filter >= AVDISCARD_ALL ||
-        (s->avctx->skip_loop_filter >= AVDISCARD_NONKEY && !IS_IDR(s)) ||
-        (s->avctx->skip_loop_filter >= AVDISCARD_NONINTRA &&
-         s->sh.slice_type != HEVC_SLICE_I) ||
-        (s->avctx->skip_loop_filter >= AVDISCARD_BIDIR &&
-         s->sh.slice_type == HEVC_SLICE_B) ||
-        (s->avctx->skip_loop_filter >= AVDISCARD_NONREF &&
-        ff_hevc_nal_is_nonref(s->nal_unit_type)))
-        skip = 1;
+    int skip = CTB(l->filter_skip, x >> sps->log2_ctb_size, y >> sps->log2_ctb_size);
 
     if (!skip)
         deblocking_filter_CTB(s, l, pps, sps, x, y);
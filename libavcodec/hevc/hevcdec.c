@@ -28,6 +28,7 @@
 #include "libavutil/attributes.h"
 #include "libavutil/avstring.h"
 #include "libavutil/common.h"
+#include "libavutil/executor.h"
 #include "libavutil/film_grain_params.h"
 #include "libavutil/internal.h"
 #include "libavutil/md5.h"
@@ -83,6 +84,7 @@ static void pic_arrays_free(HEVCLayerContext *l)
     av_freep(&l->qp_y_tab);
     av_freep(&l->tab_slice_address);
     av_freep(&l->filter_slice_edges);
+    av_freep(&l->filter_skip);
 
     av_freep(&l->horizontal_bs);
     av_freep(&l->vertical_bs);
@@ -127,11 +129,13 @@ static int pic_arrays_init(HEVCLayerContext *l, const HEVCSPS *sps)
         goto fail;
 
     l->filter_slice_edges = av_mallocz(ctb_count);
+    l->filter_skip        = av_malloc(ctb_count);
     l->tab_slice_address  = av_malloc_array(pic_size_in_ctb,
                                       sizeof(*l->tab_slice_address));
     l->qp_y_tab           = av_calloc(pic_size_in_ctb,
                                       sizeof(*l->qp_y_tab));
-    if (!l->qp_y_tab || !l->filter_slice_edges || !l->tab_slice_address)
+    if (!l->qp_y_tab || !l->filter_slice_edges || !l->filter_skip ||
+        !l->tab_slice_address)
         goto fail;
 
     l->horizontal_bs = av_calloc(l->bs_width, l->bs_height);
@@ -2681,6 +2685,23 @@ static void hls_decode_neighbour(HEVCLocalContext *lc,
     lc->ctb_up_left_flag = ((x_ctb > 0) && (y_ctb > 0)  && (ctb_addr_in_slice-1 >= sps->ctb_width) && (pps->tile_id[ctb_addr_ts] == pps->tile_id[pps->ctb_addr_rs_to_ts[ctb_addr_rs-1 - sps->ctb_width]]));
 }
 
+/**
+ * Whether skip_loop_filter disables the in-loop filters for the current slice.
+ * The decision is stored per CTB, as the filters may run after the following
+ * slices were parsed.
+ */
+static int skip_loop_filter(const HEVCContext *s)
+{
+    return s->avctx->skip_loop_filter >= AVDISCARD_ALL ||
+           (s->avctx->skip_loop_filter >= AVDISCARD_NONKEY && !IS_IDR(s)) ||
+           (s->avctx->skip_loop_filter >= AVDISCARD_NONINTRA &&
+            s->sh.slice_type != HEVC_SLICE_I) ||
+           (s->avctx->skip_loop_filter >= AVDISCARD_BIDIR &&
+            s->sh.slice_type == HEVC_SLICE_B) ||
+           (s->avctx->skip_loop_filter >= AVDISCARD_NONREF &&
+            ff_hevc_nal_is_nonref(s->nal_unit_type));
+}
+
 static int hls_decode_entry(HEVCContext *s, GetBitContext *gb)
 {
     HEVCLocalContext *const lc = &s->local_ctx[0];
@@ -2721,15 +2742,16 @@ static int hls_decode_entry(HEVCContext *s, GetBitContext *gb)
             l->tab_slice_address[ctb_addr_rs] = -1;
             return more_data;
         }
-
+        l->filter_skip[ctb_addr_rs] = skip_loop_filter(s);
 
         ctb_addr_ts++;
         ff_hevc_save_states(lc, pps, ctb_addr_ts);
-        ff_hevc_hls_filters(lc, l, pps, x_ctb, y_ctb, ctb_size);
+        if (!s->filter_deferred)
+            ff_hevc_hls_filters(lc, l, pps, x_ctb, y_ctb, ctb_size);
     }
 
     if (x_ctb + ctb_size >= sps->width &&
-        y_ctb + ctb_size >= sps->height)
+        y_ctb + ctb_size >= sps->height && !s->filter_deferred)
         ff_hevc_hls_filter(lc, l, pps, x_ctb, y_ctb, ctb_size);
 
     return ctb_addr_ts;
@@ -2793,6 +2815,7 @@ static int hls_decode_entry_wpp(AVCodecContext *avctx, void *hevc_lclist,
             ret = more_data;
             goto error;
         }
+        l->filter_skip[ctb_addr_rs] = skip_loop_filter(s);
 
         ctb_addr_ts++;
 
@@ -2830,6 +2853,199 @@ error:
     return ret;
 }
 
+static void hls_filter_ctb(HEVCContext *s, HEVCLocalContext *lc,
+                           int x_ctb, int y_ctb)
+{
+    const HEVCLayerContext *const l = &s->layers[s->cur_layer];
+    const HEVCPPS *const pps = s->pps;
+    const HEVCSPS *const sps = pps->sps;
+
+    ff_hevc_hls_filter(lc, l, pps, x_ctb << sps->log2_ctb_size,
+                       y_ctb << sps->log2_ctb_size, 1 << sps->log2_ctb_size);
+}
+
+/**
+ * Run the in-loop filters on one CTB row of the current frame, once all of
+ * its CTBs are decoded. Filtering a CTB touches its left and upper neighbours,
+ * so each row stays two CTBs behind the row above it, like WPP decoding.
+ *
+ * The last row is filtered along with the one above it, interleaved the same
+ * way as when filtering during decoding, as the SAO of the second to last row
+ * depends on that order.
+ */
+static int hls_filter_row(HEVCContext *s, HEVCLocalContext *lc, int ctb_row)
+{
+    const HEVCSPS *const sps = s->pps->sps;
+    int ctb_width = sps->ctb_width;
+    int last      = ctb_row == sps->ctb_height - 2;
+
+    for (int x_ctb = 0; x_ctb < ctb_width; x_ctb++) {
+        if (ctb_row)
+            ff_thread_progress_await(&s->wpp_progress[ctb_row - 1],
+                                     FFMIN(x_ctb + 2, ctb_width));
+
+        if (!last) {
+            hls_filter_ctb(s, lc, x_ctb, ctb_row);
+        } else {
+            if (x_ctb < ctb_width - 1 || ctb_width == 1)
+                hls_filter_ctb(s, lc, x_ctb, ctb_row);
+            if (x_ctb == ctb_width - 2)
+                hls_filter_ctb(s, lc, ctb_width - 1, ctb_row);
+            hls_filter_ctb(s, lc, x_ctb, ctb_row + 1);
+        }
+
+        ff_thread_progress_report(&s->wpp_progress[ctb_row], x_ctb + 1);
+    }
+
+    return 0;
+}
+
+typedef struct HEVCWPPTask {
+    AVTask task;
+
+    int ctb_row;
+    // run the in-loop filters on the row instead of decoding it
+    int filter;
+    int ret;
+} HEVCWPPTask;
+
+static int wpp_task_priority_higher(const AVTask *_a, const AVTask *_b)
+{
+    const HEVCWPPTask *a = (const HEVCWPPTask*)_a;
+    const HEVCWPPTask *b = (const HEVCWPPTask*)_b;
+
+    // rows must be started in order, each one waits for the row above it
+    return a->ctb_row < b->ctb_row;
+}
+
+static int wpp_task_ready(const AVTask *t, void *user_data)
+{
+    return 1;
+}
+
+static int wpp_task_run(AVTask *_t, void *local_context, void *user_data)
+{
+    HEVCWPPTask       *t = (HEVCWPPTask*)_t;
+    HEVCContext       *s = user_data;
+    HEVCLocalContext *lc = local_context;
+
+    if (t->filter) {
+        lc->logctx = s->avctx;
+        lc->parent = s;
+        t->ret = hls_filter_row(s, lc, t->ctb_row);
+        goto finish;
+    }
+
+    // the first row continues with the state of the slice header parsing
+    if (!t->ctb_row) {
+        lc = &s->local_ctx[0];
+    } else {
+        lc->logctx             = s->avctx;
+        lc->parent             = s;
+        lc->common_cabac_state = &s->cabac;
+        lc->first_qp_group     = 1;
+        lc->qp_y               = s->local_ctx[0].qp_y;
+    }
+
+    t->ret = hls_decode_entry_wpp(s->avctx, lc, t->ctb_row, 0);
+
+finish:
+    ff_mutex_lock(&s->wpp_lock);
+    if (!--s->wpp_tasks_left)
+        ff_cond_signal(&s->wpp_cond);
+    ff_mutex_unlock(&s->wpp_lock);
+
+    return 0;
+}
+
+static av_cold int wpp_executor_init(HEVCContext *s)
+{
+    AVCodecContext *avctx = s->avctx;
+    int nb_threads = FFMAX(s->wpp_threads, s->loop_filter_threads);
+    const AVTaskCallbacks callbacks = {
+        .user_data          = s,
+        .local_context_size = sizeof(HEVCLocalContext),
+        .priority_higher    = wpp_task_priority_higher,
+        .ready              = wpp_task_ready,
+        .run                = wpp_task_run,
+    };
+    int ret;
+
+    ret = ff_mutex_init(&s->wpp_lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+
+    ret = ff_cond_init(&s->wpp_cond, NULL);
+    if (ret) {
+        ff_mutex_destroy(&s->wpp_lock);
+        return AVERROR(ret);
+    }
+
+    // every frame thread has its own executor, split the threads among them
+    if (avctx->active_thread_type & FF_THREAD_FRAME)
+        nb_threads = FFMAX(nb_threads / avctx->thread_count, 1);
+
+    s->wpp_executor = av_executor_alloc(&callbacks, nb_threads);
+    if (!s->wpp_executor) {
+        ff_cond_destroy(&s->wpp_cond);
+        ff_mutex_destroy(&s->wpp_lock);
+        return AVERROR(ENOMEM);
+    }
+
+    return 0;
+}
+
+static av_cold void wpp_executor_free(HEVCContext *s)
+{
+    if (!s->wpp_executor)
+        return;
+
+    av_executor_free(&s->wpp_executor);
+    ff_cond_destroy(&s->wpp_cond);
+    ff_mutex_destroy(&s->wpp_lock);
+    av_freep(&s->wpp_tasks);
+    s->nb_wpp_tasks = 0;
+}
+
+/**
+ * Decode the CTB rows of a WPP slice, or filter the CTB rows of the current
+ * frame, on the WPP executor and wait for them to finish; the return value
+ * of each row is stored in ret unless it is NULL.
+ */
+static int wpp_execute(HEVCContext *s, int *ret, int nb_rows, int filter)
+{
+    if (s->nb_wpp_tasks < nb_rows) {
+        HEVCWPPTask *tmp = av_realloc_array(s->wpp_tasks, nb_rows, sizeof(*tmp));
+        if (!tmp)
+            return AVERROR(ENOMEM);
+        s->wpp_tasks    = tmp;
+        s->nb_wpp_tasks = nb_rows;
+    }
+
+    s->wpp_tasks_left = nb_rows;
+
+    for (int i = 0; i < nb_rows; i++) {
+        HEVCWPPTask *t = &s->wpp_tasks[i];
+
+        memset(t, 0, sizeof(*t));
+        t->ctb_row = i;
+        t->filter  = filter;
+
+        av_executor_execute(s->wpp_executor, &t->task);
+    }
+
+    ff_mutex_lock(&s->wpp_lock);
+    while (s->wpp_tasks_left)
+        ff_cond_wait(&s->wpp_cond, &s->wpp_lock);
+    ff_mutex_unlock(&s->wpp_lock);
+
+    if (ret)
+        for (int i = 0; i < nb_rows; i++)
+            ret[i] = s->wpp_tasks[i].ret;
+
+    return 0;
+}
+
 static int wpp_progress_init(HEVCContext *s, unsigned count)
 {
     if (s->nb_wpp_progress < count) {
@@ -2856,6 +3072,24 @@ static int wpp_progress_init(HEVCContext *s, unsigned count)
     return 0;
 }
 
+/**
+ * Run the deferred in-loop filters of the current frame.
+ */
+static int hevc_filter_frame(HEVCContext *s)
+{
+    const HEVCSPS *const sps = s->pps->sps;
+    int ret;
+
+    s->filter_deferred = 0;
+
+    ret = wpp_progress_init(s, sps->ctb_height);
+    if (ret < 0)
+        return ret;
+
+    // the last row is filtered by the task of the row above it
+    return wpp_execute(s, NULL, FFMAX(sps->ctb_height - 1, 1), 1);
+}
+
 static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
 {
     const HEVCPPS *const pps = s->pps;
@@ -2875,7 +3109,7 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
         return AVERROR_INVALIDDATA;
     }
 
-    if (s->avctx->thread_count > s->nb_local_ctx) {
+    if (!s->wpp_threads && s->avctx->thread_count > s->nb_local_ctx) {
         HEVCLocalContext *tmp = av_malloc_array(s->avctx->thread_count, sizeof(*s->local_ctx));
 
         if (!tmp)
@@ -2948,8 +3182,16 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
     if (!ret)
         return AVERROR(ENOMEM);
 
-    if (pps->entropy_coding_sync_enabled_flag)
-        s->avctx->execute2(s->avctx, hls_decode_entry_wpp, s->local_ctx, ret, s->sh.num_entry_point_offsets + 1);
+    if (pps->entropy_coding_sync_enabled_flag) {
+        if (s->wpp_threads) {
+            res = wpp_execute(s, ret, s->sh.num_entry_point_offsets + 1, 0);
+            if (res < 0) {
+                av_free(ret);
+                return res;
+            }
+        } else
+            s->avctx->execute2(s->avctx, hls_decode_entry_wpp, s->local_ctx, ret, s->sh.num_entry_point_offsets + 1);
+    }
 
     for (i = 0; i <= s->sh.num_entry_point_offsets; i++)
         res += ret[i];
@@ -3004,8 +3246,8 @@ static int decode_slice_data(HEVCContext *s, const HEVCLayerContext *l,
     s->local_ctx[0].tu.cu_qp_offset_cb = 0;
     s->local_ctx[0].tu.cu_qp_offset_cr = 0;
 
-    if (s->avctx->active_thread_type == FF_THREAD_SLICE  &&
-        s->sh.num_entry_point_offsets > 0                &&
+    if ((s->avctx->active_thread_type == FF_THREAD_SLICE || s->wpp_threads) &&
+        s->sh.num_entry_point_offsets > 0                                    &&
         pps->num_tile_rows == 1 && pps->num_tile_columns == 1)
         return hls_slice_data_wpp(s, nal);
 
@@ -3215,6 +3457,7 @@ static int hevc_frame_start(HEVCContext *s, HEVCLayerContext *l,
     memset(l->cbf_luma,      0, sps->min_tb_width * sps->min_tb_height);
     memset(l->is_pcm,        0, (sps->min_pu_width + 1) * (sps->min_pu_height + 1));
     memset(l->tab_slice_address, -1, pic_size_in_ctb * sizeof(*l->tab_slice_address));
+    memset(l->filter_skip,        1, sps->ctb_size);
 
     if (IS_IDR(s))
         ff_hevc_clear_refs(l);
@@ -3322,6 +3565,13 @@ static int hevc_frame_start(HEVCContext *s, HEVCLayerContext *l,
     if (nal_idx >= s->finish_setup_nal_idx)
         ff_thread_finish_setup(s->avctx);
 
+    // without WPP or tiles all CTBs of a frame are decoded by one thread,
+    // filter them in a separate pass that can use more threads
+    s->filter_deferred = s->loop_filter_threads && !s->avctx->hwaccel &&
+                         !pps->entropy_coding_sync_enabled_flag &&
+                         !pps->tiles_enabled_flag &&
+                         s->layers_active_decode == 1;
+
     return 0;
 
 fail:
@@ -3694,6 +3944,14 @@ fail:
         if (!l->cur_frame)
             continue;
 
+        // also filter what was decoded of a broken frame, as inline
+        // filtering would have done
+        if (s->filter_deferred) {
+            int err = hevc_filter_frame(s);
+            if (ret >= 0)
+                ret = err;
+        }
+
         if (ret >= 0)
             ret = hevc_frame_end(s, l);
 
@@ -3858,6 +4116,8 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
 
     ff_hevc_ps_uninit(&s->ps);
 
+    wpp_executor_free(s);
+
     for (int i = 0; i < s->nb_wpp_progress; i++)
         ff_thread_progress_destroy(&s->wpp_progress[i]);
     av_freep(&s->wpp_progress);
@@ -4025,6 +4285,12 @@ static av_cold int hevc_decode_init(AVCodecContext *avctx)
 
     atomic_init(&s->wpp_err, 0);
 
+    if (s->wpp_threads || s->loop_filter_threads) {
+        ret = wpp_executor_init(s);
+        if (ret < 0)
+            return ret;
+    }
+
     if (!avctx->internal->is_copy) {
         const AVPacketSideData *sd;
 
@@ -4066,6 +4332,10 @@ static void hevc_decode_flush(AVCodecContext *avctx)
 static const AVOption options[] = {
     { "apply_defdispwin", "Apply default display window from VUI", OFFSET(apply_defdispwin),
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
+    { "wpp_threads", "Number of threads decoding WPP substreams in parallel, also with frame threading",
+        OFFSET(wpp_threads), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, PAR },
+    { "loop_filter_threads", "Number of threads running the in-loop filters of frames without WPP or tiles",
+        OFFSET(loop_filter_threads), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, PAR },
     { "strict-displaywin", "stricly apply default display window size", OFFSET(apply_defdispwin),
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
     { "view_ids", "Array of view IDs that should be decoded and output; a single -1 to decode all views",
@@ -27,6 +27,7 @@
 
 #include "libavutil/buffer.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/thread.h"
 
 #include "libavcodec/avcodec.h"
 #include "libavcodec/bswapdsp.h"
@@ -469,6 +470,7 @@ typedef struct HEVCLayerContext {
 
     // CTB-level flags affecting loop filter operation
     uint8_t                *filter_slice_edges;
+    uint8_t                *filter_skip; ///< set for CTBs that are not decoded or not filtered
 
     int32_t                *tab_slice_address;
 
@@ -545,6 +547,25 @@ typedef struct HEVCContext {
 
     atomic_int wpp_err;
 
+    /**
+     * Executor running the WPP substreams of a slice, used instead of
+     * avctx->execute2() when the wpp_threads option is set, and the deferred
+     * in-loop filters when loop_filter_threads is set. Unlike slice threading
+     * it is also available with frame threading.
+     */
+    struct AVExecutor  *wpp_executor;
+    struct HEVCWPPTask *wpp_tasks;
+    unsigned         nb_wpp_tasks;
+    // number of submitted WPP tasks that have not finished yet
+    unsigned            wpp_tasks_left;
+    AVMutex             wpp_lock;
+    AVCond              wpp_cond;
+    int                 wpp_threads;
+    int                 loop_filter_threads;
+    // the in-loop filters of the current frame run after all of its CTBs
+    // are decoded, on the WPP executor
+    int                 filter_deferred;
+
     const uint8_t *data;
 
     H2645Packet pkt;
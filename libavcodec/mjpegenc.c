@@ -95,8 +95,15 @@ void ff_mjpeg_amv_encode_picture_header(MpegEncContext *s)
     MJPEGEncContext *const m = (MJPEGEncContext*)s;
     av_assert2(s->mjpeg_ctx == &m->mjpeg);
     /* s->huffman == HUFFMAN_TABLE_OPTIMAL can only be true for MJPEG. */
-    if (!CONFIG_MJPEG_ENCODER || m->mjpeg.huffman != HUFFMAN_TABLE_OPTIMAL)
+    if (!CONFIG_MJPEG_ENCODER || m->mjpeg.huffman != HUFFMAN_TABLE_OPTIMAL) {
         mjpeg_encode_picture_header(s);
+    } else {
+        // Each slice buffers its codes starting at the row it begins with.
+        for (int i = 0; i < s->slice_context_count; i++) {
+            MpegEncContext *const slice = s->thread_context[i];
+            slice->huff_ncode = slice->start_mb_y * m->mjpeg.huff_row_size;
+        }
+    }
 }
 
 #if CONFIG_MJPEG_ENCODER
@@ -122,7 +129,7 @@ static void mjpeg_encode_picture_frame(MpegEncContext *s)
 
     s->header_bits = get_bits_diff(s);
     // Estimate the total size first
-    for (int i = 0; i < m->huff_ncode; i++) {
+    for (size_t i = 0; i < s->huff_ncode; i++) {
         table_id = m->huff_buffer[i].table_id;
         code = m->huff_buffer[i].code;
         nbits = code & 0xf;
@@ -133,7 +140,7 @@ static void mjpeg_encode_picture_frame(MpegEncContext *s)
     bytes_needed = (total_bits + 7) / 8;
     ff_mpv_reallocate_putbitbuffer(s, bytes_needed, bytes_needed);
 
-    for (int i = 0; i < m->huff_ncode; i++) {
+    for (size_t i = 0; i < s->huff_ncode; i++) {
         table_id = m->huff_buffer[i].table_id;
         code = m->huff_buffer[i].code;
         nbits = code & 0xf;
@@ -144,48 +151,53 @@ static void mjpeg_encode_picture_frame(MpegEncContext *s)
         }
     }
 
-    m->huff_ncode = 0;
     s->i_tex_bits = get_bits_diff(s);
 }
 
 /**
- * Builds all 4 optimal Huffman tables.
- *
- * Uses the data stored in the JPEG buffer to compute the tables.
- * Stores the Huffman tables in the bits_* and val_* arrays in the MJpegContext.
+ * Counts the occurrences of the codes in a part of the JPEG buffer.
  *
- * @param m MJpegContext containing the JPEG buffer.
+ * @param ctx The contexts of the 4 tables, in table_id order.
+ * @param codes The first code.
+ * @param nb_codes The number of codes.
  */
-static void mjpeg_build_optimal_huffman(MJpegContext *m)
+static void mjpeg_count_codes(MJpegEncHuffmanContext ctx[4],
+                              const MJpegHuffmanCode *codes, size_t nb_codes)
 {
-    MJpegEncHuffmanContext dc_luminance_ctx;
-    MJpegEncHuffmanContext dc_chrominance_ctx;
-    MJpegEncHuffmanContext ac_luminance_ctx;
-    MJpegEncHuffmanContext ac_chrominance_ctx;
-    MJpegEncHuffmanContext *ctx[4] = { &dc_luminance_ctx,
-                                       &dc_chrominance_ctx,
-                                       &ac_luminance_ctx,
-                                       &ac_chrominance_ctx };
     for (int i = 0; i < 4; i++)
-        ff_mjpeg_encode_huffman_init(ctx[i]);
+        ff_mjpeg_encode_huffman_init(&ctx[i]);
 
-    for (int i = 0; i < m->huff_ncode; i++) {
-        int table_id = m->huff_buffer[i].table_id;
-        int code     = m->huff_buffer[i].code;
+    for (size_t i = 0; i < nb_codes; i++) {
+        int table_id = codes[i].table_id;
 
-        ff_mjpeg_encode_huffman_increment(ctx[table_id], code);
+        if (table_id < 4)
+            ff_mjpeg_encode_huffman_increment(&ctx[table_id], codes[i].code);
     }
+}
 
-    ff_mjpeg_encode_huffman_close(&dc_luminance_ctx,
+/**
+ * Builds all 4 optimal Huffman tables.
+ *
+ * Uses the statistics of the data stored in the JPEG buffer to compute the
+ * tables. Stores the Huffman tables in the bits_* and val_* arrays in the
+ * MJpegContext.
+ *
+ * @param m MJpegContext containing the JPEG buffer.
+ * @param ctx The code counts of the 4 tables, in table_id order.
+ */
+static void mjpeg_build_optimal_huffman(MJpegContext *m,
+                                        MJpegEncHuffmanContext ctx[4])
+{
+    ff_mjpeg_encode_huffman_close(&ctx[0],
                                   m->bits_dc_luminance,
                                   m->val_dc_luminance, 12);
-    ff_mjpeg_encode_huffman_close(&dc_chrominance_ctx,
+    ff_mjpeg_encode_huffman_close(&ctx[1],
                                   m->bits_dc_chrominance,
                                   m->val_dc_chrominance, 12);
-    ff_mjpeg_encode_huffman_close(&ac_luminance_ctx,
+    ff_mjpeg_encode_huffman_close(&ctx[2],
                                   m->bits_ac_luminance,
                                   m->val_ac_luminance, 256);
-    ff_mjpeg_encode_huffman_close(&ac_chrominance_ctx,
+    ff_mjpeg_encode_huffman_close(&ctx[3],
                                   m->bits_ac_chrominance,
                                   m->val_ac_chrominance, 256);
 
@@ -205,6 +217,125 @@ static void mjpeg_build_optimal_huffman(MJpegContext *m)
                                  m->huff_code_ac_chrominance,
                                  m->bits_ac_chrominance,
                                  m->val_ac_chrominance);
+
+    // Replace the VLCs with the optimal ones.
+    // The default ones may be used for trellis during quantization.
+    init_uni_ac_vlc(m->huff_size_ac_luminance,   m->uni_ac_vlc_len);
+    init_uni_ac_vlc(m->huff_size_ac_chrominance, m->uni_chroma_ac_vlc_len);
+}
+
+static int mjpeg_count_slice(AVCodecContext *avctx, void *arg,
+                             int jobnr, int threadnr)
+{
+    MpegEncContext *const s = ((MpegEncContext *)avctx->priv_data)->thread_context[jobnr];
+    MJpegContext *const m = s->mjpeg_ctx;
+    size_t start = s->start_mb_y * m->huff_row_size;
+
+    mjpeg_count_codes(&m->huff_stats[4 * jobnr], m->huff_buffer + start,
+                      s->huff_ncode - start);
+    return 0;
+}
+
+static int mjpeg_encode_slice(AVCodecContext *avctx, void *arg,
+                              int jobnr, int threadnr)
+{
+    MpegEncContext *const s = ((MpegEncContext *)avctx->priv_data)->thread_context[jobnr];
+    MJpegContext *const m = s->mjpeg_ctx;
+    uint8_t  *huff_size[4] = { m->huff_size_dc_luminance,
+                               m->huff_size_dc_chrominance,
+                               m->huff_size_ac_luminance,
+                               m->huff_size_ac_chrominance };
+    uint16_t *huff_code[4] = { m->huff_code_dc_luminance,
+                               m->huff_code_dc_chrominance,
+                               m->huff_code_ac_luminance,
+                               m->huff_code_ac_chrominance };
+    size_t start = s->start_mb_y * m->huff_row_size;
+    size_t total_bits = 0;
+
+    for (size_t i = start; i < s->huff_ncode; i++) {
+        const MJpegHuffmanCode *c = &m->huff_buffer[i];
+
+        if (c->table_id < 4)
+            total_bits += huff_size[c->table_id][c->code] + (c->code & 0xf);
+    }
+    if (put_bytes_left(&s->pb, 0) < (total_bits + 7) / 8) {
+        av_log(avctx, AV_LOG_ERROR, "encoded slice too large\n");
+        return AVERROR(EINVAL);
+    }
+
+    for (size_t i = start; i < s->huff_ncode; i++) {
+        const MJpegHuffmanCode *c = &m->huff_buffer[i];
+        int table_id = c->table_id;
+        int code     = c->code;
+        int nbits    = code & 0xf;
+
+        if (table_id == 4) {
+            // What ff_mjpeg_encode_stuffing() would have done in place.
+            s->i_tex_bits += get_bits_diff(s);
+            ff_mjpeg_escape_FF(&s->pb, s->esc_pos);
+            if (code)
+                put_marker(&s->pb, code);
+            s->esc_pos = put_bytes_count(&s->pb, 0);
+            if (s->avctx->flags & AV_CODEC_FLAG_PASS1)
+                s->misc_bits += get_bits_diff(s);
+            continue;
+        }
+
+        put_bits(&s->pb, huff_size[table_id][code], huff_code[table_id][code]);
+        if (nbits != 0)
+            put_sbits(&s->pb, nbits, c->mant);
+    }
+    flush_put_bits(&s->pb);
+
+    return 0;
+}
+
+/**
+ * Writes the JPEG frame when optimal huffman tables are used with slice
+ * contexts, once all of them have buffered their codes.
+ *
+ * The code statistics are gathered by each slice in parallel and merged
+ * into the tables, which are then used by each slice to write its
+ * bitstream in parallel again.
+ *
+ * @param s The main MpegEncContext.
+ * @return int Error code, 0 if successful.
+ */
+int ff_mjpeg_encode_slices(MpegEncContext *s)
+{
+    MJpegContext *const m = s->mjpeg_ctx;
+    int nb_slices = s->slice_context_count;
+    int ret[MAX_THREADS];
+
+    if (m->huffman != HUFFMAN_TABLE_OPTIMAL || nb_slices < 2)
+        return 0;
+
+    if (!m->huff_stats) {
+        m->huff_stats = av_calloc(4 * nb_slices, sizeof(*m->huff_stats));
+        if (!m->huff_stats)
+            return AVERROR(ENOMEM);
+    }
+
+    s->avctx->execute2(s->avctx, mjpeg_count_slice, NULL, NULL, nb_slices);
+    for (int i = 4; i < 4 * nb_slices; i++)
+        for (int j = 0; j < 256; j++)
+            m->huff_stats[i & 3].val_count[j] += m->huff_stats[i].val_count[j];
+    mjpeg_build_optimal_huffman(m, m->huff_stats);
+
+    s->intra_ac_vlc_length      =
+    s->intra_ac_vlc_last_length = m->uni_ac_vlc_len;
+    s->intra_chroma_ac_vlc_length      =
+    s->intra_chroma_ac_vlc_last_length = m->uni_chroma_ac_vlc_len;
+
+    mjpeg_encode_picture_header(s);
+    s->header_bits = get_bits_diff(s);
+
+    s->avctx->execute2(s->avctx, mjpeg_encode_slice, NULL, ret, nb_slices);
+    for (int i = 0; i < nb_slices; i++)
+        if (ret[i] < 0)
+            return ret[i];
+
+    return 0;
 }
 #endif
 
@@ -226,13 +357,21 @@ int ff_mjpeg_encode_stuffing(MpegEncContext *s)
 
 #if CONFIG_MJPEG_ENCODER
     if (m->huffman == HUFFMAN_TABLE_OPTIMAL) {
+        MJpegEncHuffmanContext ctx[4];
+
+        if (s->slice_context_count > 1) {
+            /* The tables depend on all slices, so only mark where this
+             * restart interval ends, see ff_mjpeg_encode_slices(). */
+            MJpegHuffmanCode *c = &m->huff_buffer[s->huff_ncode++];
+            c->table_id = 4;
+            c->code     = mb_y < s->mb_height - 1 ? RST0 + (mb_y & 7) : 0;
+            ret = 0;
+            goto fail;
+        }
 
-        mjpeg_build_optimal_huffman(m);
+        mjpeg_count_codes(ctx, m->huff_buffer, s->huff_ncode);
+        mjpeg_build_optimal_huffman(m, ctx);
 
-        // Replace the VLCs with the optimal ones.
-        // The default ones may be used for trellis during quantization.
-        init_uni_ac_vlc(m->huff_size_ac_luminance,   m->uni_ac_vlc_len);
-        init_uni_ac_vlc(m->huff_size_ac_chrominance, m->uni_chroma_ac_vlc_len);
         s->intra_ac_vlc_length      =
         s->intra_ac_vlc_last_length = m->uni_ac_vlc_len;
         s->intra_chroma_ac_vlc_length      =
@@ -281,9 +420,11 @@ static int alloc_huffman(MpegEncContext *s)
     };
 
     // Make sure we have enough space to hold this frame.
-    num_mbs = s->mb_width * s->mb_height;
+    // Each row may also end a restart interval when slices are used.
+    num_mbs = s->mb_width;
     num_blocks = num_mbs * blocks_per_mb;
-    num_codes = num_blocks * 64;
+    m->huff_row_size = num_blocks * 64 + 1;
+    num_codes = m->huff_row_size * s->mb_height;
 
     m->huff_buffer = av_malloc_array(num_codes, sizeof(MJpegHuffmanCode));
     if (!m->huff_buffer)
@@ -301,7 +442,9 @@ av_cold int ff_mjpeg_encode_init(MpegEncContext *s)
                  (s->avctx->active_thread_type & FF_THREAD_SLICE) &&
                  s->avctx->thread_count > 1;
 
-    if (s->codec_id == AV_CODEC_ID_AMV || use_slices)
+    // Simulating errors drops slices that have already been written, which
+    // the optimal tables only do once the whole frame has been coded.
+    if (s->codec_id == AV_CODEC_ID_AMV || (use_slices && s->error_rate))
         m->huffman = HUFFMAN_TABLE_DEFAULT;
 
     if (s->mpv_flags & FF_MPV_FLAG_QP_RD) {
@@ -352,9 +495,6 @@ av_cold int ff_mjpeg_encode_init(MpegEncContext *s)
     s->intra_chroma_ac_vlc_length      =
     s->intra_chroma_ac_vlc_last_length = m->uni_chroma_ac_vlc_len;
 
-    // Buffers start out empty.
-    m->huff_ncode = 0;
-
     if (m->huffman == HUFFMAN_TABLE_OPTIMAL)
         return alloc_huffman(s);
 
@@ -365,6 +505,7 @@ static av_cold int mjpeg_encode_close(AVCodecContext *avctx)
 {
     MJPEGEncContext *const mjpeg = avctx->priv_data;
     av_freep(&mjpeg->mjpeg.huff_buffer);
+    av_freep(&mjpeg->mjpeg.huff_stats);
     ff_mpv_encode_end(avctx);
     return 0;
 }
@@ -372,13 +513,13 @@ static av_cold int mjpeg_encode_close(AVCodecContext *avctx)
 /**
  * Add code and table_id to the JPEG buffer.
  *
- * @param s The MJpegContext which contains the JPEG buffer.
+ * @param s The MpegEncContext of the slice the code belongs to.
  * @param table_id Which Huffman table the code belongs to.
  * @param code The encoded exponent of the coefficients and the run-bits.
  */
-static inline void ff_mjpeg_encode_code(MJpegContext *s, uint8_t table_id, int code)
+static inline void ff_mjpeg_encode_code(MpegEncContext *s, uint8_t table_id, int code)
 {
-    MJpegHuffmanCode *c = &s->huff_buffer[s->huff_ncode++];
+    MJpegHuffmanCode *c = &s->mjpeg_ctx->huff_buffer[s->huff_ncode++];
     c->table_id = table_id;
     c->code = code;
 }
@@ -386,12 +527,12 @@ static inline void ff_mjpeg_encode_code(MJpegContext *s, uint8_t table_id, int c
 /**
  * Add the coefficient's data to the JPEG buffer.
  *
- * @param s The MJpegContext which contains the JPEG buffer.
+ * @param s The MpegEncContext of the slice the coefficient belongs to.
  * @param table_id Which Huffman table the code belongs to.
  * @param val The coefficient.
  * @param run The run-bits.
  */
-static void ff_mjpeg_encode_coef(MJpegContext *s, uint8_t table_id, int val, int run)
+static void ff_mjpeg_encode_coef(MpegEncContext *s, uint8_t table_id, int val, int run)
 {
     int mant, code;
 
@@ -407,7 +548,7 @@ static void ff_mjpeg_encode_coef(MJpegContext *s, uint8_t table_id, int val, int
 
         code = (run << 4) | (av_log2_16bit(val) + 1);
 
-        s->huff_buffer[s->huff_ncode].mant = mant;
+        s->mjpeg_ctx->huff_buffer[s->huff_ncode].mant = mant;
         ff_mjpeg_encode_code(s, table_id, code);
     }
 }
@@ -423,7 +564,6 @@ static void record_block(MpegEncContext *s, int16_t *block, int n)
 {
     int i, j, table_id;
     int component, dc, last_index, val, run;
-    MJpegContext *m = s->mjpeg_ctx;
 
     /* DC coef */
     component = (n <= 3 ? 0 : (n&1) + 1);
@@ -431,7 +571,7 @@ static void record_block(MpegEncContext *s, int16_t *block, int n)
     dc = block[0]; /* overflow is impossible */
     val = dc - s->last_dc[component];
 
-    ff_mjpeg_encode_coef(m, table_id, val, 0);
+    ff_mjpeg_encode_coef(s, table_id, val, 0);
 
     s->last_dc[component] = dc;
 
@@ -449,17 +589,17 @@ static void record_block(MpegEncContext *s, int16_t *block, int n)
             run++;
         } else {
             while (run >= 16) {
-                ff_mjpeg_encode_code(m, table_id, 0xf0);
+                ff_mjpeg_encode_code(s, table_id, 0xf0);
                 run -= 16;
             }
-            ff_mjpeg_encode_coef(m, table_id, val, run);
+            ff_mjpeg_encode_coef(s, table_id, val, run);
             run = 0;
         }
     }
 
     /* output EOB only if not already 64 values */
     if (last_index < 63 || run != 0)
-        ff_mjpeg_encode_code(m, table_id, 0);
+        ff_mjpeg_encode_code(s, table_id, 0);
 }
 
 static void encode_block(MpegEncContext *s, int16_t *block, int n)
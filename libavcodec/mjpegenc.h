@@ -44,12 +44,13 @@
  *
  * Optimal Huffman table generation requires the frame data to be loaded into
  * a buffer so that the tables can be computed.
- * There are at most mb_width*mb_height*12*64 of these per frame.
+ * There are at most mb_width*mb_height*12*64 of these per frame, plus one
+ * marking the end of each MB row when slices are used.
  */
 typedef struct MJpegHuffmanCode {
-    // 0=DC lum, 1=DC chrom, 2=AC lum, 3=AC chrom
+    // 0=DC lum, 1=DC chrom, 2=AC lum, 3=AC chrom, 4=end of restart interval
     uint8_t table_id; ///< The Huffman table id associated with the data.
-    uint8_t code;     ///< The exponent.
+    uint8_t code;     ///< The exponent, or the RST marker to write (0 for none).
     uint16_t mant;    ///< The mantissa.
 } MJpegHuffmanCode;
 
@@ -88,8 +89,10 @@ typedef struct MJpegContext {
     uint8_t bits_ac_chrominance[17]; ///< AC chrominance Huffman bits.
     uint8_t val_ac_chrominance[256]; ///< AC chrominance Huffman values.
 
-    size_t huff_ncode;               ///< Number of current entries in the buffer.
     MJpegHuffmanCode *huff_buffer;   ///< Buffer for Huffman code values.
+    size_t huff_row_size;            ///< Entries of the buffer reserved for each MB row.
+    /** Code statistics of the 4 tables, for each slice context */
+    struct MJpegEncHuffmanContext *huff_stats;
 } MJpegContext;
 
 /**
@@ -111,5 +114,6 @@ int  ff_mjpeg_encode_init(MpegEncContext *s);
 void ff_mjpeg_amv_encode_picture_header(MpegEncContext *s);
 void ff_mjpeg_encode_mb(MpegEncContext *s, int16_t block[12][64]);
 int  ff_mjpeg_encode_stuffing(MpegEncContext *s);
+int  ff_mjpeg_encode_slices(MpegEncContext *s);
 
 #endif /* AVCODEC_MJPEGENC_H */
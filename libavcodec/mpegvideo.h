@@ -406,6 +406,7 @@ typedef struct MpegEncContext {
     /* MJPEG specific */
     struct MJpegContext *mjpeg_ctx;
     int esc_pos;
+    size_t huff_ncode;  ///< end of the codes buffered by this slice for optimal Huffman tables
 
     /* MSMPEG4 specific */
     int mv_table_index;
@@ -62,6 +62,15 @@ typedef struct PNGEncContext {
 
     FFZStream zstream;
     uint8_t buf[IOBUF_SIZE];
+    int compression_level;
+
+    // slice threading
+    uint8_t *filtered;           ///< filtered rows of the whole image
+    unsigned int filtered_size;
+    uint8_t *crow_bufs;          ///< row filtering scratch of each thread
+    unsigned int crow_bufs_size;
+    uint8_t *zbuf;
+    unsigned int zbuf_size;
     int dpi;                     ///< Physical pixel density, in dots per inch, if set
     int dpm;                     ///< Physical pixel density, in dots per meter, if set
 
@@ -296,6 +305,62 @@ static int png_write_row(AVCodecContext *avctx, const uint8_t *data, int size)
     return 0;
 }
 
+static int png_filter_rows(AVCodecContext *avctx, void *arg,
+                           int jobnr, int threadnr)
+{
+    PNGEncContext *s       = avctx->priv_data;
+    const AVFrame *const p = arg;
+    const int row_size     = (p->width * s->bits_per_pixel + 7) >> 3;
+    const int crow_size    = FFALIGN((row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED), 64);
+    const int y_start      = p->height *  jobnr      / avctx->thread_count;
+    const int y_end        = p->height * (jobnr + 1) / avctx->thread_count;
+    // pixel data should be aligned, but there's a control byte before it
+    uint8_t *crow_buf = s->crow_bufs + threadnr * crow_size + 15;
+
+    for (int y = y_start; y < y_end; y++) {
+        const uint8_t *ptr = p->data[0] + y * p->linesize[0];
+        const uint8_t *top = y ? ptr - p->linesize[0] : NULL;
+        const uint8_t *crow;
+
+        crow = png_choose_filter(s, crow_buf, ptr, top,
+                                 row_size, s->bits_per_pixel >> 3);
+        memcpy(s->filtered + (size_t)y * (row_size + 1), crow, row_size + 1);
+    }
+    return 0;
+}
+
+/**
+ * Filter the rows and compress them in the slice threads, using one zlib
+ * stream made of independently deflated parts.
+ */
+static int encode_frame_threaded(AVCodecContext *avctx, const AVFrame *pict)
+{
+    PNGEncContext *s    = avctx->priv_data;
+    const int row_size  = (pict->width * s->bits_per_pixel + 7) >> 3;
+    const int crow_size = FFALIGN((row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED), 64);
+    const size_t size   = (size_t)pict->height * (row_size + 1);
+    int len;
+
+    av_fast_malloc(&s->filtered, &s->filtered_size, size);
+    av_fast_malloc(&s->crow_bufs, &s->crow_bufs_size,
+                   (size_t)crow_size * avctx->thread_count);
+    if (!s->filtered || !s->crow_bufs)
+        return AVERROR(ENOMEM);
+
+    avctx->execute2(avctx, png_filter_rows, (void *)pict, NULL,
+                    avctx->thread_count);
+
+    len = ff_deflate_threaded(avctx, &s->zbuf, &s->zbuf_size,
+                              s->filtered, size, s->compression_level);
+    if (len < 0)
+        return len;
+    if (s->bytestream_end - s->bytestream <= len + 100)
+        return AVERROR_BUFFER_TOO_SMALL;
+
+    png_write_image_data(avctx, s->zbuf, len);
+    return 0;
+}
+
 #define PNG_LRINT(d, divisor) lrint((d) * (divisor))
 #define PNG_Q2D(q, divisor) PNG_LRINT(av_q2d(q), (divisor))
 #define AV_WB32_PNG_D(buf, q) AV_WB32(buf, PNG_Q2D(q, 100000))
@@ -518,6 +583,10 @@ static int encode_frame(AVCodecContext *avctx, const AVFrame *pict)
     uint8_t *progressive_buf = NULL;
     uint8_t *top_buf         = NULL;
 
+    if (!s->is_progressive && avctx->active_thread_type & FF_THREAD_SLICE &&
+        avctx->thread_count > 1)
+        return encode_frame_threaded(avctx, pict);
+
     row_size = (pict->width * s->bits_per_pixel + 7) >> 3;
 
     crow_base = av_malloc((row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED));
@@ -1103,7 +1172,6 @@ static int encode_apng(AVCodecContext *avctx, AVPacket *pkt,
 static av_cold int png_enc_init(AVCodecContext *avctx)
 {
     PNGEncContext *s = avctx->priv_data;
-    int compression_level;
 
     switch (avctx->pix_fmt) {
     case AV_PIX_FMT_RGBA:
@@ -1181,10 +1249,10 @@ static av_cold int png_enc_init(AVCodecContext *avctx)
     }
     s->bits_per_pixel = ff_png_get_nb_channels(s->color_type) * s->bit_depth;
 
-    compression_level = avctx->compression_level == FF_COMPRESSION_DEFAULT
-                      ? Z_DEFAULT_COMPRESSION
-                      : av_clip(avctx->compression_level, 0, 9);
-    return ff_deflate_init(&s->zstream, compression_level, avctx);
+    s->compression_level = avctx->compression_level == FF_COMPRESSION_DEFAULT
+                         ? Z_DEFAULT_COMPRESSION
+                         : av_clip(avctx->compression_level, 0, 9);
+    return ff_deflate_init(&s->zstream, s->compression_level, avctx);
 }
 
 static av_cold int png_enc_close(AVCodecContext *avctx)
@@ -1192,6 +1260,9 @@ static av_cold int png_enc_close(AVCodecContext *avctx)
     PNGEncContext *s = avctx->priv_data;
 
     ff_deflate_end(&s->zstream);
+    av_freep(&s->filtered);
+    av_freep(&s->crow_bufs);
+    av_freep(&s->zbuf);
     av_frame_free(&s->last_frame);
     av_frame_free(&s->prev_frame);
     av_freep(&s->last_frame_packet);
@@ -1228,6 +1299,7 @@ const FFCodec ff_png_encoder = {
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_PNG,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .priv_data_size = sizeof(PNGEncContext),
     .init           = png_enc_init,
@@ -1251,6 +1323,7 @@ const FFCodec ff_apng_encoder = {
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_APNG,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .priv_data_size = sizeof(PNGEncContext),
     .init           = png_enc_init,
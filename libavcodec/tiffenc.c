@@ -43,6 +43,9 @@
 #include "tiff.h"
 #include "tiff_common.h"
 #include "version.h"
+#if CONFIG_DEFLATE_WRAPPER
+#include "zlib_wrapper.h"
+#endif
 
 #define TIFF_MAX_ENTRY 32
 
@@ -76,6 +79,8 @@ typedef struct TiffEncoderContext {
     int buf_size;                           ///< buffer size
     uint16_t subsampling[2];                ///< YUV subsampling factors
     struct LZWEncodeState *lzws;            ///< LZW encode state
+    uint8_t *zbuf;                          ///< deflate output of the slice threads
+    unsigned int zbuf_size;
     uint32_t dpi;                           ///< image resolution in DPI
 } TiffEncoderContext;
 
@@ -178,6 +183,21 @@ static int encode_strip(TiffEncoderContext *s, const int8_t *src,
     case TIFF_ADOBE_DEFLATE:
     {
         unsigned long zlen = s->buf_size - (*s->buf - s->buf_start);
+#if CONFIG_DEFLATE_WRAPPER
+        if (s->avctx->active_thread_type & FF_THREAD_SLICE &&
+            s->avctx->thread_count > 1) {
+            int ret = ff_deflate_threaded(s->avctx, &s->zbuf, &s->zbuf_size,
+                                          src, n, Z_DEFAULT_COMPRESSION);
+            if (ret < 0) {
+                av_log(s->avctx, AV_LOG_ERROR, "Compressing failed\n");
+                return ret;
+            }
+            if (check_size(s, ret))
+                return AVERROR(EINVAL);
+            memcpy(dst, s->zbuf, ret);
+            return ret;
+        }
+#endif
         if (compress(dst, &zlen, src, n) != Z_OK) {
             av_log(s->avctx, AV_LOG_ERROR, "Compressing failed\n");
             return AVERROR_EXTERNAL;
@@ -546,6 +566,7 @@ static av_cold int encode_close(AVCodecContext *avctx)
     av_freep(&s->strip_sizes);
     av_freep(&s->strip_offsets);
     av_freep(&s->yuv_line);
+    av_freep(&s->zbuf);
 
     return 0;
 }
@@ -575,6 +596,7 @@ const FFCodec ff_tiff_encoder = {
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_TIFF,
     .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS |
                       AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE,
     .priv_data_size = sizeof(TiffEncoderContext),
     .init           = encode_init,
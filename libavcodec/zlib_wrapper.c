@@ -22,9 +22,12 @@
 #include <zlib.h>
 
 #include "config.h"
+#include "libavutil/common.h"
 #include "libavutil/error.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/log.h"
 #include "libavutil/mem.h"
+#include "avcodec.h"
 #include "zlib_wrapper.h"
 
 static void *alloc_wrapper(void *opaque, uInt items, uInt size)
@@ -99,4 +102,135 @@ void ff_deflate_end(FFZStream *z)
         deflateEnd(&z->zstream);
     }
 }
+
+#define DEFLATE_PART_MIN  (128 * 1024)
+#define DEFLATE_PART_MAX  (1 << 30)
+#define DEFLATE_DICT_SIZE (1 << MAX_WBITS)
+
+typedef struct DeflatePart {
+    const uint8_t *src;
+    size_t size;
+    size_t dict_size;           ///< bytes preceding src to prime the window with
+    uint8_t *dst;
+    size_t dst_size;            ///< space available in dst, then bytes written
+    uLong adler;
+    int level;
+    int last;
+    int ret;
+} DeflatePart;
+
+static int deflate_part(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    DeflatePart *const part = (DeflatePart *)arg + jobnr;
+    z_stream zstream = {
+        .zalloc = alloc_wrapper,
+        .zfree  = free_wrapper,
+        .opaque = Z_NULL,
+    };
+    int zret;
+
+    part->adler = adler32(adler32(0, Z_NULL, 0), part->src, part->size);
+
+    zret = deflateInit2(&zstream, part->level, Z_DEFLATED, -MAX_WBITS,
+                        8, Z_DEFAULT_STRATEGY);
+    if (zret != Z_OK)
+        return part->ret = AVERROR_EXTERNAL;
+    if (part->dict_size)
+        deflateSetDictionary(&zstream, part->src - part->dict_size,
+                             part->dict_size);
+
+    zstream.next_in   = part->src;
+    zstream.avail_in  = part->size;
+    zstream.next_out  = part->dst;
+    zstream.avail_out = part->dst_size;
+    zret = deflate(&zstream, part->last ? Z_FINISH : Z_SYNC_FLUSH);
+    part->dst_size -= zstream.avail_out;
+    deflateEnd(&zstream);
+
+    /* A sync flush is only complete if there was output space left. */
+    if (part->last ? zret != Z_STREAM_END :
+                     zret != Z_OK || zstream.avail_in || !zstream.avail_out)
+        return part->ret = AVERROR_EXTERNAL;
+    return part->ret = 0;
+}
+
+int ff_deflate_threaded(AVCodecContext *avctx,
+                        uint8_t **dst, unsigned int *dst_size,
+                        const uint8_t *src, size_t size, int level)
+{
+    DeflatePart *parts;
+    uint8_t *out;
+    size_t pos = 0, offset = 2, len = 2;
+    uLong adler = 0;
+    int nb_parts, flags, ret = 0;
+
+    nb_parts = FFMIN(size / DEFLATE_PART_MIN, FFMAX(avctx->thread_count, 1));
+    nb_parts = FFMAX(nb_parts, size / DEFLATE_PART_MAX + 1);
+
+    parts = av_calloc(nb_parts, sizeof(*parts));
+    if (!parts)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < nb_parts; i++) {
+        DeflatePart *const part = &parts[i];
+        size_t end = size * (i + 1) / nb_parts;
+
+        part->src       = src + pos;
+        part->size      = end - pos;
+        part->dict_size = FFMIN(pos, DEFLATE_DICT_SIZE);
+        /* The bound covers the stream wrapper, which leaves room for the
+         * empty stored block of the sync flush. */
+        part->dst_size  = deflateBound(NULL, part->size) + 16;
+        part->level     = level;
+        part->last      = i == nb_parts - 1;
+        pos     = end;
+        offset += part->dst_size;
+    }
+    offset += 4;
+
+    if (offset > INT_MAX) {
+        ret = AVERROR(ERANGE);
+        goto end;
+    }
+    av_fast_malloc(dst, dst_size, offset);
+    if (!*dst) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    out = *dst;
+
+    offset = 2;
+    for (int i = 0; i < nb_parts; i++) {
+        parts[i].dst = out + offset;
+        offset += parts[i].dst_size;
+    }
+
+    avctx->execute2(avctx, deflate_part, parts, NULL, nb_parts);
+
+    /* Same header as deflateInit() writes, with the level hint. */
+    flags = level == Z_DEFAULT_COMPRESSION ? 2 :
+            level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    flags <<= 6;
+    flags  += 31 - (0x7800 + flags) % 31;
+    out[0]  = 0x78;
+    out[1]  = flags;
+
+    for (int i = 0; i < nb_parts; i++) {
+        const DeflatePart *const part = &parts[i];
+
+        if (part->ret < 0) {
+            ret = part->ret;
+            goto end;
+        }
+        memmove(out + len, part->dst, part->dst_size);
+        len  += part->dst_size;
+        adler = i ? adler32_combine(adler, part->adler, part->size) : part->adler;
+    }
+    AV_WB32(out + len, adler);
+    ret = len + 4;
+
+end:
+    av_free(parts);
+    return ret;
+}
 #endif
@@ -22,6 +22,8 @@
 #ifndef AVCODEC_ZLIB_WRAPPER_H
 #define AVCODEC_ZLIB_WRAPPER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <zlib.h>
 
 typedef struct FFZStream {
@@ -58,4 +60,21 @@ int ff_deflate_init(FFZStream *zstream, int level, void *logctx);
  */
 void ff_deflate_end(FFZStream *zstream);
 
+struct AVCodecContext;
+
+/**
+ * Compress a buffer into a single zlib stream using the slice threads of
+ * avctx. The input is cut into parts that are deflated independently, each
+ * one primed with the 32 KiB of input preceding it and terminated by a sync
+ * flush, so that their concatenation is a valid stream again.
+ *
+ * @param dst      buffer for the stream, (re)allocated as with av_fast_malloc()
+ * @param dst_size allocated size of *dst
+ * @param level    zlib compression level
+ * @return the size of the stream on success, a negative error code on failure
+ */
+int ff_deflate_threaded(struct AVCodecContext *avctx,
+                        uint8_t **dst, unsigned int *dst_size,
+                        const uint8_t *src, size_t size, int level);
+
 #endif /* AVCODEC_ZLIB_WRAPPER_H */
@@ -27,6 +27,7 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/cpu.h"
+#include "libavutil/crc.h"
 #include "libavutil/mem.h"
 #include "libavutil/tx.h"
 #include "libavutil/avstring.h"
@@ -36,11 +37,13 @@
 #include "libavutil/log.h"
 #include "libavutil/opt.h"
 #include "libavutil/rational.h"
+#include "libavutil/thread.h"
 
 #include "audio.h"
 #include "avfilter.h"
 #include "filters.h"
 #include "formats.h"
+#include "af_afir.h"
 #include "af_afirdsp.h"
 
 #define MAX_IR_STREAMS 32
@@ -67,10 +70,34 @@ typedef struct AudioFIRSegment {
     AVFrame *input;
     AVFrame *output;
 
-    AVTXContext **ctx, **tx, **itx;
+    AVTXContext *ctx, **tx, **itx;
     av_tx_fn ctx_fn, tx_fn, itx_fn;
 } AudioFIRSegment;
 
+/**
+ * IR spectra shared between all filter instances using the same
+ * normalized IR with the same partitioning.
+ */
+typedef struct AudioFIRCache {
+    struct AudioFIRCache *next;
+    unsigned refcount;
+
+    uint32_t crc;
+    int format;
+    int nb_channels;
+    int nb_taps;
+    int min_part_size;
+    int max_part_size;
+    int growth;
+    AVFrame *ir;
+
+    int nb_segments;
+    AVFrame **coeff;
+} AudioFIRCache;
+
+static AVMutex cache_mutex = AV_MUTEX_INITIALIZER;
+static AudioFIRCache *cache_list;
+
 typedef struct AudioFIRContext {
     const AVClass *class;
 
@@ -90,6 +117,7 @@ typedef struct AudioFIRContext {
     int ir_channel;
     int minp;
     int maxp;
+    int growth;
     int nb_irs;
     int prev_selir;
     int selir;
@@ -102,12 +130,14 @@ typedef struct AudioFIRContext {
     int nb_segments[MAX_IR_STREAMS];
     int max_offset[MAX_IR_STREAMS];
     int nb_channels;
+    int nb_jobs;
     int one2many;
     int prev_is_disabled;
     int *loading;
     double *ch_gain;
 
     AudioFIRSegment seg[MAX_IR_STREAMS][1024];
+    AudioFIRCache *cache[MAX_IR_STREAMS];
 
     AVFrame *in;
     AVFrame *xfade[2];
@@ -129,7 +159,7 @@ typedef struct AudioFIRContext {
 #define DEPTH 64
 #include "afir_template.c"
 
-static int fir_channel(AVFilterContext *ctx, AVFrame *out, int ch)
+static int fir_channel(AVFilterContext *ctx, AVFrame *out, int ch, int jobnr)
 {
     AudioFIRContext *s = ctx->priv;
     const int min_part_size = s->min_part_size;
@@ -139,10 +169,10 @@ static int fir_channel(AVFilterContext *ctx, AVFrame *out, int ch)
     for (int offset = 0; offset < out->nb_samples; offset += min_part_size) {
         switch (s->format) {
         case AV_SAMPLE_FMT_FLTP:
-            fir_quantums_float(ctx, s, out, min_part_size, ch, offset, prev_selir, selir);
+            fir_quantums_float(ctx, s, out, min_part_size, ch, jobnr, offset, prev_selir, selir);
             break;
         case AV_SAMPLE_FMT_DBLP:
-            fir_quantums_double(ctx, s, out, min_part_size, ch, offset, prev_selir, selir);
+            fir_quantums_double(ctx, s, out, min_part_size, ch, jobnr, offset, prev_selir, selir);
             break;
         }
 
@@ -160,7 +190,7 @@ static int fir_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
     const int end = (out->ch_layout.nb_channels * (jobnr+1)) / nb_jobs;
 
     for (int ch = start; ch < end; ch++)
-        fir_channel(ctx, out, ch);
+        fir_channel(ctx, out, ch, jobnr);
 
     return 0;
 }
@@ -179,8 +209,7 @@ static int fir_frame(AudioFIRContext *s, AVFrame *in, AVFilterLink *outlink)
     out->pts = s->pts = in->pts;
 
     s->in = in;
-    ff_filter_execute(ctx, fir_channels, out, NULL,
-                      FFMIN(outlink->ch_layout.nb_channels, ff_filter_get_nb_threads(ctx)));
+    ff_filter_execute(ctx, fir_channels, out, NULL, s->nb_jobs);
     s->prev_is_disabled = ctx->is_disabled;
 
     av_frame_free(&in);
@@ -194,14 +223,14 @@ static int init_segment(AVFilterContext *ctx, AudioFIRSegment *seg, int selir,
 {
     AudioFIRContext *s = ctx->priv;
     const size_t cpu_align = av_cpu_max_align();
-    union { double d; float f; } cscale, scale, iscale;
+    union { double d; float f; } scale, iscale;
     enum AVTXType tx_type;
     int ret;
 
-    seg->tx  = av_calloc(ctx->inputs[0]->ch_layout.nb_channels, sizeof(*seg->tx));
-    seg->ctx = av_calloc(ctx->inputs[0]->ch_layout.nb_channels, sizeof(*seg->ctx));
-    seg->itx = av_calloc(ctx->inputs[0]->ch_layout.nb_channels, sizeof(*seg->itx));
-    if (!seg->tx || !seg->ctx || !seg->itx)
+    /* transforms keep internal scratch buffers, so each job needs its own */
+    seg->tx  = av_calloc(s->nb_jobs, sizeof(*seg->tx));
+    seg->itx = av_calloc(s->nb_jobs, sizeof(*seg->itx));
+    if (!seg->tx || !seg->itx)
         return AVERROR(ENOMEM);
 
     seg->fft_length    = (part_size + 1) * 2;
@@ -219,13 +248,11 @@ static int init_segment(AVFilterContext *ctx, AudioFIRSegment *seg, int selir,
 
     switch (s->format) {
     case AV_SAMPLE_FMT_FLTP:
-        cscale.f = 1.f;
         scale.f  = 1.f / sqrtf(2.f * part_size);
         iscale.f = 1.f / sqrtf(2.f * part_size);
         tx_type  = AV_TX_FLOAT_RDFT;
         break;
     case AV_SAMPLE_FMT_DBLP:
-        cscale.d = 1.0;
         scale.d  = 1.0 / sqrt(2.0 * part_size);
         iscale.d = 1.0 / sqrt(2.0 * part_size);
         tx_type  = AV_TX_DOUBLE_RDFT;
@@ -234,17 +261,12 @@ static int init_segment(AVFilterContext *ctx, AudioFIRSegment *seg, int selir,
         av_assert1(0);
     }
 
-    for (int ch = 0; ch < ctx->inputs[0]->ch_layout.nb_channels && part_size >= 1; ch++) {
-        ret = av_tx_init(&seg->ctx[ch], &seg->ctx_fn, tx_type,
-                         0, 2 * part_size, &cscale,  0);
-        if (ret < 0)
-            return ret;
-
-        ret = av_tx_init(&seg->tx[ch],  &seg->tx_fn,  tx_type,
+    for (int j = 0; j < s->nb_jobs; j++) {
+        ret = av_tx_init(&seg->tx[j],  &seg->tx_fn,  tx_type,
                          0, 2 * part_size, &scale,  0);
         if (ret < 0)
             return ret;
-        ret = av_tx_init(&seg->itx[ch], &seg->itx_fn, tx_type,
+        ret = av_tx_init(&seg->itx[j], &seg->itx_fn, tx_type,
                          1, 2 * part_size, &iscale, 0);
         if (ret < 0)
             return ret;
@@ -269,21 +291,17 @@ static void uninit_segment(AVFilterContext *ctx, AudioFIRSegment *seg)
 {
     AudioFIRContext *s = ctx->priv;
 
-    if (seg->ctx) {
-        for (int ch = 0; ch < s->nb_channels; ch++)
-            av_tx_uninit(&seg->ctx[ch]);
-    }
-    av_freep(&seg->ctx);
+    av_tx_uninit(&seg->ctx);
 
     if (seg->tx) {
-        for (int ch = 0; ch < s->nb_channels; ch++)
-            av_tx_uninit(&seg->tx[ch]);
+        for (int j = 0; j < s->nb_jobs; j++)
+            av_tx_uninit(&seg->tx[j]);
     }
     av_freep(&seg->tx);
 
     if (seg->itx) {
-        for (int ch = 0; ch < s->nb_channels; ch++)
-            av_tx_uninit(&seg->itx[ch]);
+        for (int j = 0; j < s->nb_jobs; j++)
+            av_tx_uninit(&seg->itx[j]);
     }
     av_freep(&seg->itx);
 
@@ -298,16 +316,187 @@ static void uninit_segment(AVFilterContext *ctx, AudioFIRSegment *seg)
     av_frame_free(&seg->buffer);
     av_frame_free(&seg->input);
     av_frame_free(&seg->output);
+    av_frame_free(&seg->coeff);
     seg->input_size = 0;
+}
+
+static uint32_t ir_crc(const AudioFIRContext *s, const AVFrame *ir, int nb_taps)
+{
+    const AVCRC *table = av_crc_get_table(AV_CRC_32_IEEE_LE);
+    const size_t size = nb_taps * av_get_bytes_per_sample(s->format);
+    uint32_t crc = UINT32_MAX;
+
+    for (int ch = 0; ch < s->nb_channels; ch++)
+        crc = av_crc(table, crc, ir->extended_data[ch], size);
+
+    return crc;
+}
+
+/* must be called with cache_mutex held */
+static AudioFIRCache *cache_find(const AudioFIRContext *s, const AVFrame *ir,
+                                 int nb_taps, uint32_t crc)
+{
+    const size_t size = nb_taps * av_get_bytes_per_sample(s->format);
+
+    for (AudioFIRCache *c = cache_list; c; c = c->next) {
+        int ch;
+
+        if (c->crc != crc || c->format != s->format ||
+            c->nb_channels != s->nb_channels || c->nb_taps != nb_taps ||
+            c->min_part_size != 1 << av_log2(s->minp) ||
+            c->max_part_size != 1 << av_log2(s->maxp) ||
+            c->growth != s->growth)
+            continue;
+
+        for (ch = 0; ch < s->nb_channels; ch++) {
+            if (memcmp(c->ir->extended_data[ch], ir->extended_data[ch], size))
+                break;
+        }
+        if (ch == s->nb_channels)
+            return c;
+    }
+
+    return NULL;
+}
+
+static int cache_add(AudioFIRContext *s, int selir, int nb_taps, uint32_t crc)
+{
+    const int nb_segments = s->nb_segments[selir];
+    AudioFIRCache *c;
+
+    c = av_mallocz(sizeof(*c));
+    if (!c)
+        return AVERROR(ENOMEM);
+
+    c->refcount      = 1;
+    c->crc           = crc;
+    c->format        = s->format;
+    c->nb_channels   = s->nb_channels;
+    c->nb_taps       = nb_taps;
+    c->min_part_size = 1 << av_log2(s->minp);
+    c->max_part_size = 1 << av_log2(s->maxp);
+    c->growth        = s->growth;
+    c->nb_segments   = nb_segments;
+
+    c->ir    = av_frame_clone(s->norm_ir[selir]);
+    c->coeff = av_calloc(nb_segments, sizeof(*c->coeff));
+    if (!c->ir || !c->coeff)
+        goto fail;
+
+    for (int n = 0; n < nb_segments; n++) {
+        c->coeff[n] = av_frame_clone(s->seg[selir][n].coeff);
+        if (!c->coeff[n])
+            goto fail;
+    }
+
+    ff_mutex_lock(&cache_mutex);
+    c->next    = cache_list;
+    cache_list = c;
+    ff_mutex_unlock(&cache_mutex);
+
+    s->cache[selir] = c;
+
+    return 0;
+fail:
+    if (c->coeff) {
+        for (int n = 0; n < nb_segments; n++)
+            av_frame_free(&c->coeff[n]);
+    }
+    av_freep(&c->coeff);
+    av_frame_free(&c->ir);
+    av_free(c);
+    return AVERROR(ENOMEM);
+}
+
+static void cache_unref(AudioFIRCache **pc)
+{
+    AudioFIRCache *c = *pc;
+    int last;
+
+    if (!c)
+        return;
+    *pc = NULL;
+
+    ff_mutex_lock(&cache_mutex);
+    last = !--c->refcount;
+    if (last) {
+        AudioFIRCache **prev = &cache_list;
+
+        while (*prev != c)
+            prev = &(*prev)->next;
+        *prev = c->next;
+    }
+    ff_mutex_unlock(&cache_mutex);
+
+    if (!last)
+        return;
+
+    for (int n = 0; n < c->nb_segments; n++)
+        av_frame_free(&c->coeff[n]);
+    av_freep(&c->coeff);
+    av_frame_free(&c->ir);
+    av_free(c);
+}
+
+static int compute_coeffs(AVFilterContext *ctx, int selir)
+{
+    AudioFIRContext *s = ctx->priv;
+    union { double d; float f; } cscale;
+    enum AVTXType tx_type;
+    int ret;
+
+    switch (s->format) {
+    case AV_SAMPLE_FMT_FLTP:
+        cscale.f = 1.f;
+        tx_type  = AV_TX_FLOAT_RDFT;
+        break;
+    case AV_SAMPLE_FMT_DBLP:
+        cscale.d = 1.0;
+        tx_type  = AV_TX_DOUBLE_RDFT;
+        break;
+    default:
+        av_assert1(0);
+    }
 
-    for (int i = 0; i < MAX_IR_STREAMS; i++)
-        av_frame_free(&seg->coeff);
+    for (int n = 0; n < s->nb_segments[selir]; n++) {
+        AudioFIRSegment *seg = &s->seg[selir][n];
+
+        if (!seg->coeff)
+            seg->coeff = ff_get_audio_buffer(ctx->inputs[0], seg->nb_partitions * seg->coeff_size * 2);
+        if (!seg->coeff)
+            return AVERROR(ENOMEM);
+
+        /* the IR of each segment is transformed only once */
+        ret = av_tx_init(&seg->ctx, &seg->ctx_fn, tx_type,
+                         0, 2 * seg->part_size, &cscale, 0);
+        if (ret < 0)
+            return ret;
+
+        for (int ch = 0; ch < s->nb_channels; ch++) {
+            for (int i = 0; i < seg->nb_partitions; i++) {
+                switch (s->format) {
+                case AV_SAMPLE_FMT_FLTP:
+                    convert_channel_float(ctx, s, ch, seg, i, selir);
+                    break;
+                case AV_SAMPLE_FMT_DBLP:
+                    convert_channel_double(ctx, s, ch, seg, i, selir);
+                    break;
+                }
+            }
+        }
+
+        av_tx_uninit(&seg->ctx);
+    }
+
+    return 0;
 }
 
 static int convert_coeffs(AVFilterContext *ctx, int selir)
 {
     AudioFIRContext *s = ctx->priv;
+    AudioFIRCache *cache;
     int ret, nb_taps, cur_nb_taps;
+    uint32_t crc;
 
     if (!s->nb_taps[selir]) {
         int part_size, max_part_size;
@@ -327,8 +516,11 @@ static int convert_coeffs(AVFilterContext *ctx, int selir)
         part_size = 1 << av_log2(s->minp);
         max_part_size = 1 << av_log2(s->maxp);
 
+        /* Every partition must start at least its own size into the IR for the
+         * convolution to stay free of latency, so each size but the first is
+         * used for growth - 1 partitions before switching to the next one. */
         for (int i = 0; left > 0; i++) {
-            int step = (part_size == max_part_size) ? INT_MAX : 1 + (i == 0);
+            int step = (part_size == max_part_size) ? INT_MAX : s->growth - (i > 0);
             int nb_partitions = FFMIN(step, (left + part_size - 1) / part_size);
 
             s->nb_segments[selir] = i + 1;
@@ -338,7 +530,7 @@ static int convert_coeffs(AVFilterContext *ctx, int selir)
             offset += nb_partitions * part_size;
             s->max_offset[selir] = offset;
             left -= nb_partitions * part_size;
-            part_size *= 2;
+            part_size *= s->growth;
             part_size = FFMIN(part_size, max_part_size);
         }
     }
@@ -392,18 +584,6 @@ skip:
                 time[i] = 0;
 
             ir_scale_float(ctx, s, nb_taps, ch, time, s->ch_gain[ch]);
-
-            for (int n = 0; n < s->nb_segments[selir]; n++) {
-                AudioFIRSegment *seg = &s->seg[selir][n];
-
-                if (!seg->coeff)
-                    seg->coeff = ff_get_audio_buffer(ctx->inputs[0], seg->nb_partitions * seg->coeff_size * 2);
-                if (!seg->coeff)
-                    return AVERROR(ENOMEM);
-
-                for (int i = 0; i < seg->nb_partitions; i++)
-                    convert_channel_float(ctx, s, ch, seg, i, selir);
-            }
         }
         break;
     case AV_SAMPLE_FMT_DBLP:
@@ -432,27 +612,62 @@ skip:
                 time[i] = 0;
 
             ir_scale_double(ctx, s, nb_taps, ch, time, s->ch_gain[ch]);
-
-            for (int n = 0; n < s->nb_segments[selir]; n++) {
-                AudioFIRSegment *seg = &s->seg[selir][n];
-
-                if (!seg->coeff)
-                    seg->coeff = ff_get_audio_buffer(ctx->inputs[0], seg->nb_partitions * seg->coeff_size * 2);
-                if (!seg->coeff)
-                    return AVERROR(ENOMEM);
-
-                for (int i = 0; i < seg->nb_partitions; i++)
-                    convert_channel_double(ctx, s, ch, seg, i, selir);
-            }
         }
         break;
     }
 
+    crc = ir_crc(s, s->norm_ir[selir], nb_taps);
+    ff_mutex_lock(&cache_mutex);
+    cache = cache_find(s, s->norm_ir[selir], nb_taps, crc);
+    if (cache)
+        cache->refcount++;
+    ff_mutex_unlock(&cache_mutex);
+
+    if (cache) {
+        av_log(ctx, AV_LOG_DEBUG, "reusing coefficients of identical IR\n");
+        s->cache[selir] = cache;
+        for (int n = 0; n < s->nb_segments[selir]; n++) {
+            AudioFIRSegment *seg = &s->seg[selir][n];
+
+            av_frame_free(&seg->coeff);
+            seg->coeff = av_frame_clone(cache->coeff[n]);
+            if (!seg->coeff)
+                return AVERROR(ENOMEM);
+        }
+    } else {
+        ret = compute_coeffs(ctx, selir);
+        if (ret < 0)
+            return ret;
+        ret = cache_add(s, selir, nb_taps, crc);
+        if (ret < 0)
+            return ret;
+    }
+
     s->have_coeffs[selir] = 1;
 
     return 0;
 }
 
+int ff_afir_coeffs_shared(const AVFilterContext *a, const AVFilterContext *b)
+{
+    const AudioFIRContext *sa = a->priv, *sb = b->priv;
+    const int selir = sa->selir;
+
+    if (sb->selir != selir || !sa->have_coeffs[selir] || !sb->have_coeffs[selir] ||
+        sa->nb_segments[selir] != sb->nb_segments[selir])
+        return 0;
+
+    for (int n = 0; n < sa->nb_segments[selir]; n++) {
+        const AVFrame *ca = sa->seg[selir][n].coeff;
+        const AVFrame *cb = sb->seg[selir][n].coeff;
+
+        if (!ca || !cb || ca->extended_data[0] != cb->extended_data[0])
+            return 0;
+    }
+
+    return 1;
+}
+
 static int check_ir(AVFilterLink *link, int selir)
 {
     AVFilterContext *ctx = link->dst;
@@ -591,6 +806,7 @@ static int config_output(AVFilterLink *outlink)
 
     s->format = outlink->format;
     s->nb_channels = outlink->ch_layout.nb_channels;
+    s->nb_jobs = FFMIN(s->nb_channels, ff_filter_get_nb_threads(ctx));
     s->ch_gain = av_calloc(ctx->inputs[0]->ch_layout.nb_channels, sizeof(*s->ch_gain));
     s->loading = av_calloc(ctx->inputs[0]->ch_layout.nb_channels, sizeof(*s->loading));
     if (!s->loading || !s->ch_gain)
@@ -646,6 +862,7 @@ static av_cold void uninit(AVFilterContext *ctx)
         for (int j = 0; j < s->nb_segments[i]; j++)
             uninit_segment(ctx, &s->seg[i][j]);
 
+        cache_unref(&s->cache[i]);
         av_frame_free(&s->ir[i]);
         av_frame_free(&s->norm_ir[i]);
     }
@@ -696,6 +913,10 @@ static av_cold int init(AVFilterContext *ctx)
 
     s->min_part_size = 1 << av_log2(s->minp);
     s->max_part_size = 1 << av_log2(s->maxp);
+    if (s->growth & (s->growth - 1)) {
+        av_log(ctx, AV_LOG_ERROR, "growth must be a power of 2: %d.\n", s->growth);
+        return AVERROR(EINVAL);
+    }
 
     return 0;
 }
@@ -755,6 +976,7 @@ static const AVOption afir_options[] = {
     { "rate",   "set video rate",    OFFSET(frame_rate), AV_OPT_TYPE_VIDEO_RATE, {.str = "25"}, 0, INT32_MAX, VF|AV_OPT_FLAG_DEPRECATED },
     { "minp",   "set min partition size", OFFSET(minp),  AV_OPT_TYPE_INT,   {.i64=8192}, 1, 65536, AF },
     { "maxp",   "set max partition size", OFFSET(maxp),  AV_OPT_TYPE_INT,   {.i64=8192}, 8, 65536, AF },
+    { "growth", "set partition size growth", OFFSET(growth), AV_OPT_TYPE_INT, {.i64=2},    2,    16, AF },
     { "nbirs",  "set number of input IRs",OFFSET(nb_irs),AV_OPT_TYPE_INT,   {.i64=1},    1,    32, AF },
     { "ir",     "select IR",              OFFSET(selir), AV_OPT_TYPE_INT,   {.i64=0},    0,    31, AFR },
     { "precision", "set processing precision",    OFFSET(precision), AV_OPT_TYPE_INT,   {.i64=0}, 0, 2, AF, .unit = "precision" },
@@ -0,0 +1,33 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_AF_AFIR_H
+#define AVFILTER_AF_AFIR_H
+
+#include "avfilter.h"
+
+/**
+ * Check whether two afir instances share the coefficients of their selected
+ * IR, which happens when the normalized IRs and the partitionings are
+ * identical.
+ *
+ * @return 1 if all the coefficient buffers are shared, 0 otherwise
+ */
+int ff_afir_coeffs_shared(const AVFilterContext *a, const AVFilterContext *b);
+
+#endif /* AVFILTER_AF_AFIR_H */
@@ -63,35 +63,21 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->in);
 }
 
-static int query_formats(AVFilterContext *ctx)
+/**
+ * Compute the output channel layout and the channels routing from the layouts
+ * of the inputs.
+ * @return 1 if the input layouts overlap, 0 if not, a negative error code
+ *         on failure
+ */
+static int merge_layouts(AVFilterContext *ctx,
+                         const AVChannelLayout *const *inlayout,
+                         AVChannelLayout *outlayout)
 {
-    static const enum AVSampleFormat packed_sample_fmts[] = {
-        AV_SAMPLE_FMT_U8,
-        AV_SAMPLE_FMT_S16,
-        AV_SAMPLE_FMT_S32,
-        AV_SAMPLE_FMT_FLT,
-        AV_SAMPLE_FMT_DBL,
-        AV_SAMPLE_FMT_NONE
-    };
     AMergeContext *s = ctx->priv;
-    AVChannelLayout *inlayout[SWR_CH_MAX] = { NULL }, outlayout = { 0 };
     uint64_t outmask = 0;
-    AVFilterChannelLayouts *layouts;
-    int i, ret, overlap = 0, nb_ch = 0;
+    int i, overlap = 0, nb_ch = 0;
 
     for (i = 0; i < s->nb_inputs; i++) {
-        if (!ctx->inputs[i]->incfg.channel_layouts ||
-            !ctx->inputs[i]->incfg.channel_layouts->nb_channel_layouts) {
-            av_log(ctx, AV_LOG_WARNING,
-                   "No channel layout for input %d\n", i + 1);
-            return AVERROR(EAGAIN);
-        }
-        inlayout[i] = &ctx->inputs[i]->incfg.channel_layouts->channel_layouts[0];
-        if (ctx->inputs[i]->incfg.channel_layouts->nb_channel_layouts > 1) {
-            char buf[256];
-            av_channel_layout_describe(inlayout[i], buf, sizeof(buf));
-            av_log(ctx, AV_LOG_INFO, "Using \"%s\" for input %d\n", buf, i + 1);
-        }
         s->in[i].nb_ch = FF_LAYOUT2COUNT(inlayout[i]);
         if (s->in[i].nb_ch) {
             overlap++;
@@ -109,19 +95,16 @@ static int query_formats(AVFilterContext *ctx)
         return AVERROR(EINVAL);
     }
     if (overlap) {
-        av_log(ctx, AV_LOG_WARNING,
-               "Input channel layouts overlap: "
-               "output layout will be determined by the number of distinct input channels\n");
         for (i = 0; i < nb_ch; i++)
             s->route[i] = i;
-        av_channel_layout_default(&outlayout, nb_ch);
-        if (!KNOWN(&outlayout) && nb_ch)
-            av_channel_layout_from_mask(&outlayout, 0xFFFFFFFFFFFFFFFFULL >> (64 - nb_ch));
+        av_channel_layout_default(outlayout, nb_ch);
+        if (!KNOWN(outlayout) && nb_ch)
+            av_channel_layout_from_mask(outlayout, 0xFFFFFFFFFFFFFFFFULL >> (64 - nb_ch));
     } else {
         int *route[SWR_CH_MAX];
         int c, out_ch_number = 0;
 
-        av_channel_layout_from_mask(&outlayout, outmask);
+        av_channel_layout_from_mask(outlayout, outmask);
         route[0] = s->route;
         for (i = 1; i < s->nb_inputs; i++)
             route[i] = route[i - 1] + s->in[i - 1].nb_ch;
@@ -130,6 +113,46 @@ static int query_formats(AVFilterContext *ctx)
                 if (av_channel_layout_index_from_channel(inlayout[i], c) >= 0)
                     *(route[i]++) = out_ch_number++;
     }
+    return !!overlap;
+}
+
+static int query_formats(AVFilterContext *ctx)
+{
+    static const enum AVSampleFormat packed_sample_fmts[] = {
+        AV_SAMPLE_FMT_U8,
+        AV_SAMPLE_FMT_S16,
+        AV_SAMPLE_FMT_S32,
+        AV_SAMPLE_FMT_FLT,
+        AV_SAMPLE_FMT_DBL,
+        AV_SAMPLE_FMT_NONE
+    };
+    AMergeContext *s = ctx->priv;
+    const AVChannelLayout *inlayout[SWR_CH_MAX] = { NULL };
+    AVChannelLayout outlayout = { 0 };
+    AVFilterChannelLayouts *layouts;
+    int i, ret;
+
+    for (i = 0; i < s->nb_inputs; i++) {
+        if (!ctx->inputs[i]->incfg.channel_layouts ||
+            !ctx->inputs[i]->incfg.channel_layouts->nb_channel_layouts) {
+            av_log(ctx, AV_LOG_WARNING,
+                   "No channel layout for input %d\n", i + 1);
+            return AVERROR(EAGAIN);
+        }
+        inlayout[i] = &ctx->inputs[i]->incfg.channel_layouts->channel_layouts[0];
+        if (ctx->inputs[i]->incfg.channel_layouts->nb_channel_layouts > 1) {
+            char buf[256];
+            av_channel_layout_describe(inlayout[i], buf, sizeof(buf));
+            av_log(ctx, AV_LOG_INFO, "Using \"%s\" for input %d\n", buf, i + 1);
+        }
+    }
+    ret = merge_layouts(ctx, inlayout, &outlayout);
+    if (ret < 0)
+        return ret;
+    if (ret)
+        av_log(ctx, AV_LOG_WARNING,
+               "Input channel layouts overlap: "
+               "output layout will be determined by the number of distinct input channels\n");
     if ((ret = ff_set_common_formats_from_list(ctx, packed_sample_fmts)) < 0)
         return ret;
     for (i = 0; i < s->nb_inputs; i++) {
@@ -152,8 +175,19 @@ static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
     AMergeContext *s = ctx->priv;
+    const AVChannelLayout *inlayout[SWR_CH_MAX] = { NULL };
+    AVChannelLayout outlayout = { 0 };
     AVBPrint bp;
-    int i;
+    int i, ret;
+
+    /* the routing is only derived from the negotiated input layouts, it is
+     * not kept from the formats query */
+    for (i = 0; i < s->nb_inputs; i++)
+        inlayout[i] = &ctx->inputs[i]->ch_layout;
+    ret = merge_layouts(ctx, inlayout, &outlayout);
+    av_channel_layout_uninit(&outlayout);
+    if (ret < 0)
+        return ret;
 
     s->bps = av_get_bytes_per_sample(outlink->format);
     outlink->time_base   = ctx->inputs[0]->time_base;
@@ -264,6 +298,9 @@ static int try_push_frame(AVFilterContext *ctx, int nb_samples)
             case 4:
                 copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, nb_samples, 4);
                 break;
+            case 8:
+                copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, nb_samples, 8);
+                break;
             default:
                 copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, nb_samples, s->bps);
                 break;
@@ -29,7 +29,6 @@
  */
 
 #include "libavutil/attributes.h"
-#include "libavutil/audio_fifo.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/channel_layout.h"
@@ -46,114 +45,12 @@
 #include "filters.h"
 
 #define INPUT_ON       1    /**< input is active */
-#define INPUT_EOF      2    /**< input has reached EOF (may still be active) */
 
 #define DURATION_LONGEST  0
 #define DURATION_SHORTEST 1
 #define DURATION_FIRST    2
 
 
-typedef struct FrameInfo {
-    int nb_samples;
-    int64_t pts;
-    struct FrameInfo *next;
-} FrameInfo;
-
-/**
- * Linked list used to store timestamps and frame sizes of all frames in the
- * FIFO for the first input.
- *
- * This is needed to keep timestamps synchronized for the case where multiple
- * input frames are pushed to the filter for processing before a frame is
- * requested by the output link.
- */
-typedef struct FrameList {
-    int nb_frames;
-    int nb_samples;
-    FrameInfo *list;
-    FrameInfo *end;
-} FrameList;
-
-static void frame_list_clear(FrameList *frame_list)
-{
-    if (frame_list) {
-        while (frame_list->list) {
-            FrameInfo *info = frame_list->list;
-            frame_list->list = info->next;
-            av_free(info);
-        }
-        frame_list->nb_frames  = 0;
-        frame_list->nb_samples = 0;
-        frame_list->end        = NULL;
-    }
-}
-
-static int frame_list_next_frame_size(FrameList *frame_list)
-{
-    if (!frame_list->list)
-        return 0;
-    return frame_list->list->nb_samples;
-}
-
-static int64_t frame_list_next_pts(FrameList *frame_list)
-{
-    if (!frame_list->list)
-        return AV_NOPTS_VALUE;
-    return frame_list->list->pts;
-}
-
-static void frame_list_remove_samples(FrameList *frame_list, int nb_samples)
-{
-    if (nb_samples >= frame_list->nb_samples) {
-        frame_list_clear(frame_list);
-    } else {
-        int samples = nb_samples;
-        while (samples > 0) {
-            FrameInfo *info = frame_list->list;
-            av_assert0(info);
-            if (info->nb_samples <= samples) {
-                samples -= info->nb_samples;
-                frame_list->list = info->next;
-                if (!frame_list->list)
-                    frame_list->end = NULL;
-                frame_list->nb_frames--;
-                frame_list->nb_samples -= info->nb_samples;
-                av_free(info);
-            } else {
-                info->nb_samples       -= samples;
-                info->pts              += samples;
-                frame_list->nb_samples -= samples;
-                samples = 0;
-            }
-        }
-    }
-}
-
-static int frame_list_add_frame(FrameList *frame_list, int nb_samples, int64_t pts)
-{
-    FrameInfo *info = av_malloc(sizeof(*info));
-    if (!info)
-        return AVERROR(ENOMEM);
-    info->nb_samples = nb_samples;
-    info->pts        = pts;
-    info->next       = NULL;
-
-    if (!frame_list->list) {
-        frame_list->list = info;
-        frame_list->end  = info;
-    } else {
-        av_assert0(frame_list->end);
-        frame_list->end->next = info;
-        frame_list->end       = info;
-    }
-    frame_list->nb_frames++;
-    frame_list->nb_samples += nb_samples;
-
-    return 0;
-}
-
-/* FIXME: use directly links fifo */
-
 typedef struct MixContext {
     const AVClass *class;       /**< class for AVOptions */
     AVFloatDSPContext *fdsp;
@@ -168,14 +65,12 @@ typedef struct MixContext {
     int nb_channels;            /**< number of channels */
     int sample_rate;            /**< sample rate */
     int planar;
-    AVAudioFifo **fifos;        /**< audio fifo for each input */
     uint8_t *input_state;       /**< current state of each input */
     float *input_scale;         /**< mixing scale factor for each input */
     float *weights;             /**< custom weights for every input */
     float weight_sum;           /**< sum of custom weights for every input */
     float *scale_norm;          /**< normalization factor for every input */
     int64_t next_pts;           /**< calculated pts for next output frame */
-    FrameList *frame_list;      /**< list of frame info for the first input */
 } MixContext;
 
 #define OFFSET(x) offsetof(MixContext, x)
@@ -252,20 +147,7 @@ static int config_output(AVFilterLink *outlink)
     outlink->time_base = (AVRational){ 1, outlink->sample_rate };
     s->next_pts        = AV_NOPTS_VALUE;
 
-    s->frame_list = av_mallocz(sizeof(*s->frame_list));
-    if (!s->frame_list)
-        return AVERROR(ENOMEM);
-
-    s->fifos = av_calloc(s->nb_inputs, sizeof(*s->fifos));
-    if (!s->fifos)
-        return AVERROR(ENOMEM);
-
     s->nb_channels = outlink->ch_layout.nb_channels;
-    for (i = 0; i < s->nb_inputs; i++) {
-        s->fifos[i] = av_audio_fifo_alloc(outlink->format, s->nb_channels, 1024);
-        if (!s->fifos[i])
-            return AVERROR(ENOMEM);
-    }
 
     s->input_state = av_malloc(s->nb_inputs);
     if (!s->input_state)
@@ -291,23 +173,59 @@ static int config_output(AVFilterLink *outlink)
 }
 
 /**
- * Read samples from the input FIFOs, mix, and write to the output link.
+ * Check if the samples of a frame can be mixed directly, without copying them
+ * to a buffer suitable for the float DSP functions first.
+ *
+ * The DSP functions read plane_size bytes from each plane, which may extend
+ * past the last sample. The data pointers of a partially consumed frame point
+ * into the middle of its buffers while linesize is unchanged, so the space
+ * left up to the end of the buffer holding each plane is checked instead.
+ */
+static int frame_is_mixable(const AVFrame *frame, int planes, int plane_size)
+{
+    const int nb_buf = FF_ARRAY_ELEMS(frame->buf);
+
+    for (int p = 0; p < planes; p++) {
+        const uint8_t *data = frame->extended_data[p];
+        const AVBufferRef *buf = NULL;
+
+        if ((uintptr_t)data & 31)
+            return 0;
+        /* planes usually have a buffer each, but may share one */
+        for (int i = 0; i < nb_buf + frame->nb_extended_buf && !buf; i++) {
+            buf = i < nb_buf ? frame->buf[i] : frame->extended_buf[i - nb_buf];
+            if (buf && (data < buf->data || data >= buf->data + buf->size))
+                buf = NULL;
+        }
+        if (!buf || buf->data + buf->size - data < plane_size)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Take samples from the input links, mix, and write to the output link.
  */
 static int output_frame(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
     MixContext      *s = ctx->priv;
-    AVFrame *out_buf, *in_buf;
-    int nb_samples, ns, i;
+    AVFrame *out_buf, *in_buf = NULL;
+    int nb_samples, ns, i, planes, plane_size, ret = 0;
 
     if (s->input_state[0] & INPUT_ON) {
         /* first input live: use the corresponding frame size */
-        nb_samples = frame_list_next_frame_size(s->frame_list);
+        const AVFrame *frame;
+
+        if (!ff_inlink_queued_frames(ctx->inputs[0]))
+            return 0;
+        frame = ff_inlink_peek_frame(ctx->inputs[0], 0);
+        nb_samples = frame->nb_samples;
         for (i = 1; i < s->nb_inputs; i++) {
             if (s->input_state[i] & INPUT_ON) {
-                ns = av_audio_fifo_size(s->fifos[i]);
+                ns = ff_inlink_queued_samples(ctx->inputs[i]);
                 if (ns < nb_samples) {
-                    if (!(s->input_state[i] & INPUT_EOF))
+                    if (!ff_inlink_check_available_samples(ctx->inputs[i], nb_samples))
                         /* unclosed input with not enough samples */
                         return 0;
                     /* closed input to drain */
@@ -316,13 +234,15 @@ static int output_frame(AVFilterLink *outlink)
             }
         }
 
-        s->next_pts = frame_list_next_pts(s->frame_list);
+        s->next_pts = frame->pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE :
+                      av_rescale_q(frame->pts, ctx->inputs[0]->time_base,
+                                   outlink->time_base);
     } else {
         /* first input closed: use the available samples */
         nb_samples = INT_MAX;
         for (i = 1; i < s->nb_inputs; i++) {
             if (s->input_state[i] & INPUT_ON) {
-                ns = av_audio_fifo_size(s->fifos[i]);
+                ns = ff_inlink_queued_samples(ctx->inputs[i]);
                 nb_samples = FFMIN(nb_samples, ns);
             }
         }
@@ -332,8 +252,6 @@ static int output_frame(AVFilterLink *outlink)
         }
     }
 
-    frame_list_remove_samples(s->frame_list, nb_samples);
-
     calculate_scales(s, nb_samples);
 
     if (nb_samples == 0)
@@ -343,37 +261,51 @@ static int output_frame(AVFilterLink *outlink)
     if (!out_buf)
         return AVERROR(ENOMEM);
 
-    in_buf = ff_get_audio_buffer(outlink, nb_samples);
-    if (!in_buf) {
-        av_frame_free(&out_buf);
-        return AVERROR(ENOMEM);
-    }
+    planes     = s->planar ? s->nb_channels : 1;
+    plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
+    plane_size = FFALIGN(plane_size, 16);
 
     for (i = 0; i < s->nb_inputs; i++) {
         if (s->input_state[i] & INPUT_ON) {
-            int planes, plane_size, p;
-
-            av_audio_fifo_read(s->fifos[i], (void **)in_buf->extended_data,
-                               nb_samples);
+            AVFrame *in, *src;
+            int p;
 
-            planes     = s->planar ? s->nb_channels : 1;
-            plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
-            plane_size = FFALIGN(plane_size, 16);
+            ret = ff_inlink_consume_samples(ctx->inputs[i], nb_samples,
+                                            nb_samples, &in);
+            if (ret < 0)
+                goto fail;
+            av_assert1(ret && in->nb_samples == nb_samples);
+
+            /* the frames are usually mixed in place, but may come from
+             * buffers without the alignment or padding the DSP needs */
+            src = in;
+            if (!frame_is_mixable(in, planes,
+                                  plane_size * av_get_bytes_per_sample(outlink->format))) {
+                if (!in_buf && !(in_buf = ff_get_audio_buffer(outlink, nb_samples))) {
+                    av_frame_free(&in);
+                    ret = AVERROR(ENOMEM);
+                    goto fail;
+                }
+                av_samples_copy(in_buf->extended_data, in->extended_data, 0, 0,
+                                nb_samples, s->nb_channels, outlink->format);
+                src = in_buf;
+            }
 
             if (out_buf->format == AV_SAMPLE_FMT_FLT ||
                 out_buf->format == AV_SAMPLE_FMT_FLTP) {
                 for (p = 0; p < planes; p++) {
                     s->fdsp->vector_fmac_scalar((float *)out_buf->extended_data[p],
-                                                (float *) in_buf->extended_data[p],
+                                                (float *)    src->extended_data[p],
                                                 s->input_scale[i], plane_size);
                 }
             } else {
                 for (p = 0; p < planes; p++) {
                     s->fdsp->vector_dmac_scalar((double *)out_buf->extended_data[p],
-                                                (double *) in_buf->extended_data[p],
+                                                (double *)    src->extended_data[p],
                                                 s->input_scale[i], plane_size);
                 }
             }
+            av_frame_free(&in);
         }
     }
     av_frame_free(&in_buf);
@@ -386,6 +318,10 @@ static int output_frame(AVFilterLink *outlink)
         s->next_pts += nb_samples;
 
     return ff_filter_frame(outlink, out_buf);
+fail:
+    av_frame_free(&in_buf);
+    av_frame_free(&out_buf);
+    return ret;
 }
 
 /**
@@ -398,15 +334,17 @@ static int request_samples(AVFilterContext *ctx, int min_samples)
 
     av_assert0(s->nb_inputs > 1);
     if (min_samples == 1 && s->duration_mode == DURATION_FIRST)
-        min_samples = av_audio_fifo_size(s->fifos[0]);
+        min_samples = ff_inlink_queued_samples(ctx->inputs[0]);
 
     for (i = 1; i < s->nb_inputs; i++) {
+        AVFilterLink *inlink = ctx->inputs[i];
+
+        /* inactive, with enough samples, or closed with samples to drain */
         if (!(s->input_state[i] & INPUT_ON) ||
-             (s->input_state[i] & INPUT_EOF))
-            continue;
-        if (av_audio_fifo_size(s->fifos[i]) >= min_samples)
+            ff_inlink_queued_samples(inlink) >= min_samples ||
+            ff_inlink_check_available_samples(inlink, min_samples))
             continue;
-        ff_inlink_request_frame(ctx->inputs[i]);
+        ff_inlink_request_frame(inlink);
         return 0;
     }
     return output_frame(ctx->outputs[0]);
@@ -437,53 +375,23 @@ static int activate(AVFilterContext *ctx)
 {
     AVFilterLink *outlink = ctx->outputs[0];
     MixContext *s = ctx->priv;
-    AVFrame *buf = NULL;
     int i, ret;
 
     FF_FILTER_FORWARD_STATUS_BACK_ALL(outlink, ctx);
 
-    for (i = 0; i < s->nb_inputs; i++) {
-        AVFilterLink *inlink = ctx->inputs[i];
-
-        if ((ret = ff_inlink_consume_frame(ctx->inputs[i], &buf)) > 0) {
-            if (i == 0) {
-                int64_t pts = av_rescale_q(buf->pts, inlink->time_base,
-                                           outlink->time_base);
-                ret = frame_list_add_frame(s->frame_list, buf->nb_samples, pts);
-                if (ret < 0) {
-                    av_frame_free(&buf);
-                    return ret;
-                }
-            }
-
-            ret = av_audio_fifo_write(s->fifos[i], (void **)buf->extended_data,
-                                      buf->nb_samples);
-            if (ret < 0) {
-                av_frame_free(&buf);
-                return ret;
-            }
-
-            av_frame_free(&buf);
-
-            ret = output_frame(outlink);
-            if (ret < 0)
-                return ret;
-        }
-    }
-
+    /* The samples are mixed straight from the frames queued on the input
+     * links: an input is done once its status is acknowledged, which only
+     * happens after all its frames have been consumed. */
     for (i = 0; i < s->nb_inputs; i++) {
         int64_t pts;
         int status;
 
         if (ff_inlink_acknowledge_status(ctx->inputs[i], &status, &pts)) {
             if (status == AVERROR_EOF) {
-                s->input_state[i] |= INPUT_EOF;
-                if (av_audio_fifo_size(s->fifos[i]) == 0) {
-                    s->input_state[i] &= ~INPUT_ON;
-                    if (s->nb_inputs == 1) {
-                        ff_outlink_set_status(outlink, status, pts);
-                        return 0;
-                    }
+                s->input_state[i] &= ~INPUT_ON;
+                if (s->nb_inputs == 1) {
+                    ff_outlink_set_status(outlink, status, pts);
+                    return 0;
                 }
             }
         }
@@ -494,19 +402,22 @@ static int activate(AVFilterContext *ctx)
         return 0;
     }
 
+    ret = output_frame(outlink);
+    if (ret < 0)
+        return ret;
+
     if (ff_outlink_frame_wanted(outlink)) {
         int wanted_samples;
 
         if (!(s->input_state[0] & INPUT_ON))
             return request_samples(ctx, 1);
 
-        if (s->frame_list->nb_frames == 0) {
+        if (!ff_inlink_queued_frames(ctx->inputs[0])) {
             ff_inlink_request_frame(ctx->inputs[0]);
             return 0;
         }
-        av_assert0(s->frame_list->nb_frames > 0);
 
-        wanted_samples = frame_list_next_frame_size(s->frame_list);
+        wanted_samples = ff_inlink_peek_frame(ctx->inputs[0], 0)->nb_samples;
 
         return request_samples(ctx, wanted_samples);
     }
@@ -573,16 +484,8 @@ static av_cold int init(AVFilterContext *ctx)
 
 static av_cold void uninit(AVFilterContext *ctx)
 {
-    int i;
     MixContext *s = ctx->priv;
 
-    if (s->fifos) {
-        for (i = 0; i < s->nb_inputs; i++)
-            av_audio_fifo_free(s->fifos[i]);
-        av_freep(&s->fifos);
-    }
-    frame_list_clear(s->frame_list);
-    av_freep(&s->frame_list);
     av_freep(&s->input_state);
     av_freep(&s->input_scale);
     av_freep(&s->scale_norm);
@@ -107,7 +107,7 @@ static void fn(convert_channel)(AVFilterContext *ctx, AudioFIRContext *s, int ch
     memset(tempin + size, 0, sizeof(*tempin) * (seg->block_size - size));
     memcpy(tempin, time + seg->input_offset + coeff_partition * seg->part_size,
            size * sizeof(*tempin));
-    seg->ctx_fn(seg->ctx[ch], tempout, tempin, sizeof(*tempin));
+    seg->ctx_fn(seg->ctx, tempout, tempin, sizeof(*tempin));
     memcpy(coeff + coffset, tempout, seg->coeff_size * sizeof(*coeff));
 
     av_log(ctx, AV_LOG_DEBUG, "channel: %d\n", ch);
@@ -134,7 +134,8 @@ static void fn(fir_fadd)(AudioFIRContext *s, ftype *dst, const ftype *src, int n
     }
 }
 
-static int fn(fir_quantum)(AVFilterContext *ctx, AVFrame *out, int ch, int ioffset, int offset, int selir)
+static int fn(fir_quantum)(AVFilterContext *ctx, AVFrame *out, int ch, int jobnr,
+                            int ioffset, int offset, int selir)
 {
     AudioFIRContext *s = ctx->priv;
     const ftype *in = (const ftype *)s->in->extended_data[ch] + ioffset;
@@ -190,7 +191,7 @@ static int fn(fir_quantum)(AVFilterContext *ctx, AVFrame *out, int ch, int ioffs
         blockout = (ftype *)seg->blockout->extended_data[ch] + seg->part_index[ch] * seg->block_size;
         memset(tempin + part_size, 0, sizeof(*tempin) * (seg->block_size - part_size));
         memcpy(tempin, src, sizeof(*src) * part_size);
-        seg->tx_fn(seg->tx[ch], blockout, tempin, sizeof(ftype));
+        seg->tx_fn(seg->tx[jobnr], blockout, tempin, sizeof(ftype));
 
         j = seg->part_index[ch];
         for (int i = 0; i < nb_partitions; i++) {
@@ -211,7 +212,7 @@ static int fn(fir_quantum)(AVFilterContext *ctx, AVFrame *out, int ch, int ioffs
 #endif
         }
 
-        seg->itx_fn(seg->itx[ch], sumout, sumin, sizeof(ctype));
+        seg->itx_fn(seg->itx[jobnr], sumout, sumin, sizeof(ctype));
 
         fn(fir_fadd)(s, buf, sumout, part_size);
         memcpy(dst, buf, part_size * sizeof(*dst));
@@ -243,7 +244,7 @@ static int fn(fir_quantum)(AVFilterContext *ctx, AVFrame *out, int ch, int ioffs
 }
 
 static void fn(fir_quantums)(AVFilterContext *ctx, AudioFIRContext *s, AVFrame *out,
-                             int min_part_size, int ch, int offset,
+                             int min_part_size, int ch, int jobnr, int offset,
                              int prev_selir, int selir)
 {
     if (ctx->is_disabled || s->prev_is_disabled) {
@@ -256,12 +257,12 @@ static void fn(fir_quantums)(AVFilterContext *ctx, AudioFIRContext *s, AVFrame *
 
         if (ctx->is_disabled && !s->prev_is_disabled) {
             memset(src0, 0, min_part_size * sizeof(ftype));
-            fn(fir_quantum)(ctx, s->fadein[0], ch, offset, 0, selir);
+            fn(fir_quantum)(ctx, s->fadein[0], ch, jobnr, offset, 0, selir);
             for (int n = 0; n < min_part_size; n++)
                 dst[n] = xfade1[n] * src0[n] + xfade0[n] * in[n];
         } else if (!ctx->is_disabled && s->prev_is_disabled) {
             memset(src1, 0, min_part_size * sizeof(ftype));
-            fn(fir_quantum)(ctx, s->fadein[1], ch, offset, 0, selir);
+            fn(fir_quantum)(ctx, s->fadein[1], ch, jobnr, offset, 0, selir);
             for (int n = 0; n < min_part_size; n++)
                 dst[n] = xfade1[n] * in[n] + xfade0[n] * src1[n];
         } else {
@@ -277,8 +278,8 @@ static void fn(fir_quantums)(AVFilterContext *ctx, AudioFIRContext *s, AVFrame *
         memset(src0, 0, min_part_size * sizeof(ftype));
         memset(src1, 0, min_part_size * sizeof(ftype));
 
-        fn(fir_quantum)(ctx, s->fadein[0], ch, offset, 0, prev_selir);
-        fn(fir_quantum)(ctx, s->fadein[1], ch, offset, 0, selir);
+        fn(fir_quantum)(ctx, s->fadein[0], ch, jobnr, offset, 0, prev_selir);
+        fn(fir_quantum)(ctx, s->fadein[1], ch, jobnr, offset, 0, selir);
 
         if (s->loading[ch] > s->max_offset[selir]) {
             for (int n = 0; n < min_part_size; n++)
@@ -288,6 +289,6 @@ static void fn(fir_quantums)(AVFilterContext *ctx, AudioFIRContext *s, AVFrame *
             memcpy(dst, src0, min_part_size * sizeof(ftype));
         }
     } else {
-        fn(fir_quantum)(ctx, out, ch, offset, offset, selir);
+        fn(fir_quantum)(ctx, out, ch, jobnr, offset, offset, selir);
     }
 }
@@ -230,13 +230,43 @@ static void update_link_current_pts(FilterLinkInternal *li, int64_t pts)
     li->l.current_pts = pts;
     li->l.current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
     /* TODO use duration */
-    if (li->l.graph && li->age_index >= 0)
+    if (li->l.graph && li->age_index >= 0) {
+        FFFilterGraph *graphi = fffiltergraph(li->l.graph);
+
+        if (graphi->pipeline)
+            ff_mutex_lock(&graphi->pipeline_lock);
         ff_avfilter_graph_update_heap(li->l.graph, li);
+        if (graphi->pipeline)
+            ff_mutex_unlock(&graphi->pipeline_lock);
+    }
+}
+
+/**
+ * Raise the ready value of a filter to priority, or reset it if priority is 0.
+ */
+static void filter_update_ready(AVFilterContext *filter, unsigned priority)
+{
+    FFFilterGraph *graphi = filter->graph ? fffiltergraph(filter->graph) : NULL;
+
+    if (!graphi) {
+        filter->ready = priority ? FFMAX(filter->ready, priority) : 0;
+        return;
+    }
+
+    if (graphi->pipeline)
+        ff_mutex_lock(&graphi->pipeline_lock);
+    if (!priority || priority > filter->ready) {
+        filter->ready = priority;
+        ff_filter_graph_update_ready(filter->graph, filter);
+    }
+    if (graphi->pipeline)
+        ff_mutex_unlock(&graphi->pipeline_lock);
 }
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
-    filter->ready = FFMAX(filter->ready, priority);
+    if (priority)
+        filter_update_ready(filter, priority);
 }
 
 /**
@@ -492,6 +522,7 @@ int ff_request_frame(AVFilterLink *link)
         }
     }
     li->frame_wanted_out = 1;
+    li->frame_requested  = 1;
     ff_filter_set_ready(link->src, 100);
     return 0;
 }
@@ -657,8 +688,10 @@ static const AVClass *filter_child_class_iterate(void **iter)
 #define TFLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_RUNTIME_PARAM
 static const AVOption avfilter_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
-        { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, FLAGS, .unit = "thread_type" },
+        { .i64 = AVFILTER_THREAD_SLICE | AVFILTER_THREAD_PIPELINE | AVFILTER_THREAD_ROWS }, 0, INT_MAX, FLAGS, .unit = "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = FLAGS, .unit = "thread_type" },
+        { "pipeline", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_PIPELINE }, .flags = FLAGS, .unit = "thread_type" },
+        { "rows", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_ROWS }, .flags = FLAGS, .unit = "thread_type" },
     { "enable", "set enable expression", OFFSET(enable_str), AV_OPT_TYPE_STRING, {.str=NULL}, .flags = TFLAGS },
     { "threads", "Allowed number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, FLAGS, .unit = "threads" },
@@ -704,6 +737,7 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name)
     if (!ctx)
         return NULL;
     ret = &ctx->p;
+    ctx->ready_index = -1;
 
     ret->av_class = &avfilter_class;
     ret->filter   = filter;
@@ -815,6 +849,7 @@ void avfilter_free(AVFilterContext *filter)
 
     av_buffer_unref(&filter->hw_device_ctx);
 
+    av_freep(&fffilterctx(filter)->config_opts);
     av_freep(&filter->name);
     av_freep(&filter->input_pads);
     av_freep(&filter->output_pads);
@@ -907,7 +942,7 @@ int ff_filter_process_command(AVFilterContext *ctx, const char *cmd,
 int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
 {
     FFFilterContext *ctxi = fffilterctx(ctx);
-    int ret = 0;
+    int thread_type, ret = 0;
 
     if (ctxi->initialized) {
         av_log(ctx, AV_LOG_ERROR, "Filter already initialized\n");
@@ -920,14 +955,22 @@ int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
         return ret;
     }
 
+    thread_type      = ctx->thread_type & ctx->graph->thread_type;
+    ctx->thread_type = 0;
     if (ctx->filter->flags & AVFILTER_FLAG_SLICE_THREADS &&
-        ctx->thread_type & ctx->graph->thread_type & AVFILTER_THREAD_SLICE &&
+        thread_type & AVFILTER_THREAD_SLICE &&
         fffiltergraph(ctx->graph)->thread_execute) {
         ctx->thread_type       = AVFILTER_THREAD_SLICE;
         ctxi->execute    = fffiltergraph(ctx->graph)->thread_execute;
-    } else {
-        ctx->thread_type = 0;
     }
+    if (thread_type & AVFILTER_THREAD_PIPELINE &&
+        fffiltergraph(ctx->graph)->pipeline &&
+        !(ctx->filter->flags_internal & FF_FILTER_FLAG_GRAPH_ACCESS))
+        ctx->thread_type |= AVFILTER_THREAD_PIPELINE;
+    if (thread_type & AVFILTER_THREAD_ROWS &&
+        !fffiltergraph(ctx->graph)->pipeline &&
+        ctx->filter->flags_internal & FF_FILTER_FLAG_SLICE_ROWS)
+        ctx->thread_type |= AVFILTER_THREAD_ROWS;
 
     if (ctx->filter->init)
         ret = ctx->filter->init(ctx);
@@ -983,6 +1026,100 @@ enum AVMediaType avfilter_pad_get_type(const AVFilterPad *pads, int pad_idx)
     return pads[pad_idx].type;
 }
 
+/* Bands are aimed at this number of rows, unless more are needed to use all
+ * the threads. */
+#define ROWS_BAND_HEIGHT 16
+
+static int rows_job(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const FFFilterGraph *graphi = arg;
+
+    for (int i = 0; i < graphi->nb_rows_stages; i++) {
+        const FFRowsStage *stage = &graphi->rows_stages[i];
+        stage->func(stage->ctx, stage->arg, jobnr, nb_jobs);
+    }
+    return 0;
+}
+
+/**
+ * Get the number of bands to split the frames of the deferred stages in,
+ * so that all the filters split all the planes at the same rows.
+ *
+ * @return the number of bands, 0 if the frames cannot be split
+ */
+static int rows_nb_bands(const FFFilterGraph *graphi)
+{
+    int h = graphi->rows_stages[0].ctx->inputs[0]->h;
+    int log2_unit = 1, nb_jobs = 1, nb_units, nb_bands;
+
+    for (int i = 0; i < graphi->nb_rows_stages; i++) {
+        const AVFilterContext *ctx = graphi->rows_stages[i].ctx;
+        const AVPixFmtDescriptor *in  = av_pix_fmt_desc_get(ctx->inputs[0]->format);
+        const AVPixFmtDescriptor *out = av_pix_fmt_desc_get(ctx->outputs[0]->format);
+
+        if (ctx->inputs[0]->h != h || ctx->outputs[0]->h != h)
+            return 0;
+        log2_unit = FFMAX3(log2_unit, in->log2_chroma_h, out->log2_chroma_h);
+        nb_jobs   = FFMAX(nb_jobs, graphi->rows_stages[i].nb_jobs);
+    }
+    if (h & ((1 << log2_unit) - 1))
+        return 0;
+
+    /* any divisor of the number of units splits all the planes exactly */
+    nb_units = h >> log2_unit;
+    for (nb_bands = FFMAX(nb_jobs, h / ROWS_BAND_HEIGHT); nb_bands < nb_units; nb_bands++)
+        if (!(nb_units % nb_bands))
+            return nb_bands;
+    return nb_units;
+}
+
+/**
+ * Run the deferred slice jobs, by bands of rows going through all the
+ * filters if there are several of them.
+ */
+static void rows_flush(FFFilterGraph *graphi)
+{
+    int nb_bands;
+
+    if (!graphi->nb_rows_stages)
+        return;
+
+    if (graphi->nb_rows_stages > 1 && (nb_bands = rows_nb_bands(graphi))) {
+        AVFilterContext *ctx = graphi->rows_stages[0].ctx;
+        fffilterctx(ctx)->execute(ctx, rows_job, graphi, NULL, nb_bands);
+    } else {
+        for (int i = 0; i < graphi->nb_rows_stages; i++) {
+            const FFRowsStage *stage = &graphi->rows_stages[i];
+            fffilterctx(stage->ctx)->execute(stage->ctx, stage->func, stage->arg,
+                                             NULL, stage->nb_jobs);
+        }
+    }
+    graphi->nb_rows_stages = 0;
+}
+
+/**
+ * Check if a frame sent on a link can be processed by the destination filter
+ * before the slice jobs of the source filter are run.
+ */
+static int rows_can_chain(AVFilterLink *link, const AVFrame *frame)
+{
+    const FFFilterGraph *graphi = fffiltergraph(link->dst->graph);
+    const FilterLinkInternal *li = ff_link_internal(link);
+    const AVFilterContext *dst = link->dst;
+
+    return graphi->rows_stages[graphi->nb_rows_stages - 1].ctx == link->src &&
+           graphi->nb_rows_stages < FF_MAX_ROWS_STAGES &&
+           dst->thread_type & AVFILTER_THREAD_ROWS &&
+           !dst->filter->activate &&
+           !ff_framequeue_queued_frames(&li->fifo) &&
+           !ff_link_internal(dst->outputs[0])->status_in &&
+           (!(link->dstpad->flags & AVFILTERPAD_FLAG_NEEDS_WRITABLE) ||
+            av_frame_is_writable((AVFrame *)frame)) &&
+           frame->height == link->h;
+}
+
+static int ff_filter_frame_to_filter(AVFilterLink *link);
+
 static int default_filter_frame(AVFilterLink *link, AVFrame *frame)
 {
     return ff_filter_frame(link->dst->outputs[0], frame);
@@ -994,6 +1131,9 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
     int (*filter_frame)(AVFilterLink *, AVFrame *);
     AVFilterContext *dstctx = link->dst;
     AVFilterPad *dst = link->dstpad;
+    FFFilterGraph *graphi = fffiltergraph(dstctx->graph);
+    AVFilterContext *rows_filter = graphi->rows_filter;
+    int nb_rows_stages = graphi->nb_rows_stages;
     int ret;
 
     if (!(filter_frame = dst->filter_frame))
@@ -1011,7 +1151,14 @@ static int ff_filter_frame_framed(AVFilterLink *link, AVFrame *frame)
     if (dstctx->is_disabled &&
         (dstctx->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC))
         filter_frame = default_filter_frame;
+    if (dstctx->thread_type & AVFILTER_THREAD_ROWS)
+        graphi->rows_filter = dstctx;
     ret = filter_frame(link, frame);
+    if (dstctx->thread_type & AVFILTER_THREAD_ROWS) {
+        graphi->rows_filter = rows_filter;
+        /* jobs deferred by the filter cannot be run once it returned */
+        graphi->nb_rows_stages = FFMIN(graphi->nb_rows_stages, nb_rows_stages);
+    }
     l->frame_count_out++;
     return ret;
 
@@ -1023,9 +1170,15 @@ fail:
 int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
 {
     FilterLinkInternal * const li = ff_link_internal(link);
-    int ret;
+    FFFilterGraph *graphi = fffiltergraph(link->dst->graph);
+    int rows_chain = 0, ret;
     FF_TPRINTF_START(NULL, filter_frame); ff_tlog_link(NULL, link, 1); ff_tlog(NULL, " "); tlog_ref(NULL, frame, 1);
 
+    /* The frame is being written by the deferred slice jobs: either keep
+     * processing it by bands in the destination filter, or complete it. */
+    if (graphi->nb_rows_stages && !(rows_chain = rows_can_chain(link, frame)))
+        rows_flush(graphi);
+
     /* Consistency checks */
     if (link->type == AVMEDIA_TYPE_VIDEO) {
         if (strcmp(link->dst->filter->name, "buffersink") &&
@@ -1067,6 +1220,14 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
         return ret;
     }
     ff_filter_set_ready(link->dst, 300);
+
+    if (rows_chain) {
+        ret = ff_filter_frame_to_filter(link);
+        /* Jobs still deferred at this point are writing a frame the
+         * destination did not use. */
+        graphi->nb_rows_stages = 0;
+        return ret;
+    }
     return 0;
 
 error:
@@ -1318,7 +1479,8 @@ static int ff_filter_activate_default(AVFilterContext *filter)
      link_set_out_status().
 
    Filters are activated according to the ready field, set using the
-   ff_filter_set_ready(). Eventually, a priority queue will be used.
+   ff_filter_set_ready(). The graph keeps the ready filters in a priority
+   queue, so picking the next one does not depend on the size of the graph.
    ff_filter_set_ready() is called whenever anything could cause progress to
    be possible. Marking a filter ready when it is not is not a problem,
    except for the small overhead it causes.
@@ -1387,7 +1549,7 @@ int ff_filter_activate(AVFilterContext *filter)
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
-    filter->ready = 0;
+    filter_update_ready(filter, 0);
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
     if (ret == FFERROR_NOT_READY)
@@ -1581,6 +1743,7 @@ void ff_inlink_request_frame(AVFilterLink *link)
     av_assert1(!li->status_in);
     av_assert1(!li->status_out);
     li->frame_wanted_out = 1;
+    li->frame_requested  = 1;
     ff_filter_set_ready(link->src, 100);
 }
 
@@ -1651,5 +1814,23 @@ int ff_outlink_frame_wanted(AVFilterLink *link)
 int ff_filter_execute(AVFilterContext *ctx, avfilter_action_func *func,
                       void *arg, int *ret, int nb_jobs)
 {
+    FFFilterGraph *graphi = fffiltergraph(ctx->graph);
+
+    if (ctx->thread_type & AVFILTER_THREAD_ROWS && !ret &&
+        graphi->rows_filter == ctx &&
+        graphi->nb_rows_stages < FF_MAX_ROWS_STAGES &&
+        (!graphi->nb_rows_stages ||
+         graphi->rows_stages[graphi->nb_rows_stages - 1].ctx != ctx)) {
+        /* run later, when the frame leaves the chain of row filters */
+        graphi->rows_stages[graphi->nb_rows_stages++] = (FFRowsStage){
+            .ctx     = ctx,
+            .func    = func,
+            .arg     = arg,
+            .nb_jobs = nb_jobs,
+        };
+        return 0;
+    }
+
+    rows_flush(graphi);
     return fffilterctx(ctx)->execute(ctx, func, arg, ret, nb_jobs);
 }
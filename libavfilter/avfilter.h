@@ -452,6 +452,25 @@ unsigned avfilter_filter_pad_count(const AVFilter *filter, int is_output);
  * Process multiple parts of the frame concurrently.
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
+/**
+ * Activate different filters of the graph concurrently. Filters connected by a
+ * link are never run at the same time, and frames are requested ahead on the
+ * links so that consecutive filters can work on different frames.
+ *
+ * This threading type is only enabled if set in AVFilterGraph.thread_type
+ * before any filter is added to the graph, and is not available when
+ * AVFilterGraph.execute is set.
+ */
+#define AVFILTER_THREAD_PIPELINE (1 << 1)
+/**
+ * Process frames by bands of rows through chains of filters working row by
+ * row, e.g. lut or eq: each band of a frame goes through all the filters of
+ * the chain before the next one is started, while it is still in the CPU
+ * caches. Bands are processed concurrently if slice threading is enabled too.
+ *
+ * This threading type is not used together with AVFILTER_THREAD_PIPELINE.
+ */
+#define AVFILTER_THREAD_ROWS     (1 << 2)
 
 /** An instance of a filter */
 struct AVFilterContext {
@@ -885,6 +904,59 @@ enum {
  */
 int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx);
 
+/**
+ * Formats negotiated in a configured filtergraph, used to configure other
+ * graphs made of the same filters without negotiating their formats again.
+ *
+ * @see avfilter_graph_template_create(), avfilter_graph_config_template()
+ */
+typedef struct AVFilterGraphTemplate AVFilterGraphTemplate;
+
+/**
+ * Create a template from a configured filtergraph.
+ *
+ * The template stores the formats of all the links of the graph and the
+ * conversion filters that were inserted during its configuration. It does not
+ * reference the graph, which can be freed independently.
+ *
+ * @param tmpl  pointer to the new template, to be freed with
+ *              avfilter_graph_template_free(); set to NULL on failure
+ * @param graph filtergraph successfully configured with
+ *              avfilter_graph_config_template(), to which no filter was
+ *              added since
+ * @return >= 0 in case of success, a negative AVERROR code otherwise
+ */
+int avfilter_graph_template_create(AVFilterGraphTemplate **tmpl,
+                                   const AVFilterGraph *graph);
+
+/**
+ * Check validity and configure all the links and formats in the graph, taking
+ * the formats from a template instead of negotiating them.
+ *
+ * The template is only used if the graph is made of the same filters as the
+ * graph it was created from, in the same order, with the same options and the
+ * same links, such as when the same filtergraph description is parsed again.
+ * Graphs containing hardware filters, whose formats depend on their device,
+ * never use the template. Otherwise this function is equivalent to
+ * avfilter_graph_config(), except that it also saves the options of the
+ * filters, so that a template can be created from the graph.
+ *
+ * @param graphctx the filter graph
+ * @param tmpl     template created with avfilter_graph_template_create(), or
+ *                 NULL to negotiate the formats
+ * @param log_ctx  context used for logging
+ * @return 1 if the template was used, 0 if the formats were negotiated,
+ *         a negative AVERROR code otherwise
+ */
+int avfilter_graph_config_template(AVFilterGraph *graphctx,
+                                   const AVFilterGraphTemplate *tmpl,
+                                   void *log_ctx);
+
+/**
+ * Free a filtergraph template and set *tmpl to NULL.
+ */
+void avfilter_graph_template_free(AVFilterGraphTemplate **tmpl);
+
 /**
  * Free a graph, destroy its links, and set *graph to NULL.
  * If *graph is NULL, do nothing.
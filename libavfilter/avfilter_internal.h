@@ -27,6 +27,8 @@
 
 #include <stdint.h>
 
+#include "libavutil/thread.h"
+
 #include "avfilter.h"
 #include "filters.h"
 #include "framequeue.h"
@@ -74,6 +76,14 @@ typedef struct FilterLinkInternal {
      */
     int frame_wanted_out;
 
+    /**
+     * True if a frame was requested on this link since its queue was last
+     * full. In pipeline threading mode, frames are only requested ahead on
+     * such links, so that frames pushed to a filter nobody pulls from are not
+     * produced in a loop.
+     */
+    int frame_requested;
+
     /**
      * Index in the age array.
      */
@@ -103,6 +113,23 @@ typedef struct FFFilterContext {
     // 1 when avfilter_init_*() was successfully called on this filter
     // 0 otherwise
     int initialized;
+
+    // index of the filter in the graph's filters array
+    unsigned graph_index;
+
+    // position in the graph's ready heap, -1 when the filter is not ready
+    int ready_index;
+
+    // 1 for a conversion filter inserted during the format negotiation
+    int auto_inserted;
+
+    // options of the filter when its graph was last configured, before
+    // configuring the filter could change them; compared by graph templates
+    char *config_opts;
+
+    // 1 while the filter is being activated by a pipeline thread,
+    // protected by FFFilterGraph.pipeline_lock
+    int running;
 } FFFilterContext;
 
 static inline FFFilterContext *fffilterctx(AVFilterContext *ctx)
@@ -118,6 +145,19 @@ typedef struct AVFilterCommand {
     struct AVFilterCommand *next;
 } AVFilterCommand;
 
+/**
+ * Slice jobs of a filter deferred to be run by bands of rows together with the
+ * jobs of the following filters, see AVFILTER_THREAD_ROWS.
+ */
+typedef struct FFRowsStage {
+    AVFilterContext      *ctx;
+    avfilter_action_func *func;
+    void                 *arg;
+    int                   nb_jobs;
+} FFRowsStage;
+
+#define FF_MAX_ROWS_STAGES 8
+
 typedef struct FFFilterGraph {
     /**
      * The public AVFilterGraph. See avfilter.h for it.
@@ -127,11 +167,41 @@ typedef struct FFFilterGraph {
     struct FilterLinkInternal **sink_links;
     int sink_links_count;
 
+    /**
+     * Filters with a non-zero ready value, as a heap ordered by decreasing
+     * ready value and then by increasing position in the filters array.
+     */
+    FFFilterContext **ready_heap;
+    int nb_ready;
+
     unsigned disable_auto_convert;
 
+    /**
+     * Set when the graph was configured with avfilter_graph_config_template(),
+     * which saves the options of the filters for templates.
+     */
+    int saved_filter_opts;
+
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /**
+     * Non-NULL when filters are activated concurrently with
+     * AVFILTER_THREAD_PIPELINE. The lock must then be held when accessing
+     * the ready values of the filters, the ready heap and the sink links heap.
+     */
+    void *pipeline;
+    AVMutex pipeline_lock;
+
+    /**
+     * Slice jobs deferred by the filters currently processing a frame with
+     * AVFILTER_THREAD_ROWS, from the first filter of the chain, and the filter
+     * whose filter_frame() callback is running.
+     */
+    FFRowsStage rows_stages[FF_MAX_ROWS_STAGES];
+    int      nb_rows_stages;
+    AVFilterContext *rows_filter;
 } FFFilterGraph;
 
 static inline FFFilterGraph *fffiltergraph(AVFilterGraph *graph)
@@ -145,6 +215,20 @@ static inline FFFilterGraph *fffiltergraph(AVFilterGraph *graph)
 void ff_avfilter_graph_update_heap(AVFilterGraph *graph,
                                    struct FilterLinkInternal *li);
 
+static inline int ff_filter_ready_higher(const FFFilterContext *a,
+                                         const FFFilterContext *b)
+{
+    if (a->p.ready != b->p.ready)
+        return a->p.ready > b->p.ready;
+    return a->graph_index < b->graph_index;
+}
+
+/**
+ * Update the position of a filter in the ready heap after its ready value
+ * changed.
+ */
+void ff_filter_graph_update_ready(AVFilterGraph *graph, AVFilterContext *filter);
+
 /**
  * Allocate a new filter context and return it.
  *
@@ -179,6 +263,17 @@ int ff_graph_thread_init(FFFilterGraph *graph);
 
 void ff_graph_thread_free(FFFilterGraph *graph);
 
+/**
+ * Activate the ready filters of a graph in pipeline threading mode, until
+ * none is left. Running until idle rather than one activation at a time is
+ * what lets filters run concurrently; the work done beyond what the caller
+ * waits for is bounded by the number of frames requested ahead on each link.
+ *
+ * @return 0 if some filters were activated, AVERROR(EAGAIN) if none was
+ *         ready, another negative error code if an activation failed
+ */
+int ff_graph_run_pipeline(FFFilterGraph *graph);
+
 /**
  * Negotiate the media format, dimensions, etc of all inputs to a filter.
  *
@@ -199,6 +294,10 @@ void ff_tlog_link(void *ctx, AVFilterLink *link, int end);
 
 /**
  * Run one round of processing on a filter graph.
+ *
+ * Without pipeline threading a round activates the ready filter with the
+ * highest priority. With it, a round activates ready filters concurrently
+ * until none is left, so a single call may produce several frames.
  */
 int ff_filter_graph_run_once(AVFilterGraph *graph);
 
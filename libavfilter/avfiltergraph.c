@@ -49,6 +49,8 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, .unit = "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "pipeline", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_PIPELINE }, .flags = F|V|A, .unit = "thread_type" },
+        { "rows",     NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_ROWS     }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, F|V|A, .unit = "threads"},
         {"auto", "autodetect a suitable number of threads to use", 0, AV_OPT_TYPE_CONST, {.i64 = 0 }, .flags = F|V|A, .unit = "threads"},
@@ -101,9 +103,18 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
     int i, j;
     for (i = 0; i < graph->nb_filters; i++) {
         if (graph->filters[i] == filter) {
+            if (filter->ready) {
+                filter->ready = 0;
+                ff_filter_graph_update_ready(graph, filter);
+            }
             FFSWAP(AVFilterContext*, graph->filters[i],
                    graph->filters[graph->nb_filters - 1]);
             graph->nb_filters--;
+            if (i < graph->nb_filters) {
+                fffilterctx(graph->filters[i])->graph_index = i;
+                if (graph->filters[i]->ready)
+                    ff_filter_graph_update_ready(graph, graph->filters[i]);
+            }
             filter->graph = NULL;
             for (j = 0; j<filter->nb_outputs; j++)
                 if (filter->outputs[j])
@@ -128,6 +139,7 @@ void avfilter_graph_free(AVFilterGraph **graphp)
     ff_graph_thread_free(graphi);
 
     av_freep(&graphi->sink_links);
+    av_freep(&graphi->ready_heap);
 
     av_opt_free(graph);
 
@@ -167,6 +179,7 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
                                              const char *name)
 {
     AVFilterContext **filters, *s;
+    FFFilterContext **ready_heap;
     FFFilterGraph *graphi = fffiltergraph(graph);
 
     if (graph->thread_type && !graphi->thread_execute) {
@@ -186,13 +199,22 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
         return NULL;
     graph->filters = filters;
 
+    ready_heap = av_realloc_array(graphi->ready_heap, graph->nb_filters + 1,
+                                  sizeof(*ready_heap));
+    if (!ready_heap)
+        return NULL;
+    graphi->ready_heap = ready_heap;
+
     s = ff_filter_alloc(filter, name);
     if (!s)
         return NULL;
 
+    fffilterctx(s)->graph_index = graph->nb_filters;
     graph->filters[graph->nb_filters++] = s;
 
     s->graph = graph;
+    if (s->ready)
+        ff_filter_graph_update_ready(graph, s);
 
     return s;
 }
@@ -537,6 +559,7 @@ static int query_formats(AVFilterGraph *graph, void *log_ctx)
                 ret = avfilter_graph_create_filter(&convert, filter, inst_name, opts, NULL, graph);
                 if (ret < 0)
                     return ret;
+                fffilterctx(convert)->auto_inserted = 1;
                 if ((ret = avfilter_insert_filter(link, convert, 0, 0)) < 0)
                     return ret;
 
@@ -1291,13 +1314,394 @@ static int graph_config_pointers(AVFilterGraph *graph, void *log_ctx)
     return 0;
 }
 
-int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
+typedef struct TemplateLink {
+    /* filter and output pad the link originally comes from, ignoring the
+     * conversion filters; only set for the inputs of the other filters */
+    unsigned src, srcpad;
+
+    enum AVMediaType type;
+    int format;
+    int sample_rate;
+    AVChannelLayout ch_layout;
+    enum AVColorSpace colorspace;
+    enum AVColorRange color_range;
+} TemplateLink;
+
+typedef struct TemplateFilter {
+    const AVFilter *filter;
+    unsigned nb_inputs, nb_outputs;
+    TemplateLink *inputs;
+
+    /* serialized private options, or creation options for a conversion filter */
+    char *opts;
+
+    /* conversion filters only: instance name, and the filter and input pad
+     * before which it was inserted */
+    char *name;
+    unsigned dst, dstpad;
+} TemplateFilter;
+
+struct AVFilterGraphTemplate {
+    TemplateFilter *filters;
+    unsigned nb_filters;
+    /* number of filters which are not conversion filters, those are stored
+     * first */
+    unsigned nb_user_filters;
+};
+
+/**
+ * Describe the values of the options of an object and of its children, as a
+ * string used to compare them. Floating point values are printed exactly,
+ * since av_opt_get() may round or fail on them.
+ *
+ * @return 0 on success, AVERROR(ENOSYS) if an option cannot be read
+ */
+static int serialize_opts(AVBPrint *bp, void *obj)
+{
+    const AVOption *o = NULL;
+    void *child = NULL;
+    int ret;
+
+    while ((o = av_opt_next(obj, o))) {
+        if (o->type == AV_OPT_TYPE_CONST)
+            continue;
+        if (o->type == AV_OPT_TYPE_DOUBLE || o->type == AV_OPT_TYPE_FLOAT) {
+            double d;
+            ret = av_opt_get_double(obj, o->name, 0, &d);
+            if (ret < 0)
+                return AVERROR(ENOSYS);
+            av_bprintf(bp, "%s=%a;", o->name, d);
+        } else {
+            uint8_t *val;
+            ret = av_opt_get(obj, o->name, 0, &val);
+            if (ret < 0)
+                return ret == AVERROR(ENOMEM) ? ret : AVERROR(ENOSYS);
+            /* prefix the value with its length so that it cannot be confused
+             * with the following options */
+            if (val)
+                av_bprintf(bp, "%s=%zu:%s;", o->name, strlen(val), val);
+            else
+                av_bprintf(bp, "%s;", o->name);
+            av_free(val);
+        }
+    }
+
+    /* e.g. the resampler of aresample, which holds most of its options */
+    while ((child = av_opt_child_next(obj, child))) {
+        av_bprintf(bp, "%s{", (*(const AVClass **)child)->class_name);
+        ret = serialize_opts(bp, child);
+        if (ret < 0)
+            return ret;
+        av_bprintf(bp, "}");
+    }
+
+    return 0;
+}
+
+static int serialize_filter_opts(AVFilterContext *filter, char **opts)
+{
+    AVBPrint bp;
+    int ret;
+
+    *opts = NULL;
+    if (!filter->filter->priv_class)
+        return 0;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    ret = serialize_opts(&bp, filter->priv);
+    if (ret < 0) {
+        av_bprint_finalize(&bp, NULL);
+        return ret;
+    }
+    return av_bprint_finalize(&bp, opts);
+}
+
+static const char *conversion_opts(AVFilterGraph *graph, AVFilterLink *link)
+{
+    const AVFilterNegotiation *neg = ff_filter_get_negotiation(link);
+    return FF_FIELD_AT(char *, neg->conversion_opts_offset, *graph);
+}
+
+void avfilter_graph_template_free(AVFilterGraphTemplate **ptmpl)
+{
+    AVFilterGraphTemplate *tmpl = *ptmpl;
+
+    if (!tmpl)
+        return;
+
+    for (unsigned i = 0; i < tmpl->nb_filters; i++) {
+        TemplateFilter *tf = &tmpl->filters[i];
+
+        for (unsigned j = 0; j < tf->nb_inputs && tf->inputs; j++)
+            av_channel_layout_uninit(&tf->inputs[j].ch_layout);
+        av_freep(&tf->inputs);
+        av_freep(&tf->opts);
+        av_freep(&tf->name);
+    }
+    av_freep(&tmpl->filters);
+    av_freep(ptmpl);
+}
+
+int avfilter_graph_template_create(AVFilterGraphTemplate **ptmpl,
+                                   const AVFilterGraph *graph)
+{
+    AVFilterGraphTemplate *tmpl;
+    int ret;
+
+    *ptmpl = NULL;
+
+    if (!fffiltergraph((AVFilterGraph *)graph)->saved_filter_opts) {
+        av_log((void *)graph, AV_LOG_ERROR, "The graph was not configured with "
+               "avfilter_graph_config_template().\n");
+        return AVERROR(EINVAL);
+    }
+
+    tmpl = av_mallocz(sizeof(*tmpl));
+    if (!tmpl)
+        return AVERROR(ENOMEM);
+    tmpl->filters = av_calloc(graph->nb_filters, sizeof(*tmpl->filters));
+    if (!tmpl->filters) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    tmpl->nb_filters = graph->nb_filters;
+
+    for (unsigned i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+        TemplateFilter     *tf  = &tmpl->filters[i];
+        int auto_inserted = fffilterctx(filter)->auto_inserted;
+
+        if (auto_inserted && !tmpl->nb_user_filters)
+            tmpl->nb_user_filters = i;
+        if (!auto_inserted && tmpl->nb_user_filters) {
+            av_log(filter, AV_LOG_ERROR, "Filter added after the "
+                   "configuration of the graph.\n");
+            ret = AVERROR(EINVAL);
+            goto fail;
+        }
+
+        tf->filter     = filter->filter;
+        tf->nb_outputs = filter->nb_outputs;
+        tf->inputs     = av_calloc(filter->nb_inputs, sizeof(*tf->inputs));
+        if (!tf->inputs && filter->nb_inputs) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        tf->nb_inputs  = filter->nb_inputs;
+
+        for (unsigned j = 0; j < filter->nb_inputs; j++) {
+            AVFilterLink *link = filter->inputs[j];
+            TemplateLink   *tl = &tf->inputs[j];
+
+            if (!link || link->format < 0) {
+                av_log(filter, AV_LOG_ERROR, "Input pad %d is not "
+                       "configured.\n", j);
+                ret = AVERROR(EINVAL);
+                goto fail;
+            }
+
+            tl->type        = link->type;
+            tl->format      = link->format;
+            tl->sample_rate = link->sample_rate;
+            tl->colorspace  = link->colorspace;
+            tl->color_range = link->color_range;
+            ret = av_channel_layout_copy(&tl->ch_layout, &link->ch_layout);
+            if (ret < 0)
+                goto fail;
+
+            if (auto_inserted)
+                continue;
+            if (fffilterctx(link->src)->auto_inserted)
+                link = link->src->inputs[0];
+            tl->src    = fffilterctx(link->src)->graph_index;
+            tl->srcpad = FF_OUTLINK_IDX(link);
+        }
+
+        if (auto_inserted) {
+            AVFilterLink *outlink = filter->outputs[0];
+            const char *opts = conversion_opts((AVFilterGraph *)graph, outlink);
+
+            tf->dst    = fffilterctx(outlink->dst)->graph_index;
+            tf->dstpad = FF_INLINK_IDX(outlink);
+            tf->name   = av_strdup(filter->name);
+            tf->opts   = opts ? av_strdup(opts) : NULL;
+            if (!tf->name || (opts && !tf->opts)) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        } else if (fffilterctx(filter)->config_opts) {
+            tf->opts = av_strdup(fffilterctx(filter)->config_opts);
+            if (!tf->opts) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        }
+    }
+    if (!tmpl->nb_user_filters)
+        tmpl->nb_user_filters = tmpl->nb_filters;
+
+    *ptmpl = tmpl;
+    return 0;
+
+fail:
+    avfilter_graph_template_free(&tmpl);
+    return ret;
+}
+
+/**
+ * Check that a graph that was not configured yet is made of the same filters
+ * as the graph a template was created from.
+ *
+ * @return 1 if it is, 0 if not
+ */
+static int template_matches(AVFilterGraph *graph,
+                            const AVFilterGraphTemplate *tmpl)
+{
+    if (graph->nb_filters != tmpl->nb_user_filters)
+        return 0;
+
+    for (unsigned i = 0; i < tmpl->nb_user_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+        const TemplateFilter *tf = &tmpl->filters[i];
+        const char *opts;
+
+        if (filter->filter    != tf->filter    ||
+            filter->nb_inputs  != tf->nb_inputs ||
+            filter->nb_outputs != tf->nb_outputs)
+            return 0;
+
+        /* the formats of hardware filters depend on their device, and some
+         * of them set up their device while querying formats */
+        if (filter->filter->flags_internal & FF_FILTER_FLAG_HWFRAME_AWARE)
+            return 0;
+
+        for (unsigned j = 0; j < filter->nb_inputs; j++) {
+            const AVFilterLink *link = filter->inputs[j];
+            const TemplateLink *tl   = &tf->inputs[j];
+
+            if (link->type != tl->type ||
+                fffilterctx(link->src)->graph_index != tl->src ||
+                FF_OUTLINK_IDX(link) != tl->srcpad)
+                return 0;
+        }
+
+        opts = fffilterctx(filter)->config_opts;
+        if ((filter->filter->priv_class && !opts) ||
+            !opts != !tf->opts || (opts && strcmp(opts, tf->opts)))
+            return 0;
+    }
+
+    for (unsigned i = tmpl->nb_user_filters; i < tmpl->nb_filters; i++) {
+        const TemplateFilter *tf = &tmpl->filters[i];
+        const char *opts = conversion_opts(graph,
+                                           graph->filters[tf->dst]->inputs[tf->dstpad]);
+
+        if (fffiltergraph(graph)->disable_auto_convert ||
+            !opts != !tf->opts || (opts && strcmp(opts, tf->opts)))
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Configure the formats of all the links in the graph from a template instead
+ * of negotiating them.
+ *
+ * @return 1 if the template was applied, 0 if it does not match the graph,
+ *         a negative error code on failure
+ */
+static int graph_config_formats_template(AVFilterGraph *graph,
+                                         const AVFilterGraphTemplate *tmpl,
+                                         void *log_ctx)
 {
     int ret;
 
+    ret = template_matches(graph, tmpl);
+    if (ret <= 0) {
+        if (!ret)
+            av_log(log_ctx, AV_LOG_VERBOSE, "The filters do not match the "
+                   "template, negotiating the formats.\n");
+        return ret;
+    }
+
+    for (unsigned i = tmpl->nb_user_filters; i < tmpl->nb_filters; i++) {
+        const TemplateFilter *tf = &tmpl->filters[i];
+        AVFilterContext *convert;
+
+        ret = avfilter_graph_create_filter(&convert, tf->filter, tf->name,
+                                           tf->opts, NULL, graph);
+        if (ret < 0)
+            return ret;
+        fffilterctx(convert)->auto_inserted = 1;
+        ret = avfilter_insert_filter(graph->filters[tf->dst]->inputs[tf->dstpad],
+                                     convert, 0, 0);
+        if (ret < 0)
+            return ret;
+    }
+
+    for (unsigned i = 0; i < tmpl->nb_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+        const TemplateFilter *tf = &tmpl->filters[i];
+
+        av_assert0(filter->filter == tf->filter &&
+                   filter->nb_inputs == tf->nb_inputs);
+        for (unsigned j = 0; j < filter->nb_inputs; j++) {
+            AVFilterLink *link = filter->inputs[j];
+            const TemplateLink *tl = &tf->inputs[j];
+
+            link->format      = tl->format;
+            link->sample_rate = tl->sample_rate;
+            link->colorspace  = tl->colorspace;
+            link->color_range = tl->color_range;
+            ret = av_channel_layout_copy(&link->ch_layout, &tl->ch_layout);
+            if (ret < 0)
+                return ret;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Save the options of the filters for graph templates, as configuring some
+ * filters changes them, e.g. aresample sets the negotiated formats on its
+ * resampler.
+ */
+static int graph_save_filter_opts(AVFilterGraph *graph)
+{
+    for (unsigned i = 0; i < graph->nb_filters; i++) {
+        FFFilterContext *ctxi = fffilterctx(graph->filters[i]);
+        int ret;
+
+        if (ctxi->auto_inserted)
+            continue;
+        av_freep(&ctxi->config_opts);
+        ret = serialize_filter_opts(&ctxi->p, &ctxi->config_opts);
+        /* options that cannot be read just prevent using templates */
+        if (ret < 0 && ret != AVERROR(ENOSYS))
+            return ret;
+    }
+    return 0;
+}
+
+static int graph_config(AVFilterGraph *graphctx, int use_templates,
+                        const AVFilterGraphTemplate *tmpl, void *log_ctx)
+{
+    int ret, templated = 0;
+
     if ((ret = graph_check_validity(graphctx, log_ctx)))
         return ret;
-    if ((ret = graph_config_formats(graphctx, log_ctx)))
+    /* only graphs used with templates pay for serializing the options */
+    fffiltergraph(graphctx)->saved_filter_opts = 0;
+    if (use_templates) {
+        if ((ret = graph_save_filter_opts(graphctx)) < 0)
+            return ret;
+        fffiltergraph(graphctx)->saved_filter_opts = 1;
+    }
+    if (tmpl && (templated = graph_config_formats_template(graphctx, tmpl, log_ctx)) < 0)
+        return templated;
+    if (!templated && (ret = graph_config_formats(graphctx, log_ctx)))
         return ret;
     if ((ret = graph_config_links(graphctx, log_ctx)))
         return ret;
@@ -1306,7 +1710,19 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
     if ((ret = graph_config_pointers(graphctx, log_ctx)))
         return ret;
 
-    return 0;
+    return templated;
+}
+
+int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
+{
+    return graph_config(graphctx, 0, NULL, log_ctx);
+}
+
+int avfilter_graph_config_template(AVFilterGraph *graphctx,
+                                   const AVFilterGraphTemplate *tmpl,
+                                   void *log_ctx)
+{
+    return graph_config(graphctx, 1, tmpl, log_ctx);
 }
 
 int avfilter_graph_send_command(AVFilterGraph *graph, const char *target, const char *cmd, const char *arg, char *res, int res_len, int flags)
@@ -1468,17 +1884,80 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
+static void ready_bubble_up(FFFilterGraph *graph,
+                            FFFilterContext *ctx, int index)
+{
+    FFFilterContext **heap = graph->ready_heap;
+
+    while (index) {
+        int parent = (index - 1) >> 1;
+        if (!ff_filter_ready_higher(ctx, heap[parent]))
+            break;
+        heap[index] = heap[parent];
+        heap[index]->ready_index = index;
+        index = parent;
+    }
+    heap[index] = ctx;
+    ctx->ready_index = index;
+}
+
+static void ready_bubble_down(FFFilterGraph *graph,
+                              FFFilterContext *ctx, int index)
+{
+    FFFilterContext **heap = graph->ready_heap;
+
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= graph->nb_ready)
+            break;
+        if (child + 1 < graph->nb_ready &&
+            ff_filter_ready_higher(heap[child + 1], heap[child]))
+            child++;
+        if (!ff_filter_ready_higher(heap[child], ctx))
+            break;
+        heap[index] = heap[child];
+        heap[index]->ready_index = index;
+        index = child;
+    }
+    heap[index] = ctx;
+    ctx->ready_index = index;
+}
+
+void ff_filter_graph_update_ready(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    FFFilterGraph   *graphi = fffiltergraph(graph);
+    FFFilterContext *ctx    = fffilterctx(filter);
+    int index = ctx->ready_index;
+
+    if (!filter->ready) {
+        if (index < 0)
+            return;
+        ctx->ready_index = -1;
+        if (index < --graphi->nb_ready) {
+            FFFilterContext *last = graphi->ready_heap[graphi->nb_ready];
+            ready_bubble_up  (graphi, last, index);
+            ready_bubble_down(graphi, last, last->ready_index);
+        }
+        return;
+    }
+
+    if (index < 0) {
+        av_assert1(graphi->nb_ready < graph->nb_filters);
+        index = graphi->nb_ready++;
+    }
+    ready_bubble_up  (graphi, ctx, index);
+    ready_bubble_down(graphi, ctx, ctx->ready_index);
+}
+
 int ff_filter_graph_run_once(AVFilterGraph *graph)
 {
-    AVFilterContext *filter;
-    unsigned i;
+    FFFilterGraph *graphi = fffiltergraph(graph);
 
     av_assert0(graph->nb_filters);
-    filter = graph->filters[0];
-    for (i = 1; i < graph->nb_filters; i++)
-        if (graph->filters[i]->ready > filter->ready)
-            filter = graph->filters[i];
-    if (!filter->ready)
+    if (graphi->pipeline)
+        return ff_graph_run_pipeline(graphi);
+    if (!graphi->nb_ready)
         return AVERROR(EAGAIN);
-    return ff_filter_activate(filter);
+    av_assert1(graphi->ready_heap[0]->p.ready);
+    return ff_filter_activate(&graphi->ready_heap[0]->p);
 }
@@ -568,6 +568,7 @@ const AVFilter ff_vsrc_buffer = {
     .activate  = activate,
     .init      = init_video,
     .uninit    = uninit,
+    .flags_internal = FF_FILTER_FLAG_EXTERNAL_SOURCE,
 
     .inputs    = NULL,
     FILTER_OUTPUTS(avfilter_vsrc_buffer_outputs),
@@ -590,6 +591,7 @@ const AVFilter ff_asrc_abuffer = {
     .activate  = activate,
     .init      = init_audio,
     .uninit    = uninit,
+    .flags_internal = FF_FILTER_FLAG_EXTERNAL_SOURCE,
 
     .inputs    = NULL,
     FILTER_OUTPUTS(avfilter_asrc_abuffer_outputs),
@@ -608,6 +608,7 @@ const AVFilter ff_vf_sendcmd = {
     .init        = init,
     .uninit      = uninit,
     .priv_size   = sizeof(SendCmdContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_ACCESS,
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
     FILTER_INPUTS(sendcmd_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
@@ -633,6 +634,7 @@ const AVFilter ff_af_asendcmd = {
     .init        = init,
     .uninit      = uninit,
     .priv_size   = sizeof(SendCmdContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_ACCESS,
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
     FILTER_INPUTS(asendcmd_inputs),
     FILTER_OUTPUTS(ff_audio_default_filterpad),
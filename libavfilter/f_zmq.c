@@ -223,6 +223,7 @@ const AVFilter ff_vf_zmq = {
     .init        = init,
     .uninit      = uninit,
     .priv_size   = sizeof(ZMQContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_ACCESS,
     FILTER_INPUTS(zmq_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     .priv_class  = &zmq_class,
@@ -247,6 +248,7 @@ const AVFilter ff_af_azmq = {
     .init        = init,
     .uninit      = uninit,
     .priv_size   = sizeof(ZMQContext),
+    .flags_internal = FF_FILTER_FLAG_GRAPH_ACCESS,
     FILTER_INPUTS(azmq_inputs),
     FILTER_OUTPUTS(ff_audio_default_filterpad),
 };
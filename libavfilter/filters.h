@@ -205,6 +205,37 @@ static inline FilterLink* ff_filter_link(AVFilterLink *link)
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses other filters of its graph, e.g. to send them commands,
+ * and must not be activated concurrently with any of them.
+ */
+#define FF_FILTER_FLAG_GRAPH_ACCESS (1 << 1)
+
+/**
+ * The filter can process frames by bands of rows together with the adjacent
+ * filters, see AVFILTER_THREAD_ROWS. This requires that:
+ * - the filter has one video input and one video output of the same height;
+ * - the pixel data of a frame is only accessed by the jobs of a single
+ *   ff_filter_execute() call, made from the filter_frame() callback without
+ *   per-job return values; the frame is then sent with ff_filter_frame(),
+ *   without being accessed in between, and the input frame is only freed
+ *   after that: with row threading, the jobs only run once the frame is sent
+ *   and still read the input until ff_filter_frame() returns;
+ * - job jobnr out of nb_jobs only accesses the rows from
+ *   (h * jobnr) / nb_jobs to (h * (jobnr + 1)) / nb_jobs of every plane of
+ *   height h, including when nb_jobs is larger than the number of threads;
+ *   the framework only uses values of nb_jobs such that the planes are split
+ *   in bands of an even number of rows.
+ */
+#define FF_FILTER_FLAG_SLICE_ROWS (1 << 2)
+
+/**
+ * The filter only outputs the frames pushed into it by the caller, like
+ * buffersrc, so requesting frames from it does not make it produce them any
+ * sooner.
+ */
+#define FF_FILTER_FLAG_EXTERNAL_SOURCE (1 << 3)
+
 /**
  * Find the index of a link.
  *
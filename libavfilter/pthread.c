@@ -27,21 +27,48 @@
 #include "libavutil/macros.h"
 #include "libavutil/mem.h"
 #include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
 
 #include "avfilter.h"
 #include "avfilter_internal.h"
+#include "filters.h"
+#include "framequeue.h"
+
+/**
+ * Number of frames requested ahead on each link in pipeline threading mode.
+ */
+#define PIPELINE_QUEUE_SIZE 2
 
 typedef struct ThreadContext {
     AVFilterGraph *graph;
     AVSliceThread *thread;
     avfilter_action_func *func;
 
+    /* serializes the execute calls of filters running concurrently */
+    AVMutex execute_lock;
+
     /* per-execute parameters */
     AVFilterContext *ctx;
     void *arg;
     int   *rets;
 } ThreadContext;
 
+typedef struct PipelineContext {
+    FFFilterGraph *graph;
+    AVSliceThread *thread;
+    int nb_threads;
+
+    /* signalled whenever an activation finishes, uses graph->pipeline_lock */
+    AVCond cond;
+    int nb_running;
+    /* a filter not allowing pipeline threading is running */
+    int exclusive;
+
+    /* per-run state */
+    int nb_activated;
+    int err;
+} PipelineContext;
+
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
 {
     ThreadContext *c = priv;
@@ -53,6 +80,7 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    ff_mutex_destroy(&c->execute_lock);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -62,20 +90,197 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
 
     if (nb_jobs <= 0)
         return 0;
+    ff_mutex_lock(&c->execute_lock);
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
     avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+    ff_mutex_unlock(&c->execute_lock);
+    return 0;
+}
+
+static int filter_runnable(const PipelineContext *p, const FFFilterContext *ctxi)
+{
+    const AVFilterContext *ctx = &ctxi->p;
+
+    if (ctxi->running || p->exclusive)
+        return 0;
+    if (!(ctx->thread_type & AVFILTER_THREAD_PIPELINE))
+        return !p->nb_running;
+
+    /* the state of a link is shared by the filters on both of its ends */
+    for (unsigned i = 0; i < ctx->nb_inputs; i++)
+        if (ctx->inputs[i] && fffilterctx(ctx->inputs[i]->src)->running)
+            return 0;
+    for (unsigned i = 0; i < ctx->nb_outputs; i++)
+        if (ctx->outputs[i] && fffilterctx(ctx->outputs[i]->dst)->running)
+            return 0;
+    return 1;
+}
+
+static FFFilterContext *pick_filter(const PipelineContext *p)
+{
+    const FFFilterGraph *graph = p->graph;
+    FFFilterContext *best = NULL;
+
+    if (graph->nb_ready && filter_runnable(p, graph->ready_heap[0]))
+        return graph->ready_heap[0];
+
+    for (int i = 1; i < graph->nb_ready; i++) {
+        FFFilterContext *ctxi = graph->ready_heap[i];
+        if (filter_runnable(p, ctxi) &&
+            (!best || ff_filter_ready_higher(ctxi, best)))
+            best = ctxi;
+    }
+    return best;
+}
+
+/**
+ * Request a frame on a link that does not have enough of them queued, so that
+ * its source filter can work ahead of its destination. Once the queue is full
+ * the link waits for its destination to request a frame again, so a link it
+ * stopped pulling from does not stay requested.
+ *
+ * Sources only outputting the frames pushed by the caller are not requested
+ * from ahead: it would not make the frames come sooner, and buffersrc reports
+ * the requests it could not satisfy to the caller, e.g. for ffmpeg to choose
+ * the input to read from.
+ */
+static void request_ahead(AVFilterLink *link)
+{
+    FilterLinkInternal *li = ff_link_internal(link);
+
+    if (!li->frame_requested || li->frame_wanted_out ||
+        li->status_in || li->status_out ||
+        link->src->filter->flags_internal & FF_FILTER_FLAG_EXTERNAL_SOURCE)
+        return;
+    if (ff_framequeue_queued_frames(&li->fifo) < PIPELINE_QUEUE_SIZE)
+        ff_inlink_request_frame(link);
+    else
+        li->frame_requested = 0;
+}
+
+static void pipeline_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    PipelineContext *p = priv;
+    FFFilterGraph *graph = p->graph;
+
+    ff_mutex_lock(&graph->pipeline_lock);
+    while (!p->err) {
+        FFFilterContext *ctxi = pick_filter(p);
+        AVFilterContext *ctx;
+        int exclusive, ret;
+
+        if (!ctxi) {
+            if (!p->nb_running)
+                break;
+            ff_cond_wait(&p->cond, &graph->pipeline_lock);
+            continue;
+        }
+
+        ctx       = &ctxi->p;
+        exclusive = !(ctx->thread_type & AVFILTER_THREAD_PIPELINE);
+        ctxi->running = 1;
+        p->exclusive  = exclusive;
+        p->nb_running++;
+        p->nb_activated++;
+        ff_mutex_unlock(&graph->pipeline_lock);
+
+        ret = ff_filter_activate(ctx);
+        if (ret >= 0) {
+            for (unsigned i = 0; i < ctx->nb_inputs; i++)
+                request_ahead(ctx->inputs[i]);
+            for (unsigned i = 0; i < ctx->nb_outputs; i++)
+                request_ahead(ctx->outputs[i]);
+        }
+
+        ff_mutex_lock(&graph->pipeline_lock);
+        ctxi->running = 0;
+        if (exclusive)
+            p->exclusive = 0;
+        p->nb_running--;
+        if (ret < 0 && !p->err)
+            p->err = ret;
+        ff_cond_broadcast(&p->cond);
+    }
+    ff_mutex_unlock(&graph->pipeline_lock);
+}
+
+int ff_graph_run_pipeline(FFFilterGraph *graph)
+{
+    PipelineContext *p = graph->pipeline;
+
+    if (!graph->nb_ready)
+        return AVERROR(EAGAIN);
+
+    p->nb_activated = 0;
+    p->err          = 0;
+    avpriv_slicethread_execute(p->thread, p->nb_threads, 0);
+
+    if (p->err)
+        return p->err;
+    return p->nb_activated ? 0 : AVERROR(EAGAIN);
+}
+
+static void pipeline_uninit(FFFilterGraph *graph)
+{
+    PipelineContext *p = graph->pipeline;
+
+    if (!p)
+        return;
+    avpriv_slicethread_free(&p->thread);
+    ff_cond_destroy(&p->cond);
+    ff_mutex_destroy(&graph->pipeline_lock);
+    av_freep(&graph->pipeline);
+}
+
+static int pipeline_init(FFFilterGraph *graph, int nb_threads)
+{
+    PipelineContext *p;
+    int ret;
+
+    p = av_mallocz(sizeof(*p));
+    if (!p)
+        return AVERROR(ENOMEM);
+    p->graph = graph;
+
+    ret = ff_mutex_init(&graph->pipeline_lock, NULL);
+    if (ret) {
+        av_free(p);
+        return AVERROR(ret);
+    }
+    ret = ff_cond_init(&p->cond, NULL);
+    if (ret) {
+        ff_mutex_destroy(&graph->pipeline_lock);
+        av_free(p);
+        return AVERROR(ret);
+    }
+    graph->pipeline = p;
+
+    /* the workers wait for each other, so they cannot use the shared pool */
+    ret = avpriv_slicethread_create_private(&p->thread, p, pipeline_worker, NULL, nb_threads);
+    if (ret <= 1) {
+        pipeline_uninit(graph);
+        return FFMIN(ret, 0);
+    }
+    p->nb_threads = ret;
+
     return 0;
 }
 
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
+    int ret = ff_mutex_init(&c->execute_lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+
     nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
-    if (nb_threads <= 1)
+    if (nb_threads <= 1) {
         avpriv_slicethread_free(&c->thread);
+        ff_mutex_destroy(&c->execute_lock);
+    }
     return FFMAX(nb_threads, 1);
 }
 
@@ -104,11 +309,15 @@ int ff_graph_thread_init(FFFilterGraph *graphi)
 
     graphi->thread_execute = thread_execute;
 
+    if (graph->thread_type & AVFILTER_THREAD_PIPELINE)
+        return pipeline_init(graphi, graph->nb_threads);
+
     return 0;
 }
 
 void ff_graph_thread_free(FFFilterGraph *graph)
 {
+    pipeline_uninit(graph);
     if (graph->thread)
         slice_thread_uninit(graph->thread);
     av_freep(&graph->thread);
@@ -0,0 +1,180 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/samplefmt.h"
+
+#include "libavfilter/af_afir.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+
+#define INPUT "sine=f=440:r=8000:d=1:samples_per_frame=512"
+#define IR    "aevalsrc=exp(-40*t)*sin(2*PI*1000*t):s=8000:d=0.25"
+
+typedef struct Output {
+    float *samples;
+    int nb_samples;
+} Output;
+
+static int drain(AVFilterContext *sink, AVFrame *frame, Output *out)
+{
+    int ret;
+
+    while ((ret = av_buffersink_get_frame_flags(sink, frame,
+                                                AV_BUFFERSINK_FLAG_NO_REQUEST)) >= 0) {
+        float *samples;
+
+        if (frame->format != AV_SAMPLE_FMT_FLTP) {
+            av_frame_unref(frame);
+            return AVERROR(EINVAL);
+        }
+        samples = av_realloc_array(out->samples, out->nb_samples + frame->nb_samples,
+                                   sizeof(*samples));
+        if (!samples) {
+            av_frame_unref(frame);
+            return AVERROR(ENOMEM);
+        }
+        memcpy(samples + out->nb_samples, frame->extended_data[0],
+               frame->nb_samples * sizeof(*samples));
+        out->samples     = samples;
+        out->nb_samples += frame->nb_samples;
+        av_frame_unref(frame);
+    }
+
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+/* Filter the same input and IR through two afir instances of one graph. */
+static int run(const char *opts0, const char *opts1, Output out[2], int *shared)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterInOut *inputs = NULL, *outputs = NULL;
+    AVFrame *frame = av_frame_alloc();
+    AVFilterContext *sinks[2];
+    char desc[512];
+    int ret;
+
+    memset(out, 0, 2 * sizeof(*out));
+    if (!graph || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    snprintf(desc, sizeof(desc),
+             INPUT ",asplit[a][b];" IR ",asplit[ir0][ir1];"
+             "[a][ir0]afir@fir0=precision=float:%s,abuffersink@out0;"
+             "[b][ir1]afir@fir1=precision=float:%s,abuffersink@out1",
+             opts0, opts1);
+    ret = avfilter_graph_parse_ptr(graph, desc, &inputs, &outputs, NULL);
+    if (ret < 0)
+        goto end;
+    ret = avfilter_graph_config(graph, NULL);
+    if (ret < 0)
+        goto end;
+
+    sinks[0] = avfilter_graph_get_filter(graph, "abuffersink@out0");
+    sinks[1] = avfilter_graph_get_filter(graph, "abuffersink@out1");
+
+    do {
+        ret = avfilter_graph_request_oldest(graph);
+        if (ret < 0 && ret != AVERROR_EOF)
+            goto end;
+        for (int i = 0; i < 2; i++) {
+            int err = drain(sinks[i], frame, &out[i]);
+            if (err < 0) {
+                ret = err;
+                goto end;
+            }
+        }
+    } while (ret != AVERROR_EOF);
+    ret = 0;
+
+    *shared = ff_afir_coeffs_shared(avfilter_graph_get_filter(graph, "afir@fir0"),
+                                    avfilter_graph_get_filter(graph, "afir@fir1"));
+
+end:
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    av_frame_free(&frame);
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+/* Largest difference between the outputs, relative to the largest sample. */
+static double difference(const Output out[2])
+{
+    double peak = 0, diff = 0;
+
+    if (out[0].nb_samples != out[1].nb_samples || !out[0].nb_samples)
+        return INFINITY;
+
+    for (int i = 0; i < out[0].nb_samples; i++) {
+        peak = fmax(peak, fabs(out[0].samples[i]));
+        diff = fmax(diff, fabs(out[0].samples[i] - out[1].samples[i]));
+    }
+
+    return peak ? diff / peak : INFINITY;
+}
+
+static int test(const char *opts0, const char *opts1, double tolerance,
+                int expect_shared)
+{
+    Output out[2];
+    double diff;
+    int shared, ret;
+
+    ret = run(opts0, opts1, out, &shared);
+    printf("%s | %s: ", opts0, opts1);
+    if (ret < 0) {
+        printf("%s\n", ret == AVERROR(EINVAL) ? "rejected" : "failed");
+    } else {
+        diff = difference(out);
+        printf("%d samples, coefficients %s, outputs %s\n",
+               out[0].nb_samples, shared ? "shared" : "not shared",
+               diff > tolerance ? "differ" : tolerance ? "match" : "identical");
+        ret = diff <= tolerance && shared == expect_shared ? 0 : -1;
+    }
+
+    av_freep(&out[0].samples);
+    av_freep(&out[1].samples);
+    return ret;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    av_log_set_level(AV_LOG_QUIET);
+
+    // the second instance reuses the spectra computed by the first one
+    ret |= test("minp=16:maxp=1024", "minp=16:maxp=1024", 0, 1) < 0;
+    // different partitionings compute their own spectra
+    ret |= test("minp=16:maxp=1024", "minp=16:maxp=1024:growth=4", 1e-4, 0) < 0;
+    ret |= test("minp=16:maxp=1024", "minp=16:maxp=1024:growth=16", 1e-4, 0) < 0;
+    ret |= test("minp=64:maxp=64",   "minp=64:maxp=64:growth=8", 0, 0) < 0;
+    ret |= test("minp=16:maxp=1024", "minp=16:maxp=1024:growth=3", 0, 0) != AVERROR(EINVAL);
+
+    return ret;
+}
@@ -0,0 +1,155 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/samplefmt.h"
+
+#include "libavfilter/avfilter.h"
+
+static void print_links(const AVFilterGraph *graph)
+{
+    for (unsigned i = 0; i < graph->nb_filters; i++) {
+        const AVFilterContext *filter = graph->filters[i];
+
+        for (unsigned j = 0; j < filter->nb_inputs; j++) {
+            const AVFilterLink *link = filter->inputs[j];
+
+            printf("  %s -> %s[%u]: ", link->src->name, filter->name, j);
+            if (link->type == AVMEDIA_TYPE_VIDEO) {
+                printf("%s %dx%d %s %s\n", av_get_pix_fmt_name(link->format),
+                       link->w, link->h,
+                       av_color_space_name(link->colorspace),
+                       av_color_range_name(link->color_range));
+            } else {
+                char buf[128];
+                av_channel_layout_describe(&link->ch_layout, buf, sizeof(buf));
+                printf("%s %dHz %s\n", av_get_sample_fmt_name(link->format),
+                       link->sample_rate, buf);
+            }
+        }
+    }
+}
+
+static int configure(const char *desc, const AVFilterGraphTemplate *tmpl,
+                     AVFilterGraph **graph)
+{
+    AVFilterInOut *inputs = NULL, *outputs = NULL;
+    int ret;
+
+    *graph = avfilter_graph_alloc();
+    if (!*graph)
+        return AVERROR(ENOMEM);
+
+    ret = avfilter_graph_parse_ptr(*graph, desc, &inputs, &outputs, NULL);
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    if (ret < 0)
+        return ret;
+
+    ret = avfilter_graph_config_template(*graph, tmpl, NULL);
+    printf("%s: %d\n", tmpl ? "template" : "negotiated", ret);
+    if (ret >= 0)
+        print_links(*graph);
+    return ret;
+}
+
+static int test(const char *desc, const char *other_desc)
+{
+    AVFilterGraphTemplate *tmpl = NULL;
+    AVFilterGraph *graph = NULL;
+    int ret;
+
+    printf("%s\n", desc);
+
+    ret = configure(desc, NULL, &graph);
+    if (ret < 0)
+        goto end;
+    ret = avfilter_graph_template_create(&tmpl, graph);
+    if (ret < 0)
+        goto end;
+    avfilter_graph_free(&graph);
+
+    /* the same graph again, configured from the template */
+    ret = configure(desc, tmpl, &graph);
+    if (ret < 0)
+        goto end;
+    avfilter_graph_free(&graph);
+
+    /* a graph that does not match the template */
+    printf("%s\n", other_desc);
+    ret = configure(other_desc, tmpl, &graph);
+
+end:
+    if (ret < 0)
+        printf("error: %s\n", av_err2str(ret));
+    avfilter_graph_template_free(&tmpl);
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+/* the options of the filters are only saved for templates on request */
+static int test_no_template(const char *desc)
+{
+    AVFilterGraphTemplate *tmpl = NULL;
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    int ret;
+
+    if (!graph)
+        return AVERROR(ENOMEM);
+
+    ret = avfilter_graph_parse_ptr(graph, desc, NULL, NULL, NULL);
+    if (ret >= 0)
+        ret = avfilter_graph_config(graph, NULL);
+    if (ret >= 0) {
+        ret = avfilter_graph_template_create(&tmpl, graph);
+        printf("template of a graph configured without templates: %s\n",
+               ret == AVERROR(EINVAL) ? "rejected" : "created");
+        ret = ret == AVERROR(EINVAL) ? 0 : -1;
+    }
+
+    avfilter_graph_template_free(&tmpl);
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(void)
+{
+    static const char *const graphs[][2] = {
+        { "testsrc2=s=64x48,format=rgb24,format=yuv420p,scale=32x24,nullsink",
+          "testsrc2=s=64x48,format=rgb24,format=gray,scale=32x24,nullsink" },
+        { "sine=r=44100,aformat=s16,aformat=fltp:48000:stereo,anullsink",
+          "sine=r=44100,aformat=s16,aformat=fltp:48000:mono,anullsink" },
+        { "sine=r=8000[a];sine=r=8000[b];[a]aformat=cl=mono[am];"
+          "[b]aformat=cl=FL+FR[bm];[am][bm]amerge,anullsink",
+          "sine=r=8000[a];sine=r=8000[b];[a]aformat=cl=FC[am];"
+          "[b]aformat=cl=FL+FR[bm];[bm][am]amerge,anullsink" },
+        /* options of the resampler are options of a child of the filter */
+        { "sine=r=44100,aresample=osf=s16:osr=48000,anullsink",
+          "sine=r=44100,aresample=osf=flt:osr=48000,anullsink" },
+    };
+    int ret = 0;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(graphs); i++)
+        ret |= test(graphs[i][0], graphs[i][1]) < 0;
+    ret |= test_no_template(graphs[0][0]) < 0;
+
+    return ret;
+}
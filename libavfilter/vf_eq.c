@@ -218,6 +218,44 @@ static const enum AVPixelFormat pixel_fmts_eq[] = {
     AV_PIX_FMT_NONE
 };
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EQContext *eq = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(in->format);
+
+    for (int i = 0; i < desc->nb_components; i++) {
+        int w = in->width;
+        int h = in->height;
+        int slice_start, slice_end;
+        uint8_t *dst;
+        const uint8_t *src;
+
+        if (i == 1 || i == 2) {
+            w = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
+            h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
+        }
+        slice_start = (h *  jobnr   ) / nb_jobs;
+        slice_end   = (h * (jobnr+1)) / nb_jobs;
+        dst = out->data[i] + slice_start * out->linesize[i];
+        src =  in->data[i] + slice_start *  in->linesize[i];
+
+        if (i == 3 || !eq->param[i].adjust)
+            av_image_copy_plane(dst, out->linesize[i], src, in->linesize[i],
+                                w, slice_end - slice_start);
+        else
+            eq->param[i].adjust(&eq->param[i], dst, out->linesize[i],
+                                 src, in->linesize[i], w, slice_end - slice_start);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     FilterLink *inl = ff_filter_link(inlink);
@@ -226,7 +264,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     EQContext *eq = ctx->priv;
     AVFrame *out;
     const AVPixFmtDescriptor *desc;
-    int i;
+    ThreadData td;
+    int i, ret;
 
     out = ff_get_video_buffer(outlink, inlink->w, inlink->h);
     if (!out) {
@@ -255,26 +294,20 @@ FF_ENABLE_DEPRECATION_WARNINGS
         set_saturation(eq);
     }
 
-    for (i = 0; i < desc->nb_components; i++) {
-        int w = inlink->w;
-        int h = inlink->h;
+    /* the tables must not be built concurrently by the slices */
+    for (i = 0; i < 3; i++)
+        if (eq->param[i].adjust == apply_lut && !eq->param[i].lut_clean)
+            create_lut(&eq->param[i]);
 
-        if (i == 1 || i == 2) {
-            w = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
-            h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
-        }
-
-        if (i == 3 || !eq->param[i].adjust)
-            av_image_copy_plane(out->data[i], out->linesize[i],
-                                in->data[i], in->linesize[i], w, h);
-
-        else
-            eq->param[i].adjust(&eq->param[i], out->data[i], out->linesize[i],
-                                 in->data[i], in->linesize[i], w, h);
-    }
+    td.in  = in;
+    td.out = out;
+    ff_filter_execute(ctx, filter_slice, &td, NULL,
+                      FFMIN(AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h),
+                            ff_filter_get_nb_threads(ctx)));
 
+    ret = ff_filter_frame(outlink, out);
     av_frame_free(&in);
-    return ff_filter_frame(outlink, out);
+    return ret;
 }
 
 static inline int set_param(AVExpr **pexpr, const char *args, const char *cmd,
@@ -356,5 +389,6 @@ const AVFilter ff_vf_eq = {
     .process_command = process_command,
     .init            = initialize,
     .uninit          = uninit,
-    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags           = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
+    .flags_internal  = FF_FILTER_FLAG_SLICE_ROWS,
 };
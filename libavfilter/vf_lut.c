@@ -502,7 +502,7 @@ static int lut_planar_8bits(AVFilterContext *ctx, void *arg, int jobnr, int nb_j
 }
 
 #define PACKED_THREAD_DATA\
- struct thread_data td = {\
+        td = (struct thread_data) {\
             .in  = in,\
             .out = out,\
             .w   = inlink->w,\
@@ -510,7 +510,7 @@ static int lut_planar_8bits(AVFilterContext *ctx, void *arg, int jobnr, int nb_j
         };\
 
 #define PLANAR_THREAD_DATA\
- struct thread_data td = {\
+        td = (struct thread_data) {\
             .in  = in,\
             .out = out,\
             .w   = inlink->w,\
@@ -522,8 +522,9 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     AVFilterContext *ctx = inlink->dst;
     LutContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
+    struct thread_data td;
     AVFrame *out;
-    int direct = 0;
+    int direct = 0, ret;
 
     if (av_frame_is_writable(in)) {
         direct = 1;
@@ -559,10 +560,11 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
                           FFMIN(in->height, ff_filter_get_nb_threads(ctx)));
     }
 
+    ret = ff_filter_frame(outlink, out);
     if (!direct)
         av_frame_free(&in);
 
-    return ff_filter_frame(outlink, out);
+    return ret;
 }
 
 static int process_command(AVFilterContext *ctx, const char *cmd, const char *args,
@@ -597,6 +599,7 @@ static const AVFilterPad inputs[] = {
         FILTER_QUERY_FUNC(query_formats),                               \
         .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC |       \
                          AVFILTER_FLAG_SLICE_THREADS,                   \
+        .flags_internal = FF_FILTER_FLAG_SLICE_ROWS,                    \
         .process_command = process_command,                             \
     }
 
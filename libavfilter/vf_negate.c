@@ -307,6 +307,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     AVFilterLink *outlink = ctx->outputs[0];
     ThreadData td;
     AVFrame *out;
+    int ret;
 
     if (av_frame_is_writable(in)) {
         out = in;
@@ -323,10 +324,11 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     td.in = in;
     ff_filter_execute(ctx, filter_slice, &td, NULL,
                       FFMIN(s->height[2], ff_filter_get_nb_threads(ctx)));
+    ret = ff_filter_frame(outlink, out);
     if (out != in)
         av_frame_free(&in);
 
-    return ff_filter_frame(outlink, out);
+    return ret;
 }
 
 static int process_command(AVFilterContext *ctx, const char *cmd, const char *args,
@@ -364,5 +366,6 @@ const AVFilter ff_vf_negate = {
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
     .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
+    .flags_internal = FF_FILTER_FLAG_SLICE_ROWS,
     .process_command = process_command,
 };
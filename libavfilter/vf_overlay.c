@@ -347,10 +347,6 @@ static int config_output(AVFilterLink *outlink)
     return ff_framesync_configure(&s->fs);
 }
 
-// divide by 255 and round to nearest
-// apply a fast variant: (X+127)/255 = ((X+127)*257+257)>>16 = ((X+128)*257)>>16
-#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
-
 // calculate the unpremultiplied alpha, applying the general equation:
 // alpha = alpha_overlay / ( (alpha_main + alpha_overlay) - (alpha_main * alpha_overlay) )
 // (((x) << 16) - ((x) << 9) + (x)) is a faster version of: 255 * 255 * x
@@ -500,7 +496,7 @@ static av_always_inline void blend_plane_##depth##_##nbits##bits(AVFilterContext
         da = dap + ((xp+k) << hsub);                                                                       \
         kmax = FFMIN(-xp + dst_wp, src_wp);                                                                \
                                                                                                            \
-        if (nbits == 8 && ((vsub && j+1 < src_hp) || !vsub) && octx->blend_row[i]) {                       \
+        if (((vsub && j+1 < src_hp) || !vsub) && octx->blend_row[i]) {                                     \
             int c = octx->blend_row[i]((uint8_t*)d, (uint8_t*)da, (uint8_t*)s,                             \
                     (uint8_t*)a, kmax - k, src->linesize[3]);                                              \
                                                                                                            \
@@ -867,10 +863,8 @@ static int config_input_main(AVFilterLink *inlink)
     }
 
 end:
-#if ARCH_X86
-    ff_overlay_init_x86(s, s->format, inlink->format,
-                        s->alpha_format, s->main_has_alpha);
-#endif
+    ff_overlay_init(s, s->format, inlink->format,
+                    s->alpha_format, s->main_has_alpha);
 
     return 0;
 }
@@ -19,6 +19,8 @@
 #ifndef AVFILTER_OVERLAY_H
 #define AVFILTER_OVERLAY_H
 
+#include <stdint.h>
+
 #include "libavutil/eval.h"
 #include "libavutil/pixdesc.h"
 #include "framesync.h"
@@ -85,7 +87,215 @@ typedef struct OverlayContext {
     int (*blend_slice)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
 } OverlayContext;
 
+// divide by 255 and round to nearest
+// apply a fast variant: (X+127)/255 = ((X+127)*257+257)>>16 = ((X+128)*257)>>16
+#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
+
+// divide by 1023 and round down, exact for X <= 1023*1023
+#define FAST_DIV1023(x) (((x) + ((x) >> 10) + 1) >> 10)
+
+/*
+ * Blend a row of a plane of the overlay with straight alpha into a main
+ * picture without alpha. The alpha row is subsampled according to the plane:
+ * 44 uses one alpha value per pixel, 22 averages horizontal pairs and 20
+ * averages 2x2 blocks, with the second row at alinesize bytes.
+ * Return the number of pixels blended, the remaining ones being left to the
+ * caller; the subsampled variants never blend the last pixel of the row.
+ */
+static int overlay_row_44_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    for (int x = 0; x < w; x++)
+        d[x] = FAST_DIV255(d[x] * (255 - a[x]) + s[x] * a[x]);
+    return FFMAX(w, 0);
+}
+
+static int overlay_row_22_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x] + ((a[2 * x] + a[2 * x + 1]) >> 1)) >> 1;
+        d[x] = FAST_DIV255(d[x] * (255 - alpha) + s[x] * alpha);
+    }
+    return x;
+}
+
+static int overlay_row_20_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    const uint8_t *a1 = a + alinesize;
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x] + a[2 * x + 1] + a1[2 * x] + a1[2 * x + 1]) >> 2;
+        d[x] = FAST_DIV255(d[x] * (255 - alpha) + s[x] * alpha);
+    }
+    return x;
+}
+
+static int overlay_row_44_10_c(uint8_t *d8, uint8_t *da8, uint8_t *s8, uint8_t *a8,
+                               int w, ptrdiff_t alinesize)
+{
+    uint16_t *d = (uint16_t *)d8;
+    const uint16_t *s = (const uint16_t *)s8, *a = (const uint16_t *)a8;
+
+    for (int x = 0; x < w; x++)
+        d[x] = FAST_DIV1023(d[x] * (1023 - a[x]) + s[x] * a[x]);
+    return FFMAX(w, 0);
+}
+
+static int overlay_row_22_10_c(uint8_t *d8, uint8_t *da8, uint8_t *s8, uint8_t *a8,
+                               int w, ptrdiff_t alinesize)
+{
+    uint16_t *d = (uint16_t *)d8;
+    const uint16_t *s = (const uint16_t *)s8, *a = (const uint16_t *)a8;
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x] + ((a[2 * x] + a[2 * x + 1]) >> 1)) >> 1;
+        d[x] = FAST_DIV1023(d[x] * (1023 - alpha) + s[x] * alpha);
+    }
+    return x;
+}
+
+static int overlay_row_20_10_c(uint8_t *d8, uint8_t *da8, uint8_t *s8, uint8_t *a8,
+                               int w, ptrdiff_t alinesize)
+{
+    uint16_t *d = (uint16_t *)d8;
+    const uint16_t *s  = (const uint16_t *)s8, *a = (const uint16_t *)a8;
+    const uint16_t *a1 = (const uint16_t *)(a8 + alinesize);
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x] + a[2 * x + 1] + a1[2 * x] + a1[2 * x + 1]) >> 2;
+        d[x] = FAST_DIV1023(d[x] * (1023 - alpha) + s[x] * alpha);
+    }
+    return x;
+}
+
+/*
+ * Same for an overlay with premultiplied alpha. The luma variant also serves
+ * the planes of RGB formats, the uv variants blend chroma around 128; both
+ * match the generic code, including the wrap of the chroma result 256 to 0.
+ */
+static int overlay_row_44_pm_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                               int w, ptrdiff_t alinesize)
+{
+    for (int x = 0; x < w; x++)
+        d[x] = av_clip_uint8(FAST_DIV255(d[x] * (255 - a[x])) + s[x] - 16);
+    return FFMAX(w, 0);
+}
+
+#define OVERLAY_PM_UV(d, s, alpha) \
+    (av_clip(FAST_DIV255(((d) - 128) * (255 - (alpha))) + (s) - 128, -128, 128) + 128)
+
+static int overlay_row_44_pm_uv_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                                  int w, ptrdiff_t alinesize)
+{
+    for (int x = 0; x < w; x++)
+        d[x] = OVERLAY_PM_UV(d[x], s[x], a[x]);
+    return FFMAX(w, 0);
+}
+
+static int overlay_row_22_pm_uv_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                                  int w, ptrdiff_t alinesize)
+{
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x] + ((a[2 * x] + a[2 * x + 1]) >> 1)) >> 1;
+        d[x] = OVERLAY_PM_UV(d[x], s[x], alpha);
+    }
+    return x;
+}
+
+static int overlay_row_20_pm_uv_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                                  int w, ptrdiff_t alinesize)
+{
+    const uint8_t *a1 = a + alinesize;
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x] + a[2 * x + 1] + a1[2 * x] + a1[2 * x + 1]) >> 2;
+        d[x] = OVERLAY_PM_UV(d[x], s[x], alpha);
+    }
+    return x;
+}
+
 void ff_overlay_init_x86(OverlayContext *s, int format, int pix_format,
                          int alpha_format, int main_has_alpha);
 
+static av_unused void ff_overlay_init(OverlayContext *s, int format, int pix_format,
+                                      int alpha_format, int main_has_alpha)
+{
+    int (*row_luma)(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a, int w,
+                    ptrdiff_t alinesize) = NULL;
+    int (*row_chroma)(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a, int w,
+                      ptrdiff_t alinesize) = NULL;
+
+    if (!alpha_format && !main_has_alpha) {
+        switch (format) {
+        case OVERLAY_FORMAT_YUV420:
+            if (pix_format == AV_PIX_FMT_YUV420P) {
+                row_luma   = overlay_row_44_c;
+                row_chroma = overlay_row_20_c;
+            }
+            break;
+        case OVERLAY_FORMAT_YUV422:
+            row_luma   = overlay_row_44_c;
+            row_chroma = overlay_row_22_c;
+            break;
+        case OVERLAY_FORMAT_YUV444:
+        case OVERLAY_FORMAT_GBRP:
+            row_luma   = overlay_row_44_c;
+            row_chroma = overlay_row_44_c;
+            break;
+        case OVERLAY_FORMAT_YUV420P10:
+            row_luma   = overlay_row_44_10_c;
+            row_chroma = overlay_row_20_10_c;
+            break;
+        case OVERLAY_FORMAT_YUV422P10:
+            row_luma   = overlay_row_44_10_c;
+            row_chroma = overlay_row_22_10_c;
+            break;
+        case OVERLAY_FORMAT_YUV444P10:
+            row_luma   = overlay_row_44_10_c;
+            row_chroma = overlay_row_44_10_c;
+            break;
+        }
+    }
+    if (alpha_format && !main_has_alpha) {
+        switch (format) {
+        case OVERLAY_FORMAT_YUV420:
+            if (pix_format == AV_PIX_FMT_YUV420P) {
+                row_luma   = overlay_row_44_pm_c;
+                row_chroma = overlay_row_20_pm_uv_c;
+            }
+            break;
+        case OVERLAY_FORMAT_YUV422:
+            row_luma   = overlay_row_44_pm_c;
+            row_chroma = overlay_row_22_pm_uv_c;
+            break;
+        case OVERLAY_FORMAT_YUV444:
+            row_luma   = overlay_row_44_pm_c;
+            row_chroma = overlay_row_44_pm_uv_c;
+            break;
+        case OVERLAY_FORMAT_GBRP:
+            row_luma   = overlay_row_44_pm_c;
+            row_chroma = overlay_row_44_pm_c;
+            break;
+        }
+    }
+    s->blend_row[0] = row_luma;
+    s->blend_row[1] = row_chroma;
+    s->blend_row[2] = row_chroma;
+    s->blend_row[3] = NULL;
+
+#if ARCH_X86
+    ff_overlay_init_x86(s, format, pix_format, alpha_format, main_has_alpha);
+#endif
+}
+
 #endif /* AVFILTER_OVERLAY_H */
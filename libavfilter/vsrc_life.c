@@ -277,19 +277,6 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&life->buf[1]);
 }
 
-static int config_props(AVFilterLink *outlink)
-{
-    LifeContext *life = outlink->src->priv;
-    FilterLink *l = ff_filter_link(outlink);
-
-    outlink->w = life->w;
-    outlink->h = life->h;
-    outlink->time_base = av_inv_q(life->frame_rate);
-    l->frame_rate = life->frame_rate;
-
-    return 0;
-}
-
 static void evolve(AVFilterContext *ctx)
 {
     LifeContext *life = ctx->priv;
@@ -397,6 +384,22 @@ static void fill_picture_rgb(AVFilterContext *ctx, AVFrame *picref)
     }
 }
 
+static int config_props(AVFilterLink *outlink)
+{
+    LifeContext *life = outlink->src->priv;
+    FilterLink *l = ff_filter_link(outlink);
+
+    outlink->w = life->w;
+    outlink->h = life->h;
+    outlink->time_base = av_inv_q(life->frame_rate);
+    l->frame_rate = life->frame_rate;
+
+    life->draw = outlink->format == AV_PIX_FMT_RGB24 ? fill_picture_rgb :
+                                                       fill_picture_monoblack;
+
+    return 0;
+}
+
 static int request_frame(AVFilterLink *outlink)
 {
     LifeContext *life = outlink->src->priv;
@@ -423,10 +426,8 @@ static int query_formats(AVFilterContext *ctx)
     if (life->mold || memcmp(life-> life_color, "\xff\xff\xff", 3)
                    || memcmp(life->death_color, "\x00\x00\x00", 3)) {
         pix_fmts[0] = AV_PIX_FMT_RGB24;
-        life->draw = fill_picture_rgb;
     } else {
         pix_fmts[0] = AV_PIX_FMT_MONOBLACK;
-        life->draw = fill_picture_monoblack;
     }
 
     return ff_set_common_formats_from_list(ctx, pix_fmts);
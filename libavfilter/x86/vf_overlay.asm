@@ -23,12 +23,15 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 32
 
 pb_1:     times 16 db 1
 pw_128:   times  8 dw 128
 pw_255:   times  8 dw 255
 pw_257:   times  8 dw 257
+pw_1:     times 16 dw 1
+pw_1023:  times 16 dw 1023
+pd_1:     times  8 dd 1
 
 SECTION .text
 
@@ -142,3 +145,141 @@ cglobal overlay_row_20, 6, 7, 7, 0, dst, da, s, a, w, r, x
     .end:
     mov    eax, xd
     RET
+
+; blend the mmsize/2 10-bit pixels at dstq+2*xq with the ones at sq+2*xq
+; using the alpha values in m2, m4 = pw_1023, m6 = pd_1
+%macro BLEND_10 0
+    psubw       m3, m4, m2
+    movu        m0, [dstq+2*xq]
+    movu        m1, [sq+2*xq]
+    punpckhwd   m5, m0, m1
+    punpcklwd   m0, m1
+    punpckhwd   m1, m3, m2
+    punpcklwd   m3, m2
+    pmaddwd     m0, m3
+    pmaddwd     m5, m1
+    ; FAST_DIV1023(x) = (x + (x >> 10) + 1) >> 10
+    psrld       m1, m0, 10
+    psrld       m3, m5, 10
+    paddd       m0, m6
+    paddd       m5, m6
+    paddd       m0, m1
+    paddd       m5, m3
+    psrld       m0, 10
+    psrld       m5, 10
+    packusdw    m0, m5
+    movu [dstq+2*xq], m0
+%endmacro
+
+; pack the alpha values of mmsize/2 pixels from the dwords in m2 and m3
+%macro PACK_ALPHA_10 0
+    packusdw    m2, m3
+%if cpuflag(avx2)
+    vpermq      m2, m2, q3120
+%endif
+%endmacro
+
+%macro OVERLAY_ROW_10 0
+cglobal overlay_row_44_10, 5, 7, 7, 0, dst, da, s, a, w, r, x
+    xor          xq, xq
+    movsxdifnidn wq, wd
+    mov          rq, wq
+    and          rq, mmsize/2 - 1
+    cmp          wq, mmsize/2
+    jl .end
+    sub          wq, rq
+    mova         m4, [pw_1023]
+    mova         m6, [pd_1]
+    .loop:
+        movu        m2, [aq+2*xq]
+        BLEND_10
+        add         xq, mmsize/2
+        cmp         xq, wq
+        jl .loop
+
+    .end:
+    mov    eax, xd
+    RET
+
+cglobal overlay_row_22_10, 5, 7, 8, 0, dst, da, s, a, w, r, x
+    xor          xq, xq
+    movsxdifnidn wq, wd
+    sub          wq, 1
+    mov          rq, wq
+    and          rq, mmsize/2 - 1
+    cmp          wq, mmsize/2
+    jl .end
+    sub          wq, rq
+    mova         m4, [pw_1023]
+    mova         m6, [pd_1]
+    mova         m7, [pw_1]
+    .loop:
+        movu        m2, [aq+4*xq]
+        movu        m3, [aq+4*xq+mmsize]
+        pmaddwd     m0, m2, m7
+        pmaddwd     m1, m3, m7
+        pslld       m2, 16
+        pslld       m3, 16
+        psrld       m2, 16
+        psrld       m3, 16
+        psrld       m0, 1
+        psrld       m1, 1
+        paddd       m2, m0
+        paddd       m3, m1
+        psrld       m2, 1
+        psrld       m3, 1
+        PACK_ALPHA_10
+        BLEND_10
+        add         xq, mmsize/2
+        cmp         xq, wq
+        jl .loop
+
+    .end:
+    mov    eax, xd
+    RET
+
+cglobal overlay_row_20_10, 6, 7, 8, 0, dst, da, s, a, w, r, x
+    mov         daq, aq
+    add         daq, rmp
+    xor          xq, xq
+    movsxdifnidn wq, wd
+    sub          wq, 1
+    mov          rq, wq
+    and          rq, mmsize/2 - 1
+    cmp          wq, mmsize/2
+    jl .end
+    sub          wq, rq
+    mova         m4, [pw_1023]
+    mova         m6, [pd_1]
+    mova         m7, [pw_1]
+    .loop:
+        movu        m0, [aq+4*xq]
+        movu        m1, [aq+4*xq+mmsize]
+        movu        m2, [daq+4*xq]
+        movu        m3, [daq+4*xq+mmsize]
+        pmaddwd     m0, m7
+        pmaddwd     m1, m7
+        pmaddwd     m2, m7
+        pmaddwd     m3, m7
+        paddd       m2, m0
+        paddd       m3, m1
+        psrld       m2, 2
+        psrld       m3, 2
+        PACK_ALPHA_10
+        BLEND_10
+        add         xq, mmsize/2
+        cmp         xq, wq
+        jl .loop
+
+    .end:
+    mov    eax, xd
+    RET
+%endmacro
+
+INIT_XMM sse4
+OVERLAY_ROW_10
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+OVERLAY_ROW_10
+%endif
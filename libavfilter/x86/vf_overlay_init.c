@@ -32,6 +32,34 @@ int ff_overlay_row_20_sse4(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
 int ff_overlay_row_22_sse4(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
                            int w, ptrdiff_t alinesize);
 
+#define OVERLAY_ROW_10_FUNCS(opt)                                                      \
+int ff_overlay_row_44_10_##opt(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,         \
+                               int w, ptrdiff_t alinesize);                            \
+int ff_overlay_row_22_10_##opt(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,         \
+                               int w, ptrdiff_t alinesize);                            \
+int ff_overlay_row_20_10_##opt(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,         \
+                               int w, ptrdiff_t alinesize);
+
+OVERLAY_ROW_10_FUNCS(sse4)
+OVERLAY_ROW_10_FUNCS(avx2)
+
+#define INIT_ROW_10(opt)                                                               \
+    do {                                                                               \
+        if (format == OVERLAY_FORMAT_YUV420P10) {                                      \
+            s->blend_row[0] = ff_overlay_row_44_10_##opt;                              \
+            s->blend_row[1] = ff_overlay_row_20_10_##opt;                              \
+            s->blend_row[2] = ff_overlay_row_20_10_##opt;                              \
+        } else if (format == OVERLAY_FORMAT_YUV422P10) {                               \
+            s->blend_row[0] = ff_overlay_row_44_10_##opt;                              \
+            s->blend_row[1] = ff_overlay_row_22_10_##opt;                              \
+            s->blend_row[2] = ff_overlay_row_22_10_##opt;                              \
+        } else if (format == OVERLAY_FORMAT_YUV444P10) {                               \
+            s->blend_row[0] = ff_overlay_row_44_10_##opt;                              \
+            s->blend_row[1] = ff_overlay_row_44_10_##opt;                              \
+            s->blend_row[2] = ff_overlay_row_44_10_##opt;                              \
+        }                                                                              \
+    } while (0)
+
 av_cold void ff_overlay_init_x86(OverlayContext *s, int format, int pix_format,
                                  int alpha_format, int main_has_alpha)
 {
@@ -62,4 +90,12 @@ av_cold void ff_overlay_init_x86(OverlayContext *s, int format, int pix_format,
         s->blend_row[1] = ff_overlay_row_22_sse4;
         s->blend_row[2] = ff_overlay_row_22_sse4;
     }
+
+    if (alpha_format || main_has_alpha)
+        return;
+
+    if (EXTERNAL_SSE4(cpu_flags))
+        INIT_ROW_10(sse4);
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        INIT_ROW_10(avx2);
 }
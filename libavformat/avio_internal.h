@@ -21,6 +21,7 @@
 
 #include "avio.h"
 
+#include "libavutil/buffer.h"
 #include "libavutil/log.h"
 
 extern const AVClass ff_avio_class;
@@ -170,6 +171,20 @@ void ffio_write_lines(AVIOContext *s, const unsigned char *buf, int size,
  */
 int ffio_read_size(AVIOContext *s, unsigned char *buf, int size);
 
+/**
+ * Read size bytes from AVIOContext without copying them, by getting a
+ * reference to the data from the underlying protocol, e.g. a memory mapped
+ * file. Data already buffered in the AVIOContext is skipped there rather
+ * than copied. The reference points to read-only memory followed by
+ * AV_INPUT_BUFFER_PADDING_SIZE zero bytes.
+ * On success the read position is advanced by size.
+ *
+ * @return size on success, AVERROR(ENOSYS) if the data cannot be lent,
+ *         in which case the caller should read it normally, or another
+ *         negative AVERROR code on failure
+ */
+int ffio_read_ref(AVIOContext *s, int size, AVBufferRef **ref);
+
 /**
  * Reallocate a given buffer for AVIOContext.
  *
@@ -31,6 +31,7 @@
 #include "avio.h"
 #include "avio_internal.h"
 #include "internal.h"
+#include "url.h"
 #include <stdarg.h>
 
 #define IO_BUFFER_SIZE 32768
@@ -669,6 +670,38 @@ int ffio_read_size(AVIOContext *s, unsigned char *buf, int size)
     return AVERROR_INVALIDDATA;
 }
 
+int ffio_read_ref(AVIOContext *s, int size, AVBufferRef **ref)
+{
+    FFIOContext *const ctx = ffiocontext(s);
+    URLContext *h = ffio_geturlcontext(s);
+    int64_t pos, bytes_read, ret;
+    int buffered;
+
+    if (!h || !h->prot->url_read_ref || s->write_flag || s->update_checksum ||
+        !s->seek || size <= 0)
+        return AVERROR(ENOSYS);
+
+    /* The protocol lends the whole range, the part of it that is already
+     * buffered is the same data and is merely skipped in the buffer. */
+    pos      = avio_tell(s);
+    buffered = FFMIN(s->buf_end - s->buf_ptr, size);
+    ret = h->prot->url_read_ref(h, pos, size, ref);
+    if (ret < 0)
+        return ret;
+
+    bytes_read = ctx->bytes_read;
+    ret = avio_seek(s, pos + size, SEEK_SET);
+    if (ret < 0) {
+        av_buffer_unref(ref);
+        return ret;
+    }
+    // avio_seek() may have read through the lent data for short distances
+    ctx->bytes_read = FFMAX(ctx->bytes_read, bytes_read + size - buffered);
+    s->bytes_read   = ctx->bytes_read;
+
+    return size;
+}
+
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data)
 {
     if (s->buf_end - s->buf_ptr >= size && !s->write_flag) {
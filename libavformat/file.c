@@ -22,10 +22,12 @@
 #include "config_components.h"
 
 #include "libavutil/avstring.h"
+#include "libavutil/buffer.h"
 #include "libavutil/file_open.h"
 #include "libavutil/internal.h"
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
+#include "libavcodec/defs.h"
 #include "avio.h"
 #if HAVE_DIRENT_H
 #include <dirent.h>
@@ -39,6 +41,9 @@
 #endif
 #include <sys/stat.h>
 #include <stdlib.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include "os_support.h"
 #include "url.h"
 
@@ -89,6 +94,11 @@
 
 /* standard file protocol */
 
+/* amount of data to ask the kernel to prefetch ahead of the read position */
+#define MMAP_READAHEAD (4 << 20)
+/* smaller packets are cheaper to copy than to map on their own */
+#define MMAP_LEND_MIN_SIZE (128 << 10)
+
 typedef struct FileContext {
     const AVClass *class;
     int fd;
@@ -96,9 +106,26 @@ typedef struct FileContext {
     int blocksize;
     int follow;
     int seekable;
+    int use_mmap;
+    int readahead;
+    int readahead_windows;
 #if HAVE_DIRENT_H
     DIR *dir;
 #endif
+    /* the whole file, when mapped */
+    AVBufferRef *map;
+    /* end of the mapping, the bytes from the end of the file up to it are
+     * zero */
+    int64_t map_end;
+    long page_size;
+    int64_t map_pos;
+    /* range for which prefetching was last requested */
+    int64_t map_advised_start;
+    int64_t map_advised;
+    /* read position and prefetched range when not mapped */
+    int64_t pos;
+    int64_t ra_start;
+    int64_t ra_end;
 } FileContext;
 
 static const AVOption file_options[] = {
@@ -106,6 +133,9 @@ static const AVOption file_options[] = {
     { "blocksize", "set I/O operation maximum block size", offsetof(FileContext, blocksize), AV_OPT_TYPE_INT, { .i64 = INT_MAX }, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { "seekable", "Sets if the file is seekable", offsetof(FileContext, seekable), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, 0, AV_OPT_FLAG_DECODING_PARAM | AV_OPT_FLAG_ENCODING_PARAM },
+    { "mmap", "Map the file into memory when reading and lend packet data from the mapping", offsetof(FileContext, use_mmap), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+    { "readahead", "Size of the windows prefetched ahead of the read position (0 = disabled)", offsetof(FileContext, readahead), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, AV_OPT_FLAG_DECODING_PARAM },
+    { "readahead_windows", "Number of prefetched windows kept in flight", offsetof(FileContext, readahead_windows), AV_OPT_TYPE_INT, { .i64 = 4 }, 1, 64, AV_OPT_FLAG_DECODING_PARAM },
     { NULL }
 };
 
@@ -136,12 +166,197 @@ static const AVClass fd_class = {
     .version    = LIBAVUTIL_VERSION_INT,
 };
 
+#if HAVE_MMAP
+static void file_unmap(void *opaque, uint8_t *data)
+{
+    munmap(data, (size_t)(uintptr_t)opaque);
+}
+
+/*
+ * Accessing pages of the mapping beyond the end of the file raises SIGBUS,
+ * so the file must not be truncated while it is mapped; this cannot be
+ * detected here without a system call for each access.
+ */
+static int file_map(URLContext *h, int64_t size)
+{
+    FileContext *c = h->priv_data;
+    long page_size = sysconf(_SC_PAGESIZE);
+    void *map;
+
+    if (size <= 0 || size > SIZE_MAX)
+        return AVERROR(EINVAL);
+
+    map = mmap(NULL, size, PROT_READ, MAP_SHARED, c->fd, 0);
+    if (map == MAP_FAILED)
+        return AVERROR(errno);
+
+    c->map = av_buffer_create(map, size, file_unmap, (void *)(uintptr_t)size,
+                              AV_BUFFER_FLAG_READONLY);
+    if (!c->map) {
+        munmap(map, size);
+        return AVERROR(ENOMEM);
+    }
+
+#if HAVE_POSIX_MADVISE
+    posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+#endif
+    c->page_size   = page_size;
+    c->map_end     = page_size > 0 ? FFALIGN(size, page_size) : size;
+    c->map_pos     = 0;
+    c->map_advised_start =
+    c->map_advised = 0;
+
+    return 0;
+}
+
+static void file_map_readahead(FileContext *c)
+{
+#if HAVE_POSIX_MADVISE
+    /* keep at least half a window of prefetched data ahead of the reader,
+     * the advised range is window aligned and thus page aligned */
+    if (c->map_pos + MMAP_READAHEAD / 2 >= c->map_advised &&
+        c->map_advised < c->map->size) {
+        int64_t start = c->map_pos & ~(int64_t)(MMAP_READAHEAD - 1);
+        int64_t end   = FFMIN(start + 2 * MMAP_READAHEAD, c->map->size);
+
+        if (end > start)
+            posix_madvise(c->map->data + start, end - start, POSIX_MADV_WILLNEED);
+        c->map_advised_start = start;
+        c->map_advised       = end;
+    }
+#endif
+}
+
+static int file_map_read(URLContext *h, unsigned char *buf, int size)
+{
+    FileContext *c = h->priv_data;
+
+    if (c->map_pos >= c->map->size)
+        return AVERROR_EOF;
+
+    size = FFMIN(size, c->map->size - c->map_pos);
+    memcpy(buf, c->map->data + c->map_pos, size);
+    c->map_pos += size;
+    file_map_readahead(c);
+
+    return size;
+}
+
+static int64_t file_map_seek(URLContext *h, int64_t pos, int whence)
+{
+    FileContext *c = h->priv_data;
+
+    switch (whence) {
+    case AVSEEK_SIZE:
+        return c->map->size;
+    case SEEK_CUR:
+        pos += c->map_pos;
+        break;
+    case SEEK_END:
+        pos += c->map->size;
+        break;
+    case SEEK_SET:
+        break;
+    default:
+        return AVERROR(EINVAL);
+    }
+    if (pos < 0)
+        return AVERROR(EINVAL);
+
+    c->map_pos = pos;
+    // restart prefetching when leaving the prefetched range
+    if (pos < c->map_advised_start || pos > c->map_advised)
+        c->map_advised_start = c->map_advised = 0;
+    file_map_readahead(c);
+
+    return pos;
+}
+
+static void file_unmap_ref(void *opaque, uint8_t *data)
+{
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    munmap(data - (uintptr_t)data % page_size, (size_t)(uintptr_t)opaque);
+}
+
+/*
+ * The data following a packet in the file cannot serve as its padding, so
+ * each lent packet gets a private mapping of its own pages, in which the
+ * padding is zeroed. Only the page(s) holding the padding are copied.
+ */
+static int file_read_ref(URLContext *h, int64_t pos, int size, AVBufferRef **pref)
+{
+    FileContext *c = h->priv_data;
+    AVBufferRef *ref;
+    int64_t end = pos + size;
+    int64_t start;
+    size_t len;
+    uint8_t *map;
+
+    /* pages after the last one of the file cannot be accessed */
+    if (!c->map || c->page_size <= 0 || pos < 0 || size < MMAP_LEND_MIN_SIZE ||
+        end > c->map->size || end + AV_INPUT_BUFFER_PADDING_SIZE > c->map_end)
+        return AVERROR(ENOSYS);
+
+    start = pos - pos % c->page_size;
+    len   = end + AV_INPUT_BUFFER_PADDING_SIZE - start;
+    // e.g. too many mappings, let the caller copy
+    map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, c->fd, start);
+    if (map == MAP_FAILED)
+        return AVERROR(ENOSYS);
+    memset(map + (end - start), 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    ref = av_buffer_create(map + (pos - start), size, file_unmap_ref,
+                           (void *)(uintptr_t)len, AV_BUFFER_FLAG_READONLY);
+    if (!ref) {
+        munmap(map, len);
+        return AVERROR(ENOMEM);
+    }
+
+    *pref = ref;
+    return size;
+}
+#endif /* HAVE_MMAP */
+
+static void file_readahead(FileContext *c)
+{
+#if HAVE_POSIX_FADVISE
+    int64_t window = c->readahead;
+    int64_t target;
+
+    if (!window)
+        return;
+
+    /* the reader moved out of the prefetched range, restart from the window
+     * it is in now; prefetched data behind it stays in the page cache */
+    if (c->pos < c->ra_start || c->pos > c->ra_end)
+        c->ra_start = c->ra_end = c->pos - c->pos % window;
+
+    /* the kernel reads the advised ranges asynchronously, so keep the
+     * configured number of windows queued ahead of the reader */
+    target = (c->pos / window + c->readahead_windows) * window;
+    while (c->ra_end < target) {
+        if (posix_fadvise(c->fd, c->ra_end, window, POSIX_FADV_WILLNEED))
+            break;
+        c->ra_end += window;
+    }
+#endif
+}
+
 static int file_read(URLContext *h, unsigned char *buf, int size)
 {
     FileContext *c = h->priv_data;
     int ret;
     size = FFMIN(size, c->blocksize);
+#if HAVE_MMAP
+    if (c->map)
+        return file_map_read(h, buf, size);
+#endif
     ret = read(c->fd, buf, size);
+    if (ret > 0 && c->readahead) {
+        c->pos += ret;
+        file_readahead(c);
+    }
     if (ret == 0 && c->follow)
         return AVERROR(EAGAIN);
     if (ret == 0)
@@ -221,7 +436,12 @@ static int fd_dup(URLContext *h, int oldfd)
 static int file_close(URLContext *h)
 {
     FileContext *c = h->priv_data;
-    int ret = close(c->fd);
+    int ret;
+
+    /* packets lent from the mapping keep it alive */
+    av_buffer_unref(&c->map);
+
+    ret = close(c->fd);
     return (ret == -1) ? AVERROR(errno) : 0;
 }
 
@@ -231,6 +451,11 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
     FileContext *c = h->priv_data;
     int64_t ret;
 
+#if HAVE_MMAP
+    if (c->map)
+        return file_map_seek(h, pos, whence);
+#endif
+
     if (whence == AVSEEK_SIZE) {
         struct stat st;
         ret = fstat(c->fd, &st);
@@ -238,6 +463,10 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
     }
 
     ret = lseek(c->fd, pos, whence);
+    if (ret >= 0 && c->readahead) {
+        c->pos = ret;
+        file_readahead(c);
+    }
 
     return ret < 0 ? AVERROR(errno) : ret;
 }
@@ -318,6 +547,42 @@ static int file_open(URLContext *h, const char *filename, int flags)
     if (c->seekable >= 0)
         h->is_streamed = !c->seekable;
 
+#if HAVE_MMAP
+    if (c->use_mmap) {
+        if (flags & AVIO_FLAG_WRITE || c->follow || h->is_streamed ||
+            fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+            av_log(h, AV_LOG_WARNING, "Cannot map %s, reading it normally\n", filename);
+        } else {
+            int ret = file_map(h, st.st_size);
+            if (ret < 0)
+                av_log(h, AV_LOG_WARNING, "Failed to map %s: %s\n",
+                       filename, av_err2str(ret));
+        }
+    }
+#else
+    if (c->use_mmap)
+        av_log(h, AV_LOG_WARNING, "Memory mapping is not supported on this platform\n");
+#endif
+
+    if (c->readahead) {
+#if HAVE_POSIX_FADVISE
+        if (flags & AVIO_FLAG_WRITE || h->is_streamed ||
+            fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+            c->readahead = 0;
+        } else {
+#if HAVE_MMAP
+            /* the mapping prefetches on its own */
+            if (c->map)
+                c->readahead = 0;
+#endif
+            file_readahead(c);
+        }
+#else
+        av_log(h, AV_LOG_WARNING, "Readahead is not supported on this platform\n");
+        c->readahead = 0;
+#endif
+    }
+
     return 0;
 }
 
@@ -416,6 +681,9 @@ const URLProtocol ff_file_protocol = {
     .url_check           = file_check,
     .url_delete          = file_delete,
     .url_move            = file_move,
+#if HAVE_MMAP
+    .url_read_ref        = file_read_ref,
+#endif
     .priv_data_size      = sizeof(FileContext),
     .priv_data_class     = &file_class,
     .url_open_dir        = file_open_dir,
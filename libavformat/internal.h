@@ -563,6 +563,14 @@ int ff_get_line(AVIOContext *s, char *buf, int maxlen);
  */
 int ff_get_chomp_line(AVIOContext *s, char *buf, int maxlen);
 
+/**
+ * Like av_get_packet(), but try to reference the data in the underlying
+ * protocol instead of copying it, see ffio_read_ref(). Packets returned this
+ * way are not writable, so demuxers modifying the packet data in place must
+ * call av_packet_make_writable() first.
+ */
+int ff_get_packet_ref(AVIOContext *s, AVPacket *pkt, int size);
+
 #define SPACE_CHARS " \t\r\n"
 
 /**
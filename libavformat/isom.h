@@ -273,6 +273,7 @@ typedef struct MOVStreamContext {
     } cenc;
 
     struct IAMFDemuxContext *iamf;
+    int index_cached;     ///< the index was loaded from the index cache
 #ifdef OHOS_CAL_DASH_BITRATE
     int64_t referenced_size;
 #endif
@@ -365,6 +366,13 @@ typedef struct MOVContext {
     int thmb_item_id;
     int64_t idat_offset;
     int interleaved_read;
+    int index_cache;
+    int64_t moov_pos;       ///< offset of the 'moov' atom payload
+    int64_t moov_size;
+    int64_t file_mtime;     ///< modification time of the file in ns, 0 if unknown
+    struct MOVIndexCacheTrack *index_cache_tracks; ///< indexes built while reading the header
+    int nb_index_cache_tracks;
+    struct MOVIndexCacheTrack *index_cache_track;  ///< index currently being built
 } MOVContext;
 
 int ff_mp4_read_descr_len(AVIOContext *pb);
@@ -436,6 +444,13 @@ void ff_mp4_parse_es_descr(AVIOContext *pb, int *es_id);
 int ff_mov_read_esds(AVFormatContext *fc, AVIOContext *pb);
 
 int ff_mov_read_stsd_entries(MOVContext *c, AVIOContext *pb, int entries);
+
+/**
+ * Check whether the index of a stream opened by the mov demuxer was loaded
+ * from the index cache instead of being built from its sample tables.
+ */
+int ff_mov_stream_index_cached(const AVStream *st);
+
 void ff_mov_write_chan(AVIOContext *pb, int64_t channel_layout);
 
 #define FF_MOV_FLAG_MFRA_AUTO -1
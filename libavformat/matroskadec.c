@@ -1087,8 +1087,25 @@ static int ebml_read_ascii(AVIOContext *pb, int size,
 static int ebml_read_binary(AVIOContext *pb, int length,
                             int64_t pos, EbmlBin *bin)
 {
+    AVBufferRef *ref;
     int ret;
 
+    ret = ffio_read_ref(pb, length, &ref);
+    if (ret >= 0) {
+        av_buffer_unref(&bin->buf);
+        bin->buf  = ref;
+        bin->data = ref->data;
+        bin->size = length;
+        bin->pos  = pos;
+        return 0;
+    } else if (ret != AVERROR(ENOSYS))
+        return ret;
+
+    /* the contents are replaced anyway, do not copy them into a new buffer
+     * if the old one is shared or lent by the protocol */
+    if (bin->buf && !av_buffer_is_writable(bin->buf))
+        av_buffer_unref(&bin->buf);
+
     ret = av_buffer_realloc(&bin->buf, length + AV_INPUT_BUFFER_PADDING_SIZE);
     if (ret < 0)
         return ret;
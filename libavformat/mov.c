@@ -25,9 +25,12 @@
 
 #include "config_components.h"
 
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
 #include <inttypes.h>
 #include <limits.h>
 #include <stdint.h>
+#include <sys/stat.h>
 
 #include "libavutil/attributes.h"
 #include "libavutil/bprint.h"
@@ -48,6 +51,7 @@
 #include "libavutil/sha.h"
 #include "libavutil/spherical.h"
 #include "libavutil/stereo3d.h"
+#include "libavutil/thread.h"
 #include "libavutil/timecode.h"
 #include "libavutil/uuid.h"
 #include "libavcodec/ac3tab.h"
@@ -59,6 +63,8 @@
 #include "internal.h"
 #include "avio_internal.h"
 #include "demux.h"
+#include "os_support.h"
+#include "url.h"
 #include "iamf_parse.h"
 #include "iamf_reader.h"
 #include "dovi_isom.h"
@@ -1639,6 +1645,9 @@ static int mov_read_moov(MOVContext *c, AVIOContext *pb, MOVAtom atom)
         return 0;
     }
 
+    c->moov_pos  = avio_tell(pb);
+    c->moov_size = atom.size;
+
     if ((ret = mov_read_default(c, pb, atom)) < 0)
         return ret;
     /* we parsed the 'moov' atom, we can terminate the parsing as soon as we find the 'mdat' */
@@ -4983,6 +4992,58 @@ static int build_open_gop_key_points(AVStream *st)
     return 0;
 }
 
+/* timestamps fed to the frame rate estimation while building an index */
+#define MOV_INDEX_CACHE_RFPS 100
+
+typedef struct MOVIndexCacheTrack {
+    /* what the index was built from */
+    int index;
+    int id;
+    int64_t trak_pos;
+    int64_t trak_size;
+    unsigned int sample_count;
+    unsigned int chunk_count;
+    unsigned int stts_count;
+    unsigned int stsc_count;
+    unsigned int ctts_entries;
+    unsigned int elst_count;
+    unsigned int keyframe_count;
+    int time_scale;
+    int ignore_editlist;
+    int advanced_editlist;
+    int64_t first_chunk_offset;
+    int64_t last_chunk_offset;
+    unsigned int last_sample_size;
+
+    /* the index and the stream state derived along with it */
+    AVIndexEntry *index_entries;
+    int nb_index_entries;
+    MOVCtts *ctts_data;
+    unsigned int ctts_count;
+    MOVIndexRange *index_ranges;
+    int current_index_range;
+    int32_t *sample_offsets;
+    int sample_offsets_count;
+    int *open_key_samples;
+    int open_key_samples_count;
+    uint32_t min_sample_duration;
+    unsigned int stsz_sample_size;
+    int64_t time_offset;
+    int64_t min_corrected_pts;
+    int64_t current_index;
+    int current_sample;
+    int ctts_index;
+    int ctts_sample;
+    int start_pad;
+    int skip_samples;
+    int64_t start_time;
+    int64_t duration;
+    int64_t bit_rate;
+    int video_delay;
+    int64_t rfps_dts[MOV_INDEX_CACHE_RFPS];
+    int nb_rfps_dts;
+} MOVIndexCacheTrack;
+
 static void mov_build_index(MOVContext *mov, AVStream *st)
 {
     MOVStreamContext *sc = st->priv_data;
@@ -5182,11 +5243,15 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
                             "size %u, distance %u, keyframe %d\n", st->index, current_sample,
                             current_offset, current_dts, sample_size, distance, keyframe);
 #ifdef OHOS_AUXILIARY_TRACK
-                    if (need_parse_video_info(st) == 1 && sti->nb_index_entries < 100)
+                    if (need_parse_video_info(st) == 1 && sti->nb_index_entries < 100) {
 #else
-                    if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && sti->nb_index_entries < 100)
+                    if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && sti->nb_index_entries < 100) {
 #endif
+                        MOVIndexCacheTrack *t = mov->index_cache_track;
                         ff_rfps_add_frame(mov->fc, st, current_dts);
+                        if (t && t->nb_rfps_dts < MOV_INDEX_CACHE_RFPS)
+                            t->rfps_dts[t->nb_rfps_dts++] = current_dts;
+                    }
                 }
 
                 current_offset += sample_size;
@@ -5327,6 +5392,382 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
     mov_estimate_video_delay(mov, st);
 }
 
+/*
+ * Process-wide cache of the indexes built by mov_build_index().
+ *
+ * Building the index walks every sample of every track, which dominates the
+ * time needed to open long files. With the index_cache option the result is
+ * kept, keyed by the URL, the size and modification time of the file and the
+ * position of the moov atom, and reused the next time the same file is opened.
+ * Each track also records the position of its trak atom, the dimensions of the
+ * sample tables and a few of their entries. All of these are known once the
+ * tables are parsed, so looking up the cache costs nothing per sample.
+ */
+
+#define MOV_INDEX_CACHE_ENTRIES 16
+
+typedef struct MOVIndexCacheEntry {
+    char *url;
+    int64_t file_size;
+    int64_t file_mtime;
+    int64_t moov_pos;
+    int64_t moov_size;
+    MOVIndexCacheTrack *tracks;
+    int nb_tracks;
+} MOVIndexCacheEntry;
+
+static AVMutex index_cache_lock = AV_MUTEX_INITIALIZER;
+/* most recently used first */
+static MOVIndexCacheEntry index_cache[MOV_INDEX_CACHE_ENTRIES];
+static int index_cache_count;
+
+static void index_cache_track_free(MOVIndexCacheTrack *t)
+{
+    av_freep(&t->index_entries);
+    av_freep(&t->ctts_data);
+    av_freep(&t->index_ranges);
+    av_freep(&t->sample_offsets);
+    av_freep(&t->open_key_samples);
+}
+
+static void index_cache_entry_free(MOVIndexCacheEntry *e)
+{
+    for (int i = 0; i < e->nb_tracks; i++)
+        index_cache_track_free(&e->tracks[i]);
+    av_freep(&e->tracks);
+    av_freep(&e->url);
+}
+
+static int index_cache_entry_match(const MOVIndexCacheEntry *a,
+                                   const MOVIndexCacheEntry *b)
+{
+    return a->file_size  == b->file_size  &&
+           a->file_mtime == b->file_mtime &&
+           a->moov_pos   == b->moov_pos   &&
+           a->moov_size == b->moov_size &&
+           !strcmp(a->url, b->url);
+}
+
+static int index_cache_track_match(const MOVIndexCacheTrack *a,
+                                   const MOVIndexCacheTrack *b)
+{
+    return a->index             == b->index             &&
+           a->id                == b->id                &&
+           a->trak_pos          == b->trak_pos          &&
+           a->trak_size         == b->trak_size         &&
+           a->sample_count      == b->sample_count      &&
+           a->chunk_count       == b->chunk_count       &&
+           a->stts_count        == b->stts_count        &&
+           a->stsc_count        == b->stsc_count        &&
+           a->ctts_entries      == b->ctts_entries      &&
+           a->elst_count        == b->elst_count        &&
+           a->keyframe_count    == b->keyframe_count    &&
+           a->time_scale        == b->time_scale        &&
+           a->ignore_editlist   == b->ignore_editlist   &&
+           a->advanced_editlist == b->advanced_editlist &&
+           a->first_chunk_offset == b->first_chunk_offset &&
+           a->last_chunk_offset  == b->last_chunk_offset  &&
+           a->last_sample_size   == b->last_sample_size;
+}
+
+static int index_cache_dup(void *dst, const void *src, size_t nb, size_t size)
+{
+    void *buf = NULL;
+
+    if (src && nb) {
+        buf = av_memdup(src, nb * size);
+        if (!buf)
+            return AVERROR(ENOMEM);
+    }
+    memcpy(dst, &buf, sizeof(buf));
+    return 0;
+}
+
+static void index_cache_track_init(MOVIndexCacheTrack *t, const MOVContext *c,
+                                   const AVStream *st, int64_t trak_pos,
+                                   int64_t trak_size)
+{
+    const MOVStreamContext *sc = st->priv_data;
+
+    t->index              = st->index;
+    t->id                 = sc->id;
+    t->trak_pos           = trak_pos;
+    t->trak_size          = trak_size;
+    t->sample_count       = sc->sample_count;
+    t->chunk_count        = sc->chunk_count;
+    t->stts_count         = sc->stts_count;
+    t->stsc_count         = sc->stsc_count;
+    t->ctts_entries       = sc->ctts_count;
+    t->elst_count         = sc->elst_count;
+    t->keyframe_count     = sc->keyframe_count;
+    t->time_scale         = sc->time_scale;
+    t->ignore_editlist    = c->ignore_editlist;
+    t->advanced_editlist  = c->advanced_editlist;
+    // cheap spot checks against a table edited in place
+    t->first_chunk_offset = sc->chunk_count ? sc->chunk_offsets[0] : -1;
+    t->last_chunk_offset  = sc->chunk_count ? sc->chunk_offsets[sc->chunk_count - 1] : -1;
+    t->last_sample_size   = sc->sample_sizes && sc->sample_count ?
+                            sc->sample_sizes[sc->sample_count - 1] : sc->sample_size;
+}
+
+static int index_cache_track_save(MOVIndexCacheTrack *t, const AVStream *st)
+{
+    const MOVStreamContext *sc = st->priv_data;
+    const FFStream *const sti = cffstream(st);
+    int ret;
+
+    if ((ret = index_cache_dup(&t->index_entries, sti->index_entries,
+                               sti->nb_index_entries, sizeof(*t->index_entries))) < 0 ||
+        (ret = index_cache_dup(&t->ctts_data, sc->ctts_data,
+                               sc->ctts_count, sizeof(*t->ctts_data))) < 0 ||
+        (ret = index_cache_dup(&t->index_ranges, sc->index_ranges,
+                               sc->elst_count + 1, sizeof(*t->index_ranges))) < 0 ||
+        (ret = index_cache_dup(&t->sample_offsets, sc->sample_offsets,
+                               sc->sample_offsets_count, sizeof(*t->sample_offsets))) < 0 ||
+        (ret = index_cache_dup(&t->open_key_samples, sc->open_key_samples,
+                               sc->open_key_samples_count, sizeof(*t->open_key_samples))) < 0) {
+        index_cache_track_free(t);
+        return ret;
+    }
+
+    t->nb_index_entries       = sti->nb_index_entries;
+    t->ctts_count             = sc->ctts_count;
+    t->current_index_range    = sc->index_ranges ? sc->current_index_range - sc->index_ranges : 0;
+    t->sample_offsets_count   = sc->sample_offsets_count;
+    t->open_key_samples_count = sc->open_key_samples_count;
+    t->min_sample_duration    = sc->min_sample_duration;
+    t->stsz_sample_size       = sc->stsz_sample_size;
+    t->time_offset            = sc->time_offset;
+    t->min_corrected_pts      = sc->min_corrected_pts;
+    t->current_index          = sc->current_index;
+    t->current_sample         = sc->current_sample;
+    t->ctts_index             = sc->ctts_index;
+    t->ctts_sample            = sc->ctts_sample;
+    t->start_pad              = sc->start_pad;
+    t->skip_samples           = sti->skip_samples;
+    t->start_time             = st->start_time;
+    t->duration               = st->duration;
+    t->bit_rate               = st->codecpar->bit_rate;
+    t->video_delay            = st->codecpar->video_delay;
+
+    return 0;
+}
+
+static int index_cache_track_load(const MOVIndexCacheTrack *t, MOVContext *c,
+                                  AVStream *st)
+{
+    MOVStreamContext *sc = st->priv_data;
+    FFStream *const sti = ffstream(st);
+    MOVIndexCacheTrack tmp = { 0 };
+    int ret;
+
+    if ((ret = index_cache_dup(&tmp.index_entries, t->index_entries,
+                               t->nb_index_entries, sizeof(*t->index_entries))) < 0 ||
+        (ret = index_cache_dup(&tmp.ctts_data, t->ctts_data,
+                               t->ctts_count, sizeof(*t->ctts_data))) < 0 ||
+        (ret = index_cache_dup(&tmp.index_ranges, t->index_ranges,
+                               t->elst_count + 1, sizeof(*t->index_ranges))) < 0 ||
+        (ret = index_cache_dup(&tmp.sample_offsets, t->sample_offsets,
+                               t->sample_offsets_count, sizeof(*t->sample_offsets))) < 0 ||
+        (ret = index_cache_dup(&tmp.open_key_samples, t->open_key_samples,
+                               t->open_key_samples_count, sizeof(*t->open_key_samples))) < 0) {
+        index_cache_track_free(&tmp);
+        return ret;
+    }
+
+    av_free(sti->index_entries);
+    sti->index_entries                = tmp.index_entries;
+    sti->nb_index_entries             = t->nb_index_entries;
+    sti->index_entries_allocated_size = t->nb_index_entries * sizeof(*sti->index_entries);
+    sti->skip_samples                 = t->skip_samples;
+
+    // the cached table is already expanded to one entry per sample
+    av_free(sc->ctts_data);
+    sc->ctts_data              = tmp.ctts_data;
+    sc->ctts_count             = t->ctts_count;
+    sc->ctts_allocated_size    = t->ctts_count * sizeof(*sc->ctts_data);
+    av_free(sc->index_ranges);
+    av_free(sc->sample_offsets);
+    av_free(sc->open_key_samples);
+    sc->index_ranges           = tmp.index_ranges;
+    sc->current_index_range    = tmp.index_ranges ? tmp.index_ranges + t->current_index_range : NULL;
+    sc->sample_offsets         = tmp.sample_offsets;
+    sc->sample_offsets_count   = t->sample_offsets_count;
+    sc->open_key_samples       = tmp.open_key_samples;
+    sc->open_key_samples_count = t->open_key_samples_count;
+    sc->min_sample_duration    = t->min_sample_duration;
+    sc->stsz_sample_size       = t->stsz_sample_size;
+    sc->time_offset            = t->time_offset;
+    sc->min_corrected_pts      = t->min_corrected_pts;
+    sc->current_index          = t->current_index;
+    sc->current_sample         = t->current_sample;
+    sc->ctts_index             = t->ctts_index;
+    sc->ctts_sample            = t->ctts_sample;
+    sc->start_pad              = t->start_pad;
+
+    st->start_time             = t->start_time;
+    st->duration               = t->duration;
+    st->codecpar->bit_rate     = t->bit_rate;
+    st->codecpar->video_delay  = t->video_delay;
+
+    for (int i = 0; i < t->nb_rfps_dts; i++)
+        ff_rfps_add_frame(c->fc, st, t->rfps_dts[i]);
+
+    return 0;
+}
+
+/**
+ * Get the modification time of the file read by pb, 0 if it is not known.
+ */
+static int64_t index_cache_file_mtime(AVIOContext *pb)
+{
+    URLContext *h = ffio_geturlcontext(pb);
+    int fd = h ? ffurl_get_file_handle(h) : -1;
+    struct stat st;
+    int64_t mtime;
+
+    if (fd < 0 || fstat(fd, &st) < 0)
+        return 0;
+    mtime = (int64_t)st.st_mtime * 1000000000;
+#if HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+    mtime += st.st_mtim.tv_nsec;
+#endif
+    return mtime;
+}
+
+static void mov_build_index_cached(MOVContext *c, AVStream *st,
+                                   int64_t trak_pos, int64_t trak_size)
+{
+    FFStream *const sti = ffstream(st);
+    MOVStreamContext *sc = st->priv_data;
+    MOVIndexCacheEntry key = {
+        .url        = c->fc->url,
+        .file_size  = avio_size(c->fc->pb),
+        .moov_pos   = c->moov_pos,
+        .moov_size  = c->moov_size,
+    };
+    MOVIndexCacheTrack track = { 0 }, *t;
+    int found = 0;
+
+    if (c->index_cache && !c->file_mtime)
+        c->file_mtime = index_cache_file_mtime(c->fc->pb);
+    key.file_mtime = c->file_mtime;
+
+    if (!c->index_cache || !key.url || !*key.url || key.file_size <= 0 ||
+        !key.file_mtime || !c->moov_size || sti->nb_index_entries) {
+        mov_build_index(c, st);
+        return;
+    }
+
+    index_cache_track_init(&track, c, st, trak_pos, trak_size);
+
+    ff_mutex_lock(&index_cache_lock);
+    for (int i = 0; i < index_cache_count; i++) {
+        MOVIndexCacheEntry e = index_cache[i];
+
+        if (!index_cache_entry_match(&e, &key))
+            continue;
+        for (int j = 0; j < e.nb_tracks && !found; j++)
+            if (index_cache_track_match(&e.tracks[j], &track))
+                found = index_cache_track_load(&e.tracks[j], c, st) >= 0;
+        // keep recently used files in the cache
+        memmove(&index_cache[1], &index_cache[0], i * sizeof(*index_cache));
+        index_cache[0] = e;
+        break;
+    }
+    ff_mutex_unlock(&index_cache_lock);
+
+    if (found) {
+        sc->index_cached = 1;
+        av_log(c->fc, AV_LOG_DEBUG, "Loaded the index of stream %d from the cache\n",
+               st->index);
+        return;
+    }
+
+    t = av_realloc_array(c->index_cache_tracks, c->nb_index_cache_tracks + 1, sizeof(*t));
+    if (!t) {
+        mov_build_index(c, st);
+        return;
+    }
+    c->index_cache_tracks = t;
+    t = &t[c->nb_index_cache_tracks++];
+    *t = track;
+
+    c->index_cache_track = t;
+    mov_build_index(c, st);
+    c->index_cache_track = NULL;
+
+    if (index_cache_track_save(t, st) < 0)
+        c->nb_index_cache_tracks--;
+}
+
+int ff_mov_stream_index_cached(const AVStream *st)
+{
+    const MOVStreamContext *sc = st->priv_data;
+    return sc->index_cached;
+}
+
+static void index_cache_publish(MOVContext *c)
+{
+    MOVIndexCacheEntry e = {
+        .file_size  = avio_size(c->fc->pb),
+        .file_mtime = c->file_mtime,
+        .moov_pos   = c->moov_pos,
+        .moov_size  = c->moov_size,
+        .tracks     = c->index_cache_tracks,
+        .nb_tracks  = c->nb_index_cache_tracks,
+    };
+    int i;
+
+    if (!c->nb_index_cache_tracks)
+        return;
+
+    e.url = av_strdup(c->fc->url);
+    c->index_cache_tracks    = NULL;
+    c->nb_index_cache_tracks = 0;
+    if (!e.url) {
+        index_cache_entry_free(&e);
+        return;
+    }
+
+    ff_mutex_lock(&index_cache_lock);
+    for (i = 0; i < index_cache_count; i++)
+        if (index_cache_entry_match(&index_cache[i], &e))
+            break;
+    if (i < index_cache_count) {
+        MOVIndexCacheEntry *old = &index_cache[i];
+        MOVIndexCacheTrack *tracks = av_realloc_array(e.tracks, e.nb_tracks + old->nb_tracks,
+                                                      sizeof(*e.tracks));
+        int nb_tracks = e.nb_tracks;
+
+        // keep the tracks of this file that were loaded from the cache
+        if (tracks)
+            e.tracks = tracks;
+        for (int j = 0; j < old->nb_tracks; j++) {
+            MOVIndexCacheTrack *t = &old->tracks[j];
+            int k;
+
+            for (k = 0; k < nb_tracks; k++)
+                if (index_cache_track_match(&e.tracks[k], t))
+                    break;
+            if (tracks && k == nb_tracks)
+                e.tracks[e.nb_tracks++] = *t;
+            else
+                index_cache_track_free(t);
+        }
+        old->nb_tracks = 0;
+        index_cache_entry_free(old);
+    } else if (i == MOV_INDEX_CACHE_ENTRIES) {
+        // evict the least recently used file
+        index_cache_entry_free(&index_cache[--i]);
+    } else {
+        index_cache_count++;
+    }
+    memmove(&index_cache[1], &index_cache[0], i * sizeof(*index_cache));
+    index_cache[0] = e;
+    ff_mutex_unlock(&index_cache_lock);
+}
+
 static int test_same_origin(const char *src, const char *ref) {
     char src_proto[64];
     char ref_proto[64];
@@ -5506,6 +5947,7 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
 {
     AVStream *st;
     MOVStreamContext *sc;
+    int64_t trak_pos = avio_tell(pb);
     int ret;
 
     st = avformat_new_stream(c->fc, NULL);
@@ -5555,7 +5997,7 @@ static int mov_read_trak(MOVContext *c, AVIOContext *pb, MOVAtom atom)
         c->advanced_editlist_autodisabled = 1;
     }
 
-    mov_build_index(c, st);
+    mov_build_index_cached(c, st, trak_pos, atom.size);
 
 #if CONFIG_IAMFDEC
     if (sc->iamf) {
@@ -8806,6 +9248,9 @@ static int cenc_filter(MOVContext *mov, AVStream* st, MOVStreamContext *sc, AVPa
         }
 
         if (mov->decryption_key) {
+            ret = av_packet_make_writable(pkt);
+            if (ret < 0)
+                return ret;
             return cenc_decrypt(mov, sc, encrypted_sample, pkt->data, pkt->size);
         } else {
             size_t size;
@@ -10564,6 +11009,10 @@ static int mov_read_close(AVFormatContext *s)
     av_freep(&mov->trex_data);
     av_freep(&mov->bitrates);
 
+    for (i = 0; i < mov->nb_index_cache_tracks; i++)
+        index_cache_track_free(&mov->index_cache_tracks[i]);
+    av_freep(&mov->index_cache_tracks);
+
     for (i = 0; i < mov->frag_index.nb_items; i++) {
         MOVFragmentStreamInfo *frag = mov->frag_index.item[i].stream_info;
         for (j = 0; j < mov->frag_index.item[i].nb_stream_info; j++) {
@@ -11073,6 +11522,8 @@ static int mov_read_header(AVFormatContext *s)
         av_log(s, AV_LOG_ERROR, "moov atom not found\n");
         return AVERROR_INVALIDDATA;
     }
+    if (!mov->moov_retry)
+        index_cache_publish(mov);
     av_log(mov->fc, AV_LOG_TRACE, "on_parse_exit_offset=%"PRId64"\n", avio_tell(pb));
 
     if (mov->found_iloc && mov->found_iinf) {
@@ -11609,7 +12060,7 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
         }
 #endif
         else
-            ret = av_get_packet(sc->pb, pkt, sample->size);
+            ret = ff_get_packet_ref(sc->pb, pkt, sample->size);
         if (ret < 0) {
             if (should_retry(sc->pb, ret)) {
                 mov_current_sample_dec(sc);
@@ -11618,6 +12069,9 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
         }
 #ifdef OHOS_SUBTITLE_DEMUXER
         if (st->codecpar->codec_id == AV_CODEC_ID_WEBVTT) {
+            ret = av_packet_make_writable(pkt);
+            if (ret < 0)
+                return ret;
             if (pkt->size >= 8) {
                 uint32_t type = AV_RL32(pkt->data + 4);
                 int payload_size = pkt->size - 8;
@@ -11690,8 +12144,12 @@ static int mov_read_packet(AVFormatContext *s, AVPacket *pkt)
     if (st->discard == AVDISCARD_ALL)
         goto retry;
 
-    if (mov->aax_mode)
+    if (mov->aax_mode) {
+        ret = av_packet_make_writable(pkt);
+        if (ret < 0)
+            return ret;
         aax_filter(pkt->data, pkt->size, mov);
+    }
 
     ret = cenc_filter(mov, st, sc, pkt, current_index);
     if (ret < 0) {
@@ -11964,6 +12422,7 @@ static const AVOption mov_options[] = {
         {.i64 = 0}, 0, 1, FLAGS },
     { "max_stts_delta", "treat offsets above this value as invalid", OFFSET(max_stts_delta), AV_OPT_TYPE_INT, {.i64 = UINT_MAX-48000*10 }, 0, UINT_MAX, .flags = AV_OPT_FLAG_DECODING_PARAM },
     { "interleaved_read", "Interleave packets from multiple tracks at demuxer level", OFFSET(interleaved_read), AV_OPT_TYPE_BOOL, {.i64 = 1 }, 0, 1, .flags = AV_OPT_FLAG_DECODING_PARAM },
+    { "index_cache", "Keep the sample index of opened files in memory and reuse it when they are opened again", OFFSET(index_cache), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, .flags = AV_OPT_FLAG_DECODING_PARAM },
 
     { NULL },
 };
@@ -23,6 +23,7 @@
 #include "config_components.h"
 
 #include "avformat.h"
+#include "avio_internal.h"
 #include "demux.h"
 #include "internal.h"
 #include "rawdec.h"
@@ -37,6 +38,16 @@ int ff_raw_read_partial_packet(AVFormatContext *s, AVPacket *pkt)
 
     size = raw->raw_packet_size;
 
+    ret = ffio_read_ref(s->pb, size, &pkt->buf);
+    if (ret >= 0) {
+        pkt->data         = pkt->buf->data;
+        pkt->size         = ret;
+        pkt->pos          = avio_tell(s->pb) - ret;
+        pkt->stream_index = 0;
+        return ret;
+    } else if (ret != AVERROR(ENOSYS))
+        return ret;
+
     if ((ret = av_new_packet(pkt, size)) < 0)
         return ret;
 
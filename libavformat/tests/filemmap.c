@@ -0,0 +1,191 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/dict.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavcodec/defs.h"
+#include "libavformat/avformat.h"
+#include "libavformat/avio.h"
+
+#define WIDTH     320
+#define HEIGHT    240
+#define NB_FRAMES 10
+#define FRAME_SIZE (WIDTH * HEIGHT * 3)
+
+static void fill_frame(uint8_t *buf, int n)
+{
+    for (int i = 0; i < FRAME_SIZE; i++)
+        buf[i] = i * 7 + n * 13 + (i >> 10);
+}
+
+/* A mov file with its samples in an mdat in front of the moov atom, so the
+ * data following each sample is the next sample or the header. */
+static int write_mov(const char *filename)
+{
+    AVFormatContext *oc = NULL;
+    AVPacket *pkt = av_packet_alloc();
+    AVStream *st;
+    int ret;
+
+    if (!pkt)
+        return AVERROR(ENOMEM);
+
+    ret = avformat_alloc_output_context2(&oc, NULL, "mov", filename);
+    if (ret < 0)
+        goto end;
+    oc->flags |= AVFMT_FLAG_BITEXACT;
+
+    st = avformat_new_stream(oc, NULL);
+    if (!st) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    st->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    st->codecpar->codec_id   = AV_CODEC_ID_RAWVIDEO;
+    st->codecpar->format     = AV_PIX_FMT_RGB24;
+    st->codecpar->width      = WIDTH;
+    st->codecpar->height     = HEIGHT;
+    st->time_base            = (AVRational){ 1, 25 };
+
+    if ((ret = avio_open(&oc->pb, filename, AVIO_FLAG_WRITE)) < 0 ||
+        (ret = avformat_write_header(oc, NULL)) < 0)
+        goto end;
+
+    for (int i = 0; i < NB_FRAMES; i++) {
+        ret = av_new_packet(pkt, FRAME_SIZE);
+        if (ret < 0)
+            goto end;
+        fill_frame(pkt->data, i);
+        pkt->pts = pkt->dts = i;
+        pkt->duration = 1;
+        pkt->flags |= AV_PKT_FLAG_KEY;
+        if ((ret = av_write_frame(oc, pkt)) < 0)
+            goto end;
+    }
+    ret = av_write_trailer(oc);
+
+end:
+    av_packet_free(&pkt);
+    if (oc)
+        avio_closep(&oc->pb);
+    avformat_free_context(oc);
+    return ret;
+}
+
+/* Raw frames, the start of the first one is buffered while opening. */
+static int write_raw(const char *filename)
+{
+    AVIOContext *pb;
+    uint8_t *buf = av_malloc(FRAME_SIZE);
+    int ret;
+
+    if (!buf)
+        return AVERROR(ENOMEM);
+    ret = avio_open(&pb, filename, AVIO_FLAG_WRITE);
+    if (ret >= 0) {
+        for (int i = 0; i < NB_FRAMES; i++) {
+            fill_frame(buf, i);
+            avio_write(pb, buf, FRAME_SIZE);
+        }
+        ret = avio_closep(&pb);
+    }
+    av_free(buf);
+    return ret;
+}
+
+static int read_packets(const char *filename, const char *format, int mmap,
+                        AVPacket **pkts, int *nb_pkts)
+{
+    AVFormatContext *ic = NULL;
+    AVDictionary *opts = NULL;
+    int ret;
+
+    av_dict_set_int(&opts, "mmap", mmap, 0);
+    if (!strcmp(format, "rawvideo")) {
+        av_dict_set(&opts, "video_size", "320x240", 0);
+        av_dict_set(&opts, "pixel_format", "rgb24", 0);
+    }
+    ret = avformat_open_input(&ic, filename, av_find_input_format(format), &opts);
+    av_dict_free(&opts);
+    if (ret < 0)
+        return ret;
+
+    for (*nb_pkts = 0; *nb_pkts < NB_FRAMES + 1; (*nb_pkts)++) {
+        ret = av_read_frame(ic, pkts[*nb_pkts]);
+        if (ret < 0)
+            break;
+    }
+    avformat_close_input(&ic);
+    return ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int test(const char *filename, const char *format)
+{
+    AVPacket *ref[NB_FRAMES + 1] = { NULL }, *pkts[NB_FRAMES + 1] = { NULL };
+    int nb_ref, nb_pkts, lent = 0, identical = 1, padded = 1;
+    int ret = AVERROR(ENOMEM);
+
+    for (int i = 0; i < NB_FRAMES + 1; i++)
+        if (!(ref[i] = av_packet_alloc()) || !(pkts[i] = av_packet_alloc()))
+            goto end;
+
+    if ((ret = read_packets(filename, format, 0, ref,  &nb_ref))  < 0 ||
+        (ret = read_packets(filename, format, 1, pkts, &nb_pkts)) < 0)
+        goto end;
+
+    identical = nb_ref == nb_pkts;
+    for (int i = 0; i < nb_pkts && identical; i++) {
+        const AVPacket *a = ref[i], *b = pkts[i];
+        static const uint8_t zero[AV_INPUT_BUFFER_PADDING_SIZE];
+
+        identical = a->size == b->size && a->pos == b->pos && a->pts == b->pts &&
+                    !memcmp(a->data, b->data, a->size);
+        padded   &= !memcmp(b->data + b->size, zero, sizeof(zero));
+        // packets lent by the protocol are read-only
+        lent     += !av_buffer_is_writable(b->buf);
+    }
+    printf("%s: %d packets, %d lent, data %s, padding %s\n", format, nb_pkts,
+           lent, identical ? "identical" : "differs", padded ? "zero" : "not zero");
+
+end:
+    for (int i = 0; i < NB_FRAMES + 1; i++) {
+        av_packet_free(&ref[i]);
+        av_packet_free(&pkts[i]);
+    }
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <mov file> <raw file>\n", argv[0]);
+        return 1;
+    }
+
+    av_log_set_level(AV_LOG_QUIET);
+
+    if (write_mov(argv[1]) < 0 || test(argv[1], "mov") < 0 ||
+        write_raw(argv[2]) < 0 || test(argv[2], "rawvideo") < 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define _DEFAULT_SOURCE
+#define _BSD_SOURCE
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "config.h"
+#include "libavutil/dict.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+#include "libavformat/avformat.h"
+#include "libavformat/avio.h"
+#include "libavformat/isom.h"
+
+#define NB_FRAMES 10
+
+static int64_t file_mtime(const char *filename)
+{
+    struct stat st;
+    int64_t mtime;
+
+    if (stat(filename, &st) < 0)
+        return 0;
+    mtime = (int64_t)st.st_mtime * 1000000000;
+#if HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+    mtime += st.st_mtim.tv_nsec;
+#endif
+    return mtime;
+}
+
+/* Files written with different frame durations have sample tables of the
+ * same dimensions, the same size and the same moov position. */
+static int write_file(const char *filename, int frame_duration)
+{
+    AVFormatContext *oc = NULL;
+    AVPacket *pkt = av_packet_alloc();
+    AVStream *st;
+    int ret;
+
+    if (!pkt)
+        return AVERROR(ENOMEM);
+
+    ret = avformat_alloc_output_context2(&oc, NULL, "mov", filename);
+    if (ret < 0)
+        goto end;
+    oc->flags |= AVFMT_FLAG_BITEXACT;
+
+    st = avformat_new_stream(oc, NULL);
+    if (!st) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    st->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    st->codecpar->codec_id   = AV_CODEC_ID_MJPEG;
+    st->codecpar->width      = 64;
+    st->codecpar->height     = 64;
+    st->time_base            = (AVRational){ 1, 90000 };
+
+    if ((ret = avio_open(&oc->pb, filename, AVIO_FLAG_WRITE)) < 0 ||
+        (ret = avformat_write_header(oc, NULL)) < 0)
+        goto end;
+
+    for (int i = 0; i < NB_FRAMES; i++) {
+        ret = av_new_packet(pkt, 64);
+        if (ret < 0)
+            goto end;
+        memset(pkt->data, i, pkt->size);
+        pkt->pts = pkt->dts = av_rescale_q(i * frame_duration,
+                                           (AVRational){ 1, 90000 }, st->time_base);
+        pkt->duration = av_rescale_q(frame_duration, (AVRational){ 1, 90000 },
+                                     st->time_base);
+        pkt->flags |= AV_PKT_FLAG_KEY;
+        if ((ret = av_write_frame(oc, pkt)) < 0)
+            goto end;
+    }
+    ret = av_write_trailer(oc);
+
+end:
+    av_packet_free(&pkt);
+    if (oc)
+        avio_closep(&oc->pb);
+    avformat_free_context(oc);
+    return ret;
+}
+
+/* Rewrite the file until its modification time changes, which takes up to
+ * the timestamp granularity of the filesystem. */
+static int rewrite_file(const char *filename, int frame_duration)
+{
+    int64_t mtime = file_mtime(filename);
+    int ret;
+
+    while ((ret = write_file(filename, frame_duration)) >= 0 &&
+           file_mtime(filename) == mtime)
+        av_usleep(10000);
+    return ret;
+}
+
+static int open_file(AVFormatContext **ic, const char *filename,
+                     int index_cache, int ignore_editlist)
+{
+    AVDictionary *opts = NULL;
+    int ret;
+
+    av_dict_set_int(&opts, "index_cache", index_cache, 0);
+    av_dict_set_int(&opts, "ignore_editlist", ignore_editlist, 0);
+    ret = avformat_open_input(ic, filename, NULL, &opts);
+    av_dict_free(&opts);
+    return ret;
+}
+
+static int same_index(AVStream *a, AVStream *b)
+{
+    int nb = avformat_index_get_entries_count(a);
+
+    if (nb != avformat_index_get_entries_count(b))
+        return 0;
+    for (int i = 0; i < nb; i++) {
+        const AVIndexEntry *ea = avformat_index_get_entry(a, i);
+        const AVIndexEntry *eb = avformat_index_get_entry(b, i);
+
+        if (ea->pos          != eb->pos          ||
+            ea->timestamp    != eb->timestamp    ||
+            ea->flags        != eb->flags        ||
+            ea->size         != eb->size         ||
+            ea->min_distance != eb->min_distance)
+            return 0;
+    }
+    return a->start_time == b->start_time && a->duration == b->duration;
+}
+
+static int read_file(const char *filename, const char *name, int ignore_editlist)
+{
+    AVFormatContext *ref = NULL, *ic = NULL;
+    AVPacket *pkt = av_packet_alloc();
+    int ret;
+
+    if (!pkt)
+        return AVERROR(ENOMEM);
+
+    if ((ret = open_file(&ref, filename, 0, ignore_editlist)) < 0 ||
+        (ret = open_file(&ic, filename, 1, ignore_editlist)) < 0)
+        goto end;
+
+    printf("%s, ignore_editlist %d: index %s, %d entries %s, duration %"PRId64"\n",
+           name, ignore_editlist,
+           ff_mov_stream_index_cached(ic->streams[0]) ? "cached" : "built",
+           avformat_index_get_entries_count(ic->streams[0]),
+           same_index(ic->streams[0], ref->streams[0]) ? "identical" : "differ",
+           ic->streams[0]->duration);
+    printf("pts:");
+    while ((ret = av_read_frame(ic, pkt)) >= 0) {
+        printf(" %"PRId64"/%"PRId64"/%d", pkt->pts, pkt->duration, pkt->size);
+        av_packet_unref(pkt);
+    }
+    printf("\n");
+    ret = ret == AVERROR_EOF ? 0 : ret;
+
+end:
+    av_packet_free(&pkt);
+    avformat_close_input(&ref);
+    avformat_close_input(&ic);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const char *filename;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+        return 1;
+    }
+    filename = argv[1];
+
+    av_log_set_level(AV_LOG_QUIET);
+
+    if (write_file(filename, 3600) < 0 ||
+        read_file(filename, "first file",  0) < 0 ||
+        read_file(filename, "first file",  0) < 0 ||
+        // rewritten in place with a different frame rate
+        rewrite_file(filename, 3000) < 0 ||
+        read_file(filename, "second file", 0) < 0 ||
+        read_file(filename, "second file", 1) < 0 ||
+        // both indexes of the file are kept
+        read_file(filename, "second file", 0) < 0 ||
+        read_file(filename, "second file", 1) < 0)
+        return 1;
+
+    return 0;
+}
@@ -26,6 +26,7 @@
 
 #include "avio.h"
 
+#include "libavutil/buffer.h"
 #include "libavutil/dict.h"
 #include "libavutil/log.h"
 
@@ -94,6 +95,18 @@ typedef struct URLProtocol {
     int (*url_delete)(URLContext *h);
     int (*url_move)(URLContext *h_src, URLContext *h_dst);
     const char *default_whitelist;
+
+    /**
+     * Return a reference to size bytes at offset pos without copying them,
+     * e.g. from a memory mapping of the resource. The returned data must be
+     * followed by AV_INPUT_BUFFER_PADDING_SIZE zero bytes and must not be
+     * written to.
+     * Does not change the read position of the protocol.
+     *
+     * @return size on success, AVERROR(ENOSYS) if the range cannot be
+     *         lent, another negative AVERROR code on failure
+     */
+    int (*url_read_ref)(URLContext *h, int64_t pos, int size, AVBufferRef **ref);
 } URLProtocol;
 
 /**
@@ -104,6 +104,24 @@ FF_ENABLE_DEPRECATION_WARNINGS
     return append_packet_chunked(s, pkt, size);
 }
 
+int ff_get_packet_ref(AVIOContext *s, AVPacket *pkt, int size)
+{
+    int64_t pos = avio_tell(s);
+    int ret;
+
+    ret = ffio_read_ref(s, size, &pkt->buf);
+    if (ret == AVERROR(ENOSYS))
+        return av_get_packet(s, pkt, size);
+    if (ret < 0)
+        return ret;
+
+    pkt->data = pkt->buf->data;
+    pkt->size = ret;
+    pkt->pos  = pos;
+
+    return ret;
+}
+
 int av_append_packet(AVIOContext *s, AVPacket *pkt, int size)
 {
     if (!pkt->size)
@@ -284,6 +284,11 @@ AVBufferPool *av_buffer_pool_init2(size_t size, void *opaque,
     pool->alloc     = av_buffer_alloc; // fallback
     pool->pool_free = pool_free;
 
+    for (int i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++) {
+        atomic_init(&pool->cache[i].entry, 0);
+        atomic_init(&pool->cache[i].hits,  0);
+    }
+
     atomic_init(&pool->refcount, 1);
 
     return pool;
@@ -303,13 +308,84 @@ AVBufferPool *av_buffer_pool_init(size_t size, AVBufferRef* (*alloc)(size_t size
     pool->size     = size;
     pool->alloc    = alloc ? alloc : av_buffer_alloc;
 
+    for (int i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++) {
+        atomic_init(&pool->cache[i].entry, 0);
+        atomic_init(&pool->cache[i].hits,  0);
+    }
+
     atomic_init(&pool->refcount, 1);
 
     return pool;
 }
 
+/*
+ * Pick the cache slot to start probing from. Every thread has its own stack,
+ * so hashing the address of a local variable gives each thread a preferred
+ * slot, i.e. buffers tend to be reused by the thread that released them.
+ */
+static unsigned pool_cache_start(void)
+{
+    uintptr_t marker;
+
+    marker = (uintptr_t)&marker;
+    return ((uint32_t)(marker >> 16) * 2654435761U) >> 29;
+}
+
+static BufferPoolEntry *pool_cache_get(AVBufferPool *pool)
+{
+    unsigned start = pool_cache_start();
+
+    for (unsigned i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++) {
+        BufferPoolCacheSlot *slot = &pool->cache[(start + i) % BUFFER_POOL_CACHE_SLOTS];
+        BufferPoolEntry *buf;
+
+        // avoid taking ownership of the cache line for empty slots
+        if (!atomic_load_explicit(&slot->entry, memory_order_relaxed))
+            continue;
+
+        buf = (BufferPoolEntry*)atomic_exchange_explicit(&slot->entry, 0,
+                                                         memory_order_acquire);
+        if (buf) {
+            atomic_fetch_add_explicit(&slot->hits, 1, memory_order_relaxed);
+            return buf;
+        }
+    }
+
+    return NULL;
+}
+
+static int pool_cache_put(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    unsigned start = pool_cache_start();
+
+    for (unsigned i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++) {
+        BufferPoolCacheSlot *slot = &pool->cache[(start + i) % BUFFER_POOL_CACHE_SLOTS];
+        uintptr_t empty = 0;
+
+        if (atomic_load_explicit(&slot->entry, memory_order_relaxed))
+            continue;
+
+        if (atomic_compare_exchange_strong_explicit(&slot->entry, &empty,
+                                                    (uintptr_t)buf,
+                                                    memory_order_release,
+                                                    memory_order_relaxed))
+            return 1;
+    }
+
+    return 0;
+}
+
 static void buffer_pool_flush(AVBufferPool *pool)
 {
+    for (int i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++) {
+        BufferPoolEntry *buf = (BufferPoolEntry*)atomic_exchange_explicit(&pool->cache[i].entry, 0,
+                                                                          memory_order_acquire);
+        if (buf) {
+            buf->free(buf->opaque, buf->data);
+            av_freep(&buf);
+        }
+    }
+
     while (pool->pool) {
         BufferPoolEntry *buf = pool->pool;
         pool->pool = buf->next;
@@ -356,10 +432,13 @@ static void pool_release_buffer(void *opaque, uint8_t *data)
     BufferPoolEntry *buf = opaque;
     AVBufferPool *pool = buf->pool;
 
-    ff_mutex_lock(&pool->mutex);
-    buf->next = pool->pool;
-    pool->pool = buf;
-    ff_mutex_unlock(&pool->mutex);
+    if (!pool_cache_put(pool, buf)) {
+        ff_mutex_lock(&pool->mutex);
+        buf->next = pool->pool;
+        pool->pool = buf;
+        pool->nb_list_release++;
+        ff_mutex_unlock(&pool->mutex);
+    }
 
     if (atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) == 1)
         buffer_pool_free(pool);
@@ -396,33 +475,78 @@ static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
     return ret;
 }
 
+/* create a new reference to a buffer that was returned to the pool */
+static AVBufferRef *pool_reuse_buffer(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    AVBufferRef *ret;
+
+    memset(&buf->buffer, 0, sizeof(buf->buffer));
+    ret = buffer_create(&buf->buffer, buf->data, pool->size,
+                        pool_release_buffer, buf, 0);
+    if (ret)
+        buf->buffer.flags_internal |= BUFFER_FLAG_NO_FREE;
+
+    return ret;
+}
+
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
 {
     AVBufferRef *ret;
     BufferPoolEntry *buf;
 
+    buf = pool_cache_get(pool);
+    if (buf) {
+        ret = pool_reuse_buffer(pool, buf);
+        if (ret)
+            goto done;
+
+        // put it back for the next caller
+        ff_mutex_lock(&pool->mutex);
+        buf->next = pool->pool;
+        pool->pool = buf;
+        ff_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+
     ff_mutex_lock(&pool->mutex);
     buf = pool->pool;
     if (buf) {
-        memset(&buf->buffer, 0, sizeof(buf->buffer));
-        ret = buffer_create(&buf->buffer, buf->data, pool->size,
-                            pool_release_buffer, buf, 0);
+        ret = pool_reuse_buffer(pool, buf);
         if (ret) {
             pool->pool = buf->next;
             buf->next = NULL;
-            buf->buffer.flags_internal |= BUFFER_FLAG_NO_FREE;
+            pool->nb_list_get++;
         }
     } else {
         ret = pool_alloc_buffer(pool);
+        if (ret)
+            pool->nb_alloc++;
     }
     ff_mutex_unlock(&pool->mutex);
 
+done:
     if (ret)
         atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
 
     return ret;
 }
 
+void av_buffer_pool_get_stats(AVBufferPool *pool, AVBufferPoolStats *stats)
+{
+    uint64_t cache_hits = 0;
+
+    for (int i = 0; i < BUFFER_POOL_CACHE_SLOTS; i++)
+        cache_hits += atomic_load_explicit(&pool->cache[i].hits, memory_order_relaxed);
+
+    ff_mutex_lock(&pool->mutex);
+    stats->nb_get            = cache_hits + pool->nb_list_get + pool->nb_alloc;
+    stats->nb_cache_hit      = cache_hits;
+    stats->nb_alloc          = pool->nb_alloc;
+    stats->nb_locked_get     = pool->nb_list_get + pool->nb_alloc;
+    stats->nb_locked_release = pool->nb_list_release;
+    ff_mutex_unlock(&pool->mutex);
+}
+
 void *av_buffer_pool_buffer_get_opaque(const AVBufferRef *ref)
 {
     BufferPoolEntry *buf = ref->buffer->opaque;
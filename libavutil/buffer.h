@@ -302,6 +302,48 @@ void av_buffer_pool_uninit(AVBufferPool **pool);
  */
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool);
 
+/**
+ * Usage statistics of an AVBufferPool, see av_buffer_pool_get_stats().
+ *
+ * Returned buffers are first kept in a small lock-free cache; the pool's mutex
+ * is only taken when the cache is empty on get, or full on release. The number
+ * of locked operations thus indicates how contended the pool can be.
+ */
+typedef struct AVBufferPoolStats {
+    /**
+     * Number of buffers successfully obtained with av_buffer_pool_get().
+     */
+    uint64_t nb_get;
+    /**
+     * Number of av_buffer_pool_get() calls served from the lock-free cache.
+     */
+    uint64_t nb_cache_hit;
+    /**
+     * Number of new buffers allocated because the pool had none available.
+     */
+    uint64_t nb_alloc;
+    /**
+     * Number of av_buffer_pool_get() calls that had to lock the pool, including
+     * those that allocated a new buffer.
+     */
+    uint64_t nb_locked_get;
+    /**
+     * Number of buffers returned to the pool that did not fit into the cache
+     * and had to lock the pool.
+     */
+    uint64_t nb_locked_release;
+} AVBufferPoolStats;
+
+/**
+ * Retrieve the usage statistics of a buffer pool. This function may be called
+ * simultaneously with av_buffer_pool_get() and buffers being released, in which
+ * case the individual counters are not guaranteed to be mutually consistent.
+ *
+ * @param pool the pool to query
+ * @param stats the statistics are written here
+ */
+void av_buffer_pool_get_stats(AVBufferPool *pool, AVBufferPoolStats *stats);
+
 /**
  * Query the original opaque parameter of an allocated buffer in the pool.
  *
@@ -85,10 +85,39 @@ typedef struct BufferPoolEntry {
     AVBuffer buffer;
 } BufferPoolEntry;
 
+/**
+ * Number of lock-free cache slots in each AVBufferPool.
+ */
+#define BUFFER_POOL_CACHE_SLOTS 8
+
+/*
+ * A single-entry lock-free free list. Each slot is padded to its own cache line,
+ * so that threads working with different slots do not contend.
+ */
+typedef struct BufferPoolCacheSlot {
+    /* the cached BufferPoolEntry, 0 if the slot is empty */
+    atomic_uintptr_t entry;
+    /* number of av_buffer_pool_get() calls served from this slot */
+    atomic_uint_least64_t hits;
+
+    uint8_t padding[64 - sizeof(atomic_uintptr_t) - sizeof(atomic_uint_least64_t)];
+} BufferPoolCacheSlot;
+
 struct AVBufferPool {
+    /*
+     * Released buffers are first put into one of the lock-free cache slots,
+     * only when all of those are full they go into the mutex-protected list.
+     */
+    BufferPoolCacheSlot cache[BUFFER_POOL_CACHE_SLOTS];
+
     AVMutex mutex;
     BufferPoolEntry *pool;
 
+    /* Statistics protected by mutex, see AVBufferPoolStats */
+    uint64_t nb_list_get;
+    uint64_t nb_alloc;
+    uint64_t nb_list_release;
+
     /*
      * This is used to track when the pool is to be freed.
      * The pointer to the pool itself held by the caller is considered to
@@ -22,6 +22,7 @@
 
 #include <stdbool.h>
 
+#include "error.h"
 #include "mem.h"
 #include "thread.h"
 
@@ -48,6 +49,12 @@ typedef struct ThreadInfo {
     ExecutorThread thread;
 } ThreadInfo;
 
+typedef struct HeapEntry {
+    AVTask *task;
+    // submission order, the latest of equal priority tasks runs first
+    uint64_t seq;
+} HeapEntry;
+
 struct AVExecutor {
     AVTaskCallbacks cb;
     int thread_count;
@@ -59,7 +66,17 @@ struct AVExecutor {
     AVMutex lock;
     AVCond cond;
     int die;
+    // number of workers blocked on cond
+    int nb_idle;
+
+    // binary max-heap of pending tasks, ordered by cb.priority_higher and seq
+    HeapEntry *heap;
+    unsigned int heap_size;
+    int nb_heap;
+    uint64_t seq;
 
+    // sorted list for tasks which could not be added to the heap, all of
+    // them were submitted after the tasks in the heap
     AVTask *tasks;
 };
 
@@ -76,15 +93,133 @@ static void add_task(AVTask **prev, AVTask *t)
     *prev   = t;
 }
 
-static int run_one_task(AVExecutor *e, void *lc)
+static int entry_higher(const AVExecutor *e, const HeapEntry *a, const HeapEntry *b)
+{
+    if (e->cb.priority_higher(a->task, b->task))
+        return 1;
+    if (e->cb.priority_higher(b->task, a->task))
+        return 0;
+    return a->seq > b->seq;
+}
+
+static void heap_sift_up(AVExecutor *e, int i)
+{
+    HeapEntry *heap = e->heap;
+    HeapEntry t     = heap[i];
+
+    while (i > 0) {
+        const int parent = (i - 1) >> 1;
+        if (!entry_higher(e, &t, &heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        i       = parent;
+    }
+    heap[i] = t;
+}
+
+static void heap_sift_down(AVExecutor *e, int i)
+{
+    HeapEntry *heap = e->heap;
+    HeapEntry t     = heap[i];
+    const int n     = e->nb_heap;
+
+    while (1) {
+        int child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && entry_higher(e, &heap[child + 1], &heap[child]))
+            child++;
+        if (!entry_higher(e, &heap[child], &t))
+            break;
+        heap[i] = heap[child];
+        i       = child;
+    }
+    heap[i] = t;
+}
+
+static int heap_push(AVExecutor *e, AVTask *t)
+{
+    if (e->nb_heap >= e->heap_size / sizeof(*e->heap)) {
+        HeapEntry *heap = av_fast_realloc(e->heap, &e->heap_size,
+                                          (e->nb_heap + 1) * sizeof(*e->heap));
+        if (!heap)
+            return AVERROR(ENOMEM);
+        e->heap = heap;
+    }
+    e->heap[e->nb_heap++] = (HeapEntry){ .task = t, .seq = e->seq++ };
+    heap_sift_up(e, e->nb_heap - 1);
+    return 0;
+}
+
+static AVTask *heap_remove(AVExecutor *e, int i)
+{
+    AVTask *t = e->heap[i].task;
+
+    if (i < --e->nb_heap) {
+        e->heap[i] = e->heap[e->nb_heap];
+        if (i && entry_higher(e, &e->heap[i], &e->heap[(i - 1) >> 1]))
+            heap_sift_up(e, i);
+        else
+            heap_sift_down(e, i);
+    }
+    t->next = NULL;
+    return t;
+}
+
+static void queue_task(AVExecutor *e, AVTask *t)
+{
+    AVTask **prev;
+
+    // once a task is in the list, later ones must go there too, so that
+    // all listed tasks are newer than the heap ones
+    if (!e->tasks && heap_push(e, t) >= 0)
+        return;
+
+    // out of memory, fall back to the sorted list
+    for (prev = &e->tasks; *prev && e->cb.priority_higher(*prev, t); prev = &(*prev)->next)
+        /* nothing */;
+    add_task(prev, t);
+}
+
+/**
+ * Get the highest priority task which is ready to run.
+ *
+ * This is O(log n) when the top of the heap is ready, otherwise the heap is
+ * scanned for the best ready task without being reordered.
+ */
+static AVTask *get_ready_task(AVExecutor *e)
 {
     AVTaskCallbacks *cb = &e->cb;
     AVTask **prev;
+    int best = -1;
+
+    if (e->nb_heap && cb->ready(e->heap[0].task, cb->user_data)) {
+        best = 0;
+    } else {
+        for (int i = 1; i < e->nb_heap; i++) {
+            if ((best < 0 || entry_higher(e, &e->heap[i], &e->heap[best])) &&
+                cb->ready(e->heap[i].task, cb->user_data))
+                best = i;
+        }
+    }
 
     for (prev = &e->tasks; *prev && !cb->ready(*prev, cb->user_data); prev = &(*prev)->next)
         /* nothing */;
-    if (*prev) {
-        AVTask *t = remove_task(prev, *prev);
+
+    // on equal priority the list wins, its tasks were submitted last
+    if (best >= 0 && (!*prev || cb->priority_higher(e->heap[best].task, *prev)))
+        return heap_remove(e, best);
+    if (*prev)
+        return remove_task(prev, *prev);
+    return NULL;
+}
+
+static int run_one_task(AVExecutor *e, void *lc)
+{
+    AVTaskCallbacks *cb = &e->cb;
+    AVTask *t = get_ready_task(e);
+
+    if (t) {
         if (e->thread_count > 0)
             ff_mutex_unlock(&e->lock);
         cb->run(t, lc, cb->user_data);
@@ -108,7 +243,9 @@ static void *executor_worker_task(void *data)
 
         if (!run_one_task(e, lc)) {
             //no task in one loop
+            e->nb_idle++;
             ff_cond_wait(&e->cond, &e->lock);
+            e->nb_idle--;
         }
     }
     ff_mutex_unlock(&e->lock);
@@ -135,6 +272,7 @@ static void executor_free(AVExecutor *e, const int has_lock, const int has_cond)
 
     av_free(e->threads);
     av_free(e->local_contexts);
+    av_free(e->heap);
 
     av_free(e);
 }
@@ -194,18 +332,14 @@ void av_executor_free(AVExecutor **executor)
 
 void av_executor_execute(AVExecutor *e, AVTask *t)
 {
-    AVTaskCallbacks *cb = &e->cb;
-    AVTask **prev;
-
     if (e->thread_count)
         ff_mutex_lock(&e->lock);
-    if (t) {
-        for (prev = &e->tasks; *prev && cb->priority_higher(*prev, t); prev = &(*prev)->next)
-            /* nothing */;
-        add_task(prev, t);
-    }
+    if (t)
+        queue_task(e, t);
     if (e->thread_count) {
-        ff_cond_signal(&e->cond);
+        // busy workers will pick the task up when they finish their current one
+        if (e->nb_idle)
+            ff_cond_signal(&e->cond);
         ff_mutex_unlock(&e->lock);
     }
 
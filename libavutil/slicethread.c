@@ -22,6 +22,7 @@
 #include "slicethread.h"
 #include "mem.h"
 #include "thread.h"
+#include "threadpool.h"
 #include "avassert.h"
 
 #define MAX_AUTO_THREADS 16
@@ -36,8 +37,31 @@ typedef struct WorkerContext {
     int             done;
 } WorkerContext;
 
+typedef struct SliceThreadPool {
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    pthread_t       *threads;
+    int             nb_threads;
+    int             finished;
+
+    // contexts using the pool, protected by shared_pool_lock
+    int             refcount;
+
+    // round-robin queue of contexts with unclaimed jobs, protected by mutex
+    AVSliceThread   *head;
+    AVSliceThread   *tail;
+} SliceThreadPool;
+
+static AVMutex shared_pool_lock = AV_MUTEX_INITIALIZER;
+static SliceThreadPool *shared_pool;
+
 struct AVSliceThread {
     WorkerContext   *workers;
+    SliceThreadPool *pool;
+    // number of run_jobs() calls the pool still owes us, protected by pool->mutex
+    int             nb_pending;
+    int             queued;
+    AVSliceThread   *next;
     int             nb_threads;
     int             nb_active_threads;
     int             nb_jobs;
@@ -61,13 +85,28 @@ static int run_jobs(AVSliceThread *ctx)
     unsigned first_job    = atomic_fetch_add_explicit(&ctx->first_job, 1, memory_order_acq_rel);
     unsigned current_job  = first_job;
 
-    do {
+    /* With a shared pool some callers of this function may start late, so
+     * do not reserve a job for each of them. Taking all jobs in order ensures
+     * a job waiting on lower numbered ones never waits for one not started. */
+    if (ctx->pool)
+        current_job = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel);
+
+    while (current_job < nb_jobs) {
         ctx->worker_func(ctx->priv, current_job, first_job, nb_jobs, nb_active_threads);
-    } while ((current_job = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel)) < nb_jobs);
+        current_job = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel);
+    }
 
     return current_job == nb_jobs + nb_active_threads - 1;
 }
 
+static void job_done(AVSliceThread *ctx)
+{
+    pthread_mutex_lock(&ctx->done_mutex);
+    ctx->done = 1;
+    pthread_cond_signal(&ctx->done_cond);
+    pthread_mutex_unlock(&ctx->done_mutex);
+}
+
 static void *attribute_align_arg thread_worker(void *v)
 {
     WorkerContext *w = v;
@@ -86,19 +125,209 @@ static void *attribute_align_arg thread_worker(void *v)
             return NULL;
         }
 
-        if (run_jobs(ctx)) {
-            pthread_mutex_lock(&ctx->done_mutex);
-            ctx->done = 1;
-            pthread_cond_signal(&ctx->done_cond);
-            pthread_mutex_unlock(&ctx->done_mutex);
+        if (run_jobs(ctx))
+            job_done(ctx);
+    }
+}
+
+static void *attribute_align_arg pool_worker(void *v)
+{
+    SliceThreadPool *pool = v;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (1) {
+        AVSliceThread *ctx;
+
+        while (!pool->head && !pool->finished)
+            pthread_cond_wait(&pool->cond, &pool->mutex);
+        if (!pool->head)
+            break;
+
+        // take one job slot and move the context to the back of the queue,
+        // so that no single context can monopolize the pool
+        ctx        = pool->head;
+        pool->head = ctx->next;
+        if (--ctx->nb_pending) {
+            ctx->next = NULL;
+            if (pool->head)
+                pool->tail->next = ctx;
+            else
+                pool->head = ctx;
+            pool->tail = ctx;
+        } else {
+            ctx->queued = 0;
         }
+        pthread_mutex_unlock(&pool->mutex);
+
+        if (run_jobs(ctx))
+            job_done(ctx);
+
+        pthread_mutex_lock(&pool->mutex);
     }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
 }
 
-int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
+static void pool_free(SliceThreadPool *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->finished = 1;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->mutex);
+    av_free(pool->threads);
+    av_free(pool);
+}
+
+static int pool_alloc(SliceThreadPool **ppool, int nb_threads)
+{
+    SliceThreadPool *pool;
+    int ret;
+
+    pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return AVERROR(ENOMEM);
+
+    pool->threads = av_calloc(nb_threads, sizeof(*pool->threads));
+    if (!pool->threads) {
+        av_free(pool);
+        return AVERROR(ENOMEM);
+    }
+
+    ret = pthread_mutex_init(&pool->mutex, NULL);
+    if (ret) {
+        av_free(pool->threads);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+    ret = pthread_cond_init(&pool->cond, NULL);
+    if (ret) {
+        pthread_mutex_destroy(&pool->mutex);
+        av_free(pool->threads);
+        av_free(pool);
+        return AVERROR(ret);
+    }
+
+    for (; pool->nb_threads < nb_threads; pool->nb_threads++) {
+        ret = pthread_create(&pool->threads[pool->nb_threads], NULL, pool_worker, pool);
+        if (ret) {
+            pool_free(pool);
+            return AVERROR(ret);
+        }
+    }
+
+    pool->refcount = 1;
+    *ppool = pool;
+    return 0;
+}
+
+static void pool_unref(SliceThreadPool **ppool)
+{
+    SliceThreadPool *pool = *ppool;
+    int refcount;
+
+    if (!pool)
+        return;
+
+    ff_mutex_lock(&shared_pool_lock);
+    refcount = --pool->refcount;
+    ff_mutex_unlock(&shared_pool_lock);
+
+    if (!refcount)
+        pool_free(pool);
+    *ppool = NULL;
+}
+
+int av_thread_pool_set_shared(int nb_threads)
+{
+    SliceThreadPool *pool = NULL, *old;
+    int ret;
+
+    if (nb_threads < 0)
+        return AVERROR(EINVAL);
+
+    if (nb_threads) {
+        ret = pool_alloc(&pool, nb_threads);
+        if (ret < 0)
+            return ret;
+    }
+
+    ff_mutex_lock(&shared_pool_lock);
+    old         = shared_pool;
+    shared_pool = pool;
+    ff_mutex_unlock(&shared_pool_lock);
+
+    pool_unref(&old);
+    return 0;
+}
+
+/**
+ * Hand nb_workers run_jobs() calls for ctx to the pool, run our own share of
+ * the work and then take back whatever the pool did not get to yet.
+ */
+static int pool_execute(AVSliceThread *ctx, int nb_workers, int execute_main)
+{
+    SliceThreadPool *pool = ctx->pool;
+    int is_last = 0;
+
+    if (nb_workers) {
+        pthread_mutex_lock(&pool->mutex);
+        ctx->nb_pending = nb_workers;
+        ctx->queued     = 1;
+        ctx->next       = NULL;
+        if (pool->head)
+            pool->tail->next = ctx;
+        else
+            pool->head = ctx;
+        pool->tail = ctx;
+        for (int i = 0; i < FFMIN(nb_workers, pool->nb_threads); i++)
+            pthread_cond_signal(&pool->cond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    if (ctx->main_func && execute_main)
+        ctx->main_func(ctx->priv);
+    else
+        is_last = run_jobs(ctx);
+
+    if (nb_workers) {
+        int nb_left;
+
+        pthread_mutex_lock(&pool->mutex);
+        nb_left = ctx->nb_pending;
+        if (ctx->queued) {
+            AVSliceThread **prev = &pool->head, *last = NULL;
+
+            while (*prev != ctx) {
+                last = *prev;
+                prev = &(*prev)->next;
+            }
+            *prev = ctx->next;
+            if (pool->tail == ctx)
+                pool->tail = last;
+            ctx->queued = 0;
+        }
+        ctx->nb_pending = 0;
+        pthread_mutex_unlock(&pool->mutex);
+
+        // the completion count expects one call per pending slot
+        while (nb_left--)
+            is_last |= run_jobs(ctx);
+    }
+
+    return is_last;
+}
+
+static int slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
                               void (*main_func)(void *priv),
-                              int nb_threads)
+                              int nb_threads, int use_shared_pool)
 {
     AVSliceThread *ctx;
     int nb_workers, i;
@@ -150,6 +379,17 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     }
     ctx->done        = 0;
 
+    ff_mutex_lock(&shared_pool_lock);
+    if (shared_pool && use_shared_pool) {
+        ctx->pool = shared_pool;
+        ctx->pool->refcount++;
+    }
+    ff_mutex_unlock(&shared_pool_lock);
+    if (ctx->pool) {
+        av_freep(&ctx->workers);
+        return nb_threads;
+    }
+
     for (i = 0; i < nb_workers; i++) {
         WorkerContext *w = &ctx->workers[i];
         int ret;
@@ -187,6 +427,22 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return nb_threads;
 }
 
+int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
+                              void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                              void (*main_func)(void *priv),
+                              int nb_threads)
+{
+    return slicethread_create(pctx, priv, worker_func, main_func, nb_threads, 1);
+}
+
+int avpriv_slicethread_create_private(AVSliceThread **pctx, void *priv,
+                                      void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                      void (*main_func)(void *priv),
+                                      int nb_threads)
+{
+    return slicethread_create(pctx, priv, worker_func, main_func, nb_threads, 0);
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     int nb_workers, i, is_last = 0;
@@ -195,23 +451,27 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
     ctx->nb_jobs           = nb_jobs;
     ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
-    atomic_store_explicit(&ctx->current_job, ctx->nb_active_threads, memory_order_relaxed);
+    atomic_store_explicit(&ctx->current_job, ctx->pool ? 0 : ctx->nb_active_threads, memory_order_relaxed);
     nb_workers             = ctx->nb_active_threads;
     if (!ctx->main_func || !execute_main)
         nb_workers--;
 
-    for (i = 0; i < nb_workers; i++) {
-        WorkerContext *w = &ctx->workers[i];
-        pthread_mutex_lock(&w->mutex);
-        w->done = 0;
-        pthread_cond_signal(&w->cond);
-        pthread_mutex_unlock(&w->mutex);
-    }
+    if (ctx->pool) {
+        is_last = pool_execute(ctx, nb_workers, execute_main);
+    } else {
+        for (i = 0; i < nb_workers; i++) {
+            WorkerContext *w = &ctx->workers[i];
+            pthread_mutex_lock(&w->mutex);
+            w->done = 0;
+            pthread_cond_signal(&w->cond);
+            pthread_mutex_unlock(&w->mutex);
+        }
 
-    if (ctx->main_func && execute_main)
-        ctx->main_func(ctx->priv);
-    else
-        is_last = run_jobs(ctx);
+        if (ctx->main_func && execute_main)
+            ctx->main_func(ctx->priv);
+        else
+            is_last = run_jobs(ctx);
+    }
 
     if (!is_last) {
         pthread_mutex_lock(&ctx->done_mutex);
@@ -234,6 +494,10 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
     nb_workers = ctx->nb_threads;
     if (!ctx->main_func)
         nb_workers--;
+    if (ctx->pool) {
+        pool_unref(&ctx->pool);
+        nb_workers = 0;
+    }
 
     ctx->finished = 1;
     for (i = 0; i < nb_workers; i++) {
@@ -268,6 +532,15 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return AVERROR(ENOSYS);
 }
 
+int avpriv_slicethread_create_private(AVSliceThread **pctx, void *priv,
+                                      void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                      void (*main_func)(void *priv),
+                                      int nb_threads)
+{
+    *pctx = NULL;
+    return AVERROR(ENOSYS);
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     av_assert0(0);
@@ -278,4 +551,9 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
     av_assert0(!pctx || !*pctx);
 }
 
+int av_thread_pool_set_shared(int nb_threads)
+{
+    return nb_threads ? AVERROR(ENOSYS) : 0;
+}
+
 #endif /* HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS32THREADS */
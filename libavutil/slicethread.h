@@ -35,6 +35,17 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*main_func)(void *priv),
                               int nb_threads);
 
+/**
+ * Create slice threading context with its own threads, even when the shared
+ * thread pool is enabled. Needed when jobs may wait for each other or for
+ * other threads.
+ * @see avpriv_slicethread_create()
+ */
+int avpriv_slicethread_create_private(AVSliceThread **pctx, void *priv,
+                                      void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                      void (*main_func)(void *priv),
+                                      int nb_threads);
+
 /**
  * Execute slice threading.
  * @param ctx slice threading context
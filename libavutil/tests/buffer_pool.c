@@ -0,0 +1,102 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+
+#define NB_BUFFERS 12
+#define BUF_SIZE   1024
+
+static void print_stats(AVBufferPool *pool, const char *step)
+{
+    AVBufferPoolStats stats;
+
+    av_buffer_pool_get_stats(pool, &stats);
+    printf("%-8s get %"PRIu64" cache_hit %"PRIu64" alloc %"PRIu64
+           " locked_get %"PRIu64" locked_release %"PRIu64"\n", step,
+           stats.nb_get, stats.nb_cache_hit, stats.nb_alloc,
+           stats.nb_locked_get, stats.nb_locked_release);
+}
+
+static int get_buffers(AVBufferPool *pool, AVBufferRef **bufs, int nb_bufs)
+{
+    for (int i = 0; i < nb_bufs; i++) {
+        bufs[i] = av_buffer_pool_get(pool);
+        if (!bufs[i] || bufs[i]->size != BUF_SIZE)
+            return 1;
+
+        for (int j = 0; j < i; j++)
+            if (bufs[j]->data == bufs[i]->data) {
+                printf("buffer %d handed out twice\n", i);
+                return 1;
+            }
+
+        memset(bufs[i]->data, i, BUF_SIZE);
+    }
+    return 0;
+}
+
+static void release_buffers(AVBufferRef **bufs, int nb_bufs)
+{
+    for (int i = 0; i < nb_bufs; i++)
+        av_buffer_unref(&bufs[i]);
+}
+
+int main(void)
+{
+    AVBufferRef *bufs[NB_BUFFERS];
+    AVBufferPool *pool;
+
+    pool = av_buffer_pool_init(BUF_SIZE, NULL);
+    if (!pool)
+        return 1;
+
+    print_stats(pool, "init");
+
+    if (get_buffers(pool, bufs, NB_BUFFERS))
+        return 1;
+    print_stats(pool, "alloc");
+
+    release_buffers(bufs, NB_BUFFERS);
+    print_stats(pool, "release");
+
+    // the returned buffers must be reused, partially from the cache
+    if (get_buffers(pool, bufs, NB_BUFFERS))
+        return 1;
+    print_stats(pool, "reuse");
+
+    release_buffers(bufs, NB_BUFFERS / 2);
+    if (get_buffers(pool, bufs, NB_BUFFERS / 2))
+        return 1;
+    print_stats(pool, "partial");
+
+    // buffers still in use must survive the pool being uninitialized
+    av_buffer_pool_uninit(&pool);
+    for (int i = 0; i < NB_BUFFERS; i++)
+        for (int j = 0; j < BUF_SIZE; j++)
+            if (bufs[i]->data[j] != i) {
+                printf("buffer %d corrupted\n", i);
+                return 1;
+            }
+    release_buffers(bufs, NB_BUFFERS);
+
+    return 0;
+}
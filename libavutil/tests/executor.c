@@ -0,0 +1,183 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+
+#include "libavutil/executor.h"
+#include "libavutil/thread.h"
+
+#define NB_ORDER_TASKS    24
+#define NB_THREADED_TASKS 2000
+
+typedef struct TestTask {
+    AVTask task;
+    int id;
+    int priority;
+    // number of tasks which must have run before this one is ready
+    int after;
+} TestTask;
+
+typedef struct TestContext {
+    AVExecutor *e;
+    TestTask tasks[NB_THREADED_TASKS + 1];
+    int nb_run;
+
+    AVMutex lock;
+    AVCond cond;
+    int sum;
+} TestContext;
+
+static int priority_higher(const AVTask *_a, const AVTask *_b)
+{
+    const TestTask *a = (const TestTask*)_a;
+    const TestTask *b = (const TestTask*)_b;
+
+    // the latest of equal priority tasks must run first
+    return a->priority > b->priority;
+}
+
+static int order_ready(const AVTask *_t, void *user_data)
+{
+    const TestTask    *t = (const TestTask*)_t;
+    const TestContext *c = user_data;
+
+    return c->nb_run >= t->after;
+}
+
+static int order_run(AVTask *_t, void *local_context, void *user_data)
+{
+    TestTask    *t = (TestTask*)_t;
+    TestContext *c = user_data;
+
+    if (t->id < 0) {
+        // the root task queues all others, they only start once it returns
+        unsigned seed = 1;
+        for (int i = 0; i < NB_ORDER_TASKS; i++) {
+            TestTask *n = &c->tasks[i];
+
+            seed = seed * 1664525 + 1013904223;
+            n->id       = i;
+            n->priority = (seed >> 24) % 8;
+            n->after    = i % 5 == 4 ? NB_ORDER_TASKS - 4 : 0;
+            av_executor_execute(c->e, &n->task);
+        }
+        return 0;
+    }
+
+    printf("task %2d priority %d after %2d\n", t->id, t->priority, t->after);
+    c->nb_run++;
+    return 0;
+}
+
+static int test_order(void)
+{
+    static TestContext c;
+    const AVTaskCallbacks cb = {
+        .user_data       = &c,
+        .priority_higher = priority_higher,
+        .ready           = order_ready,
+        .run             = order_run,
+    };
+    TestTask *root = &c.tasks[NB_THREADED_TASKS];
+
+    c.e = av_executor_alloc(&cb, 0);
+    if (!c.e)
+        return 1;
+
+    root->id = -1;
+    av_executor_execute(c.e, &root->task);
+    av_executor_free(&c.e);
+
+    printf("ran %d tasks\n", c.nb_run);
+    return c.nb_run != NB_ORDER_TASKS;
+}
+
+static int threaded_ready(const AVTask *t, void *user_data)
+{
+    return 1;
+}
+
+static int threaded_run(AVTask *_t, void *local_context, void *user_data)
+{
+    TestTask    *t = (TestTask*)_t;
+    TestContext *c = user_data;
+    int *nb_local  = local_context;
+
+    (*nb_local)++;
+
+    ff_mutex_lock(&c->lock);
+    c->sum += t->id;
+    if (++c->nb_run == NB_THREADED_TASKS)
+        ff_cond_signal(&c->cond);
+    ff_mutex_unlock(&c->lock);
+    return 0;
+}
+
+static int test_threaded(int thread_count)
+{
+    static TestContext c;
+    const AVTaskCallbacks cb = {
+        .user_data          = &c,
+        .local_context_size = sizeof(int),
+        .priority_higher    = priority_higher,
+        .ready              = threaded_ready,
+        .run                = threaded_run,
+    };
+    int expected = 0;
+
+    c.nb_run = c.sum = 0;
+    ff_mutex_init(&c.lock, NULL);
+    ff_cond_init(&c.cond, NULL);
+
+    c.e = av_executor_alloc(&cb, thread_count);
+    if (!c.e)
+        return 1;
+
+    for (int i = 0; i < NB_THREADED_TASKS; i++) {
+        TestTask *t = &c.tasks[i];
+
+        t->id       = i;
+        t->priority = i % 7;
+        expected   += i;
+        av_executor_execute(c.e, &t->task);
+    }
+
+    ff_mutex_lock(&c.lock);
+    while (c.nb_run < NB_THREADED_TASKS)
+        ff_cond_wait(&c.cond, &c.lock);
+    ff_mutex_unlock(&c.lock);
+
+    av_executor_free(&c.e);
+    ff_cond_destroy(&c.cond);
+    ff_mutex_destroy(&c.lock);
+
+    printf("threads %d: ran %d tasks, sum %s\n", thread_count, c.nb_run,
+           c.sum == expected ? "ok" : "mismatch");
+    return c.sum != expected;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    ret |= test_order();
+    ret |= test_threaded(0);
+    ret |= test_threaded(4);
+
+    return ret;
+}
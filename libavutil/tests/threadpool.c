@@ -0,0 +1,144 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+
+#include "config.h"
+
+#include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+
+#define NB_CONTEXTS 6
+#define NB_JOBS     24
+#define NB_ROUNDS   50
+
+typedef struct TestContext {
+    AVSliceThread *st;
+    int id;
+    int nb_threads;
+
+    AVMutex lock;
+    AVCond cond;
+    int done[NB_JOBS];
+    int runs[NB_JOBS];
+    int main_runs;
+    int errors;
+} TestContext;
+
+static void worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    TestContext *c = priv;
+
+    ff_mutex_lock(&c->lock);
+    // each job depends on the one before it, like the rows of a wavefront
+    while (jobnr && !c->done[jobnr - 1])
+        ff_cond_wait(&c->cond, &c->lock);
+    if (c->done[jobnr] || nb_jobs != NB_JOBS || nb_threads > c->nb_threads)
+        c->errors++;
+    c->done[jobnr] = 1;
+    c->runs[jobnr]++;
+    ff_cond_broadcast(&c->cond);
+    ff_mutex_unlock(&c->lock);
+}
+
+static void main_func(void *priv)
+{
+    TestContext *c = priv;
+
+    c->main_runs++;
+}
+
+static void *caller(void *arg)
+{
+    TestContext *c = arg;
+
+    for (int round = 0; round < NB_ROUNDS; round++) {
+        ff_mutex_lock(&c->lock);
+        for (int i = 0; i < NB_JOBS; i++)
+            c->done[i] = 0;
+        ff_mutex_unlock(&c->lock);
+
+        avpriv_slicethread_execute(c->st, NB_JOBS, 1);
+
+        ff_mutex_lock(&c->lock);
+        for (int i = 0; i < NB_JOBS; i++)
+            if (!c->done[i])
+                c->errors++;
+        ff_mutex_unlock(&c->lock);
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+#if HAVE_THREADS
+    static TestContext ctx[NB_CONTEXTS];
+    pthread_t threads[NB_CONTEXTS];
+    int ret = 0;
+
+    for (int i = 0; i < NB_CONTEXTS; i++) {
+        TestContext *c = &ctx[i];
+
+        // contexts are spread over two pools, the second replacing the first
+        if (!i || i == NB_CONTEXTS / 2) {
+            if (av_thread_pool_set_shared(i ? 3 : 2) < 0)
+                return 1;
+        }
+
+        c->id = i;
+        ff_mutex_init(&c->lock, NULL);
+        ff_cond_init(&c->cond, NULL);
+        c->nb_threads = avpriv_slicethread_create(&c->st, c, worker,
+                                                  i & 1 ? main_func : NULL, 4);
+        if (c->nb_threads < 0)
+            return 1;
+    }
+    // the pools stay alive as long as contexts are using them
+    av_thread_pool_set_shared(0);
+
+    for (int i = 0; i < NB_CONTEXTS; i++)
+        if (pthread_create(&threads[i], NULL, caller, &ctx[i]))
+            return 1;
+    for (int i = 0; i < NB_CONTEXTS; i++)
+        pthread_join(threads[i], NULL);
+
+    for (int i = 0; i < NB_CONTEXTS; i++) {
+        TestContext *c = &ctx[i];
+
+        for (int j = 0; j < NB_JOBS; j++)
+            if (c->runs[j] != NB_ROUNDS)
+                c->errors++;
+        if (c->main_runs != (i & 1 ? NB_ROUNDS : 0))
+            c->errors++;
+
+        printf("context %d: %d threads, main function %s, %s\n", i, c->nb_threads,
+               i & 1 ? "yes" : "no", c->errors ? "FAILED" : "ok");
+        ret |= !!c->errors;
+
+        avpriv_slicethread_free(&c->st);
+        ff_cond_destroy(&c->cond);
+        ff_mutex_destroy(&c->lock);
+    }
+
+    return ret;
+#else
+    return 0;
+#endif
+}
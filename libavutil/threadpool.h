@@ -0,0 +1,68 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+/**
+ * @file
+ * @ingroup lavu_thread_pool
+ * Process-wide worker pool for slice threading.
+ */
+
+/**
+ * @defgroup lavu_thread_pool Shared thread pool
+ * @ingroup lavu_misc
+ *
+ * By default every codec context using slice threading, every filtergraph
+ * and every multithreaded scaler creates its own set of worker threads, so
+ * the number of threads in a process grows with the number of streams it
+ * handles. Enabling the shared pool makes all of them submit their slice jobs
+ * to a single bounded set of workers instead. The pool serves the contexts
+ * with pending jobs in turn. A thread that starts jobs on a context also runs
+ * them itself, so the jobs complete even when all pool workers are busy.
+ *
+ * Jobs run on the pool must not wait for anything other than lower numbered
+ * jobs of the same call, as a job blocking for long holds a worker that all
+ * other contexts share. Frame threading in libavcodec and pipeline threading
+ * in libavfilter keep their own threads for that reason: they wait for each
+ * other.
+ *
+ * @{
+ */
+
+/**
+ * Set the process-wide slice threading pool.
+ *
+ * Slice threading contexts created after this call use the new pool, contexts
+ * created earlier keep using whatever they were created with. A replaced pool
+ * is destroyed once the last context using it is freed.
+ *
+ * This function is thread-safe.
+ *
+ * @param nb_threads number of worker threads in the pool, 0 to disable the
+ *                   shared pool so new contexts create their own threads again
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int av_thread_pool_set_shared(int nb_threads);
+
+/**
+ * @}
+ */
+
+#endif /* AVUTIL_THREADPOOL_H */
@@ -30,6 +30,11 @@
      ((x) == AV_TX_DOUBLE_ ## type) || \
      ((x) == AV_TX_INT32_ ## type))
 
+#define TYPE_IS_DOUBLE(x)                                          \
+    (((x) == AV_TX_DOUBLE_FFT)   || ((x) == AV_TX_DOUBLE_MDCT)  || \
+     ((x) == AV_TX_DOUBLE_RDFT)  || ((x) == AV_TX_DOUBLE_DCT)   || \
+     ((x) == AV_TX_DOUBLE_DCT_I) || ((x) == AV_TX_DOUBLE_DST_I))
+
 /* Calculates the modular multiplicative inverse */
 static av_always_inline int mulinv(int n, int m)
 {
@@ -284,6 +289,8 @@ static void reset_ctx(AVTXContext *s, int free_sub)
      * ff_tx_init_subtx() call is made. */
     s->nb_sub = 0;
     s->opaque = NULL;
+    s->tmp_size = 0;
+    s->exp_tmp_size = 0;
     memset(s->fn, 0, sizeof(*s->fn));
 }
 
@@ -292,13 +299,193 @@ void ff_tx_clear_ctx(AVTXContext *s)
     reset_ctx(s, 0);
 }
 
+/* Plans which no context uses anymore are kept around, up to this many,
+ * so that transforms which are repeatedly created and destroyed are only
+ * ever initialized once. */
+#define TX_PLAN_MAX_IDLE 32
+
+/**
+ * A fully initialized transform tree. Contexts returned by av_tx_init() are
+ * clones of it, which share its read-only tables and only allocate their own
+ * temporary buffers.
+ */
+typedef struct TXPlan {
+    struct TXPlan *next;
+    AVTXContext   *ctx;
+    av_tx_fn       fn;
+    unsigned       refcount;            /* Number of contexts using the plan */
+
+    enum AVTXType  type;
+    int            inv;
+    int            len;
+    uint64_t       flags;
+    int            cpu_flags;
+    int            has_scale;
+    double         scale;
+} TXPlan;
+
+static AVMutex plan_mutex = AV_MUTEX_INITIALIZER;
+static TXPlan *plan_list;               /* Most recently used first */
+
+/* Frees all the buffers owned by a clone, but none of the shared tables */
+static void free_clone(AVTXContext *s)
+{
+    if (s->sub) {
+        for (int i = 0; i < s->nb_sub; i++)
+            free_clone(&s->sub[i]);
+        av_freep(&s->sub);
+    }
+
+    av_freep(&s->tmp);
+    if (s->exp_tmp_size)
+        av_freep(&s->exp);
+}
+
+static int clone_ctx(AVTXContext *dst, const AVTXContext *src)
+{
+    *dst = *src;
+    dst->sub = NULL;
+    dst->tmp = NULL;
+    if (src->exp_tmp_size)
+        dst->exp = NULL;
+
+    if (src->tmp_size && !(dst->tmp = av_mallocz(src->tmp_size)))
+        return AVERROR(ENOMEM);
+    if (src->exp_tmp_size && !(dst->exp = av_mallocz(src->exp_tmp_size)))
+        return AVERROR(ENOMEM);
+
+    if (src->sub) {
+        if (!(dst->sub = av_calloc(TX_MAX_SUB, sizeof(*dst->sub))))
+            return AVERROR(ENOMEM);
+        for (int i = 0; i < src->nb_sub; i++) {
+            int ret = clone_ctx(&dst->sub[i], &src->sub[i]);
+            if (ret < 0)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+static void plan_free(TXPlan **plan)
+{
+    if (!*plan)
+        return;
+
+    reset_ctx((*plan)->ctx, 1);
+    av_freep(&(*plan)->ctx);
+    av_freep(plan);
+}
+
+static int plan_match(const TXPlan *a, const TXPlan *b)
+{
+    return a->type == b->type && a->inv == b->inv && a->len == b->len &&
+           a->flags == b->flags && a->cpu_flags == b->cpu_flags &&
+           a->has_scale == b->has_scale && (!a->has_scale || a->scale == b->scale);
+}
+
+/* Must be called with plan_mutex held, references the returned plan */
+static TXPlan *plan_find(const TXPlan *key)
+{
+    for (TXPlan **prev = &plan_list; *prev; prev = &(*prev)->next) {
+        TXPlan *plan = *prev;
+
+        if (!plan_match(plan, key))
+            continue;
+
+        *prev      = plan->next;
+        plan->next = plan_list;
+        plan_list  = plan;
+        plan->refcount++;
+        return plan;
+    }
+
+    return NULL;
+}
+
+static void plan_unref(TXPlan *plan)
+{
+    TXPlan *evict = NULL;
+    int nb_idle = 0;
+
+    ff_mutex_lock(&plan_mutex);
+    if (!--plan->refcount) {
+        TXPlan **last_idle = NULL;
+
+        for (TXPlan **prev = &plan_list; *prev; prev = &(*prev)->next) {
+            if (!(*prev)->refcount) {
+                last_idle = prev;
+                nb_idle++;
+            }
+        }
+
+        if (nb_idle > TX_PLAN_MAX_IDLE) {
+            evict      = *last_idle;
+            *last_idle = evict->next;
+        }
+    }
+    ff_mutex_unlock(&plan_mutex);
+
+    plan_free(&evict);
+}
+
+/* Temporary buffers are allocated by each clone, the template needs none */
+static void strip_tmp(AVTXContext *s)
+{
+    for (int i = 0; s->sub && i < s->nb_sub; i++)
+        strip_tmp(&s->sub[i]);
+
+    av_freep(&s->tmp);
+    if (s->exp_tmp_size)
+        av_freep(&s->exp);
+}
+
+static av_cold int plan_create(TXPlan **out, const TXPlan *key,
+                               const void *scale)
+{
+    AVTXContext tmp = { 0 };
+    TXPlan *plan;
+    int ret;
+
+    plan = av_memdup(key, sizeof(*key));
+    if (!plan)
+        return AVERROR(ENOMEM);
+
+    ret = ff_tx_init_subtx(&tmp, key->type, key->flags, NULL, key->len,
+                           key->inv, scale);
+    if (ret < 0) {
+        av_free(plan);
+        return ret;
+    }
+
+    plan->ctx      = &tmp.sub[0];
+    plan->fn       = tmp.fn[0];
+    plan->next     = NULL;
+    plan->refcount = 1;
+    strip_tmp(plan->ctx);
+
+    *out = plan;
+
+    return 0;
+}
+
 av_cold void av_tx_uninit(AVTXContext **ctx)
 {
+    TXPlan *plan;
+
     if (!(*ctx))
         return;
 
-    reset_ctx(*ctx, 1);
+    plan = (*ctx)->plan;
+    if (!plan) {
+        reset_ctx(*ctx, 1);
+        av_freep(ctx);
+        return;
+    }
+
+    free_clone(*ctx);
     av_freep(ctx);
+    plan_unref(plan);
 }
 
 static av_cold int ff_tx_null_init(AVTXContext *s, const FFTXCodelet *cd,
@@ -904,7 +1091,8 @@ av_cold int av_tx_init(AVTXContext **ctx, av_tx_fn *tx, enum AVTXType type,
                        int inv, int len, const void *scale, uint64_t flags)
 {
     int ret;
-    AVTXContext tmp = { 0 };
+    AVTXContext *s;
+    TXPlan key = { 0 }, *plan, *existing;
     const double default_scale_d = 1.0;
     const float  default_scale_f = 1.0f;
 
@@ -923,12 +1111,55 @@ av_cold int av_tx_init(AVTXContext **ctx, av_tx_fn *tx, enum AVTXType type,
     else if (!scale && !TYPE_IS(FFT, type))
         scale = &default_scale_f;
 
-    ret = ff_tx_init_subtx(&tmp, type, flags, NULL, len, inv, scale);
-    if (ret < 0)
+    key.type      = type;
+    key.inv       = inv;
+    key.len       = len;
+    key.flags     = flags;
+    key.cpu_flags = av_get_cpu_flags();
+    key.has_scale = !!scale;
+    if (scale)
+        key.scale = TYPE_IS_DOUBLE(type) ? *(const double *)scale :
+                                           *(const float  *)scale;
+
+    ff_mutex_lock(&plan_mutex);
+    plan = plan_find(&key);
+    ff_mutex_unlock(&plan_mutex);
+
+    if (!plan) {
+        ret = plan_create(&plan, &key, scale);
+        if (ret < 0)
+            return ret;
+
+        /* Another thread may have created the same plan in the meantime */
+        ff_mutex_lock(&plan_mutex);
+        existing = plan_find(&key);
+        if (!existing) {
+            plan->next = plan_list;
+            plan_list  = plan;
+        }
+        ff_mutex_unlock(&plan_mutex);
+
+        if (existing) {
+            plan_free(&plan);
+            plan = existing;
+        }
+    }
+
+    s = av_mallocz(sizeof(*s));
+    if (!s) {
+        plan_unref(plan);
+        return AVERROR(ENOMEM);
+    }
+
+    ret = clone_ctx(s, plan->ctx);
+    s->plan = plan;
+    if (ret < 0) {
+        av_tx_uninit(&s);
         return ret;
+    }
 
-    *ctx = &tmp.sub[0];
-    *tx  = tmp.fn[0];
+    *ctx = s;
+    *tx  = plan->fn;
 
 #if !CONFIG_SMALL
     av_log(NULL, AV_LOG_DEBUG, "Transform tree:\n");
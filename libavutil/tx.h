@@ -189,6 +189,11 @@ enum AVTXFlags {
  * Initialize a transform context with the given configuration
  * (i)MDCTs with an odd length are currently not supported.
  *
+ * Contexts created with identical parameters share their read-only tables,
+ * which are only computed once, and stay cached for a while after the last
+ * such context is freed. Each context still has its own temporary buffers,
+ * so different contexts may be used concurrently.
+ *
  * @param ctx the context to allocate, will be NULL on error
  * @param tx pointer to the transform function pointer to set
  * @param type type the type of transform
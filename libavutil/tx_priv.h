@@ -265,6 +265,15 @@ struct AVTXContext {
     float              scale_f;
     double             scale_d;
     void              *opaque;          /* Free to use by implementations */
+
+    /* Contexts returned by av_tx_init() share map and exp with all other
+     * contexts created with the same parameters, and own only their
+     * temporary buffers. */
+    size_t             tmp_size;        /* Size of tmp, set on allocation */
+    size_t             exp_tmp_size;    /* Size of exp if it is used as a
+                                         * temporary buffer rather than a
+                                         * table, set on allocation */
+    struct TXPlan     *plan;            /* Plan owning the shared tables */
 };
 
 /* This function embeds a Ruritanian PFA input map into an existing lookup table
@@ -764,6 +764,7 @@ static av_cold int TX_NAME(ff_tx_fft_inplace_small_init)(AVTXContext *s,
 {
     if (!(s->tmp = av_malloc(len*sizeof(*s->tmp))))
         return AVERROR(ENOMEM);
+    s->tmp_size = len*sizeof(*s->tmp);
     flags &= ~AV_TX_INPLACE;
     return TX_NAME(ff_tx_fft_init)(s, cd, flags, opts, len, inv, scale);
 }
@@ -1042,6 +1043,7 @@ retry:
 
     if (!(s->tmp = av_malloc(len*sizeof(*s->tmp))))
         return AVERROR(ENOMEM);
+    s->tmp_size = len*sizeof(*s->tmp);
 
     /* Flatten input map */
     tmp = (int *)s->tmp;
@@ -1059,6 +1061,7 @@ retry:
 
     if (extra_tmp_len && !(s->exp = av_malloc(extra_tmp_len*sizeof(*s->exp))))
         return AVERROR(ENOMEM);
+    s->exp_tmp_size = extra_tmp_len*sizeof(*s->exp);
 
     return 0;
 }
@@ -1470,6 +1473,7 @@ static av_cold int TX_NAME(ff_tx_mdct_pfa_init)(AVTXContext *s,
 
     if (!(s->tmp = av_malloc(len*sizeof(*s->tmp))))
         return AVERROR(ENOMEM);
+    s->tmp_size = len*sizeof(*s->tmp);
 
     TX_TAB(ff_tx_init_tabs)(len / sub_len);
 
@@ -2039,6 +2043,7 @@ static av_cold int TX_NAME(ff_tx_dcstI_init)(AVTXContext *s,
     s->tmp = av_mallocz((len + 1)*2*sizeof(TXSample));
     if (!s->tmp)
         return AVERROR(ENOMEM);
+    s->tmp_size = (len + 1)*2*sizeof(TXSample);
 
     return 0;
 }
@@ -1773,6 +1773,222 @@ cglobal mdct_inv_float, 4, 14, 16, 320, ctx, out, in, stride, len, lut, exp, t1,
 IMDCT_FN avx2
 %endif
 
+; Loads 8 consecutive even-indexed floats from the 16 at %2
+%macro LOAD_EVEN 2
+    movups  %1, [%2 + 0*mmsize]
+    shufps  %1, %1, [%2 + 1*mmsize], q2020
+    vpermpd %1, %1, q3120
+%endmacro
+
+; Loads the 8 odd-indexed floats from the 16 at %2, in reverse order
+%macro LOAD_ODD_REV 2
+    movups  %1, [%2 + 1*mmsize]
+    shufps  %1, %1, [%2 + 0*mmsize], q1313
+    vpermpd %1, %1, q1302
+%endmacro
+
+; Folds, pre-rotates and scatters 8 coefficients.
+; %1 - 0 for the first quarter, 1 for the second
+%macro MDCT_FWD_PRE 1
+    LOAD_EVEN    m0, t1q             ; src[len2 + k]
+    LOAD_ODD_REV m2, t5q             ; src[len3 - 1 - k]
+%if %1 == 0
+    LOAD_ODD_REV m1, t2q             ; src[len2 - 1 - k]
+    LOAD_EVEN    m3, t3q             ; src[len3 + k]
+    subps        m1, m0              ; re
+    subps        m3, m14, m3
+    subps        m3, m2              ; im
+%else
+    LOAD_ODD_REV m1, t2q             ; src[5*len2 - 1 - k]
+    LOAD_EVEN    m3, t3q             ; src[k - len2]
+    subps        m0, m14, m0
+    subps        m1, m0, m1          ; re
+    subps        m3, m2              ; im
+%endif
+
+    movups       m6, [expq + 0*mmsize]
+    movups       m7, [expq + 1*mmsize]
+
+    unpcklps     m4, m1, m3          ; re, im, re, im (0, 1, 4, 5)
+    unpckhps     m5, m1, m3          ; re, im, re, im (2, 3, 6, 7)
+
+    vperm2f128   m8, m6, m7, 0x20    ; tab (0, 1, 4, 5)
+    vperm2f128   m9, m6, m7, 0x31    ; tab (2, 3, 6, 7)
+
+    movshdup     m10, m8             ; tab 1 imim
+    movshdup     m11, m9             ; tab 2 imim
+    movsldup     m8, m8              ; tab 1 rere
+    movsldup     m9, m9              ; tab 2 rere
+
+    mulps        m10, m4             ; 1 reim * imim
+    mulps        m11, m5             ; 2 reim * imim
+
+    shufps       m4, m4, m4, q2301
+    shufps       m5, m5, m5, q2301
+
+    fmsubaddps   m10, m4, m8, m10    ; z.re, z.im (0, 1, 4, 5)
+    fmsubaddps   m11, m5, m9, m11    ; z.re, z.im (2, 3, 6, 7)
+
+    vextractf128 xm12, m10, 1
+    vextractf128 xm13, m11, 1
+
+    ; scatter
+    movsxd ctxq,    dword [lutq + 0*4]
+    movsxd strideq, dword [lutq + 1*4]
+    movsxd lenq,    dword [lutq + 2*4]
+    movsxd inq,     dword [lutq + 3*4]
+
+    movlps [outq + ctxq*8],    xm10
+    movhps [outq + strideq*8], xm10
+    movlps [outq + lenq*8],    xm11
+    movhps [outq + inq*8],     xm11
+
+    movsxd ctxq,    dword [lutq + 4*4]
+    movsxd strideq, dword [lutq + 5*4]
+    movsxd lenq,    dword [lutq + 6*4]
+    movsxd inq,     dword [lutq + 7*4]
+
+    movlps [outq + ctxq*8],    xm12
+    movhps [outq + strideq*8], xm12
+    movlps [outq + lenq*8],    xm13
+    movhps [outq + inq*8],     xm13
+%endmacro
+
+; Loops MDCT_FWD_PRE over a quarter of the coefficients. The last block is
+; moved back to end exactly on the quarter, overlapping the one before it.
+%macro MDCT_FWD_PRE_LOOP 1
+    movsxd t6q, dword [t4q + AVTXContext.len]
+    shr t6q, 2                       ; coefficients left
+.pre%1:
+    MDCT_FWD_PRE %1
+
+    sub t6q, 8
+    jle .pre%1_end
+
+    mov ctxq, 8
+    cmp t6q, 8
+    cmovl ctxq, t6q                  ; step
+
+    lea strideq, [ctxq*8]
+    add t1q, strideq
+    sub t2q, strideq
+    add t3q, strideq
+    sub t5q, strideq
+    add expq, strideq
+    lea lutq, [lutq + ctxq*4]
+    jmp .pre%1
+
+.pre%1_end:
+%endmacro
+
+%macro MDCT_FWD_FN 1
+INIT_YMM %1
+cglobal mdct_fwd_float, 4, 14, 16, 320, ctx, out, in, stride, len, lut, exp, t1, t2, t3, \
+                                        t4, t5, btmp, t6
+    movsxd lenq, dword [ctxq + AVTXContext.len]
+    mov expq, [ctxq + AVTXContext.exp]
+    mov lutq, [ctxq + AVTXContext.map]
+
+    mov t4q, ctxq                    ; backup original context
+    mov btmpq, strideq               ; backup output stride
+
+    lea t1q, [inq + lenq*2]          ; src + len2
+    lea t2q, [t1q - 2*mmsize]        ; src + len2 - 16
+    lea t3q, [t1q + lenq*4]          ; src + len3
+    lea t5q, [t3q - 2*mmsize]        ; src + len3 - 16
+
+    xorps m14, m14
+
+    MDCT_FWD_PRE_LOOP 0
+
+    movsxd lenq, dword [t4q + AVTXContext.len]
+
+    add t1q, 2*mmsize                ; src + len2 + k
+    sub t5q, 2*mmsize                ; src + len3 - 16 - k
+    add expq, 2*mmsize
+    add lutq, mmsize
+    neg lenq
+    lea t3q, [t1q + lenq*4]          ; src + k - len2
+    neg lenq
+    lea t2q, [t3q + lenq*8 - 2*mmsize] ; src + 5*len2 - 16 - k
+
+    MDCT_FWD_PRE_LOOP 1
+
+    mov strideq, 2*4
+    mov t5q, [t4q + AVTXContext.fn]  ; subtransform's jump point
+    mov ctxq, [t4q + AVTXContext.sub]
+    mov lutq, [ctxq + AVTXContext.map]
+    movsxd lenq, dword [ctxq + AVTXContext.len]
+
+    mov inq, outq                    ; in-place transform
+    call t5q                         ; call the FFT
+
+    mov ctxq, t4q                    ; restore original context
+    movsxd lenq, dword [ctxq + AVTXContext.len]
+    mov expq, [ctxq + AVTXContext.exp]
+
+    xor t1q, t1q                     ; low
+    lea t2q, [lenq*4 - mmsize]       ; high
+
+.post:
+    movaps m2, [expq + t2q]          ; tab h
+    movaps m3, [expq + t1q]          ; tab l
+    movups m0, [outq + t2q]          ; in h
+    movups m1, [outq + t1q]          ; in l
+
+    movsldup m4, m2                  ; tab h rere
+    movsldup m5, m3                  ; tab l rere
+    movshdup m2, m2                  ; tab h imim
+    movshdup m3, m3                  ; tab l imim
+
+    mulps m4, m0
+    mulps m5, m1
+
+    shufps m0, m0, m0, q2301         ; in h imre
+    shufps m1, m1, m1, q2301         ; in l imre
+
+    fmsubaddps m4, m0, m2, m4
+    fmsubaddps m5, m1, m3, m5
+
+    vpermpd m2, m4, q0123            ; flip
+    vpermpd m3, m5, q0123            ; flip
+
+    blendps m1, m2, m5, 01010101b
+    blendps m0, m3, m4, 01010101b
+
+    movups [outq + t2q], m0
+    movups [outq + t1q], m1
+
+    add t1q, mmsize
+    sub t2q, mmsize
+    sub lenq, mmsize/2
+    jg .post
+
+    cmp btmpq, 4
+    jne .stridex_post
+
+    RET
+
+.stridex_post:                       ; spread out the output, from the end
+    movsxd lenq, dword [ctxq + AVTXContext.len]
+    lea t1q, [lenq - 1]
+    imul t1q, btmpq
+    add t1q, outq
+
+.stridex_post_loop:
+    movss xm0, [outq + lenq*4 - 4]
+    movss [t1q], xm0
+    sub t1q, btmpq
+    sub lenq, 1
+    jg .stridex_post_loop
+
+    RET
+%endmacro
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+MDCT_FWD_FN avx2
+%endif
+
 %macro PFA_15_FN 2
 INIT_YMM %1
 %if %2
@@ -52,6 +52,7 @@ TX_DECL_FN(fft_pfa_15xM, avx2)
 TX_DECL_FN(fft_pfa_15xM_ns, avx2)
 
 TX_DECL_FN(mdct_inv, avx2)
+TX_DECL_FN(mdct_fwd, avx2)
 
 TX_DECL_FN(fft2_asm, sse3)
 TX_DECL_FN(fft4_fwd_asm, sse2)
@@ -168,6 +169,43 @@ static av_cold int m_inv_init(AVTXContext *s, const FFTXCodelet *cd,
     return 0;
 }
 
+static av_cold int m_fwd_init(AVTXContext *s, const FFTXCodelet *cd,
+                              uint64_t flags, FFTXCodeletOptions *opts,
+                              int len, int inv, const void *scale)
+{
+    int ret;
+    FFTXCodeletOptions sub_opts = { .map_dir = FF_TX_MAP_GATHER };
+
+    /* The folding loops work on blocks of 8 coefficients per quarter */
+    if (len & 7)
+        return AVERROR(ENOTSUP);
+
+    s->scale_d = *((SCALE_TYPE *)scale);
+    s->scale_f = s->scale_d;
+
+    flags &= ~FF_TX_OUT_OF_PLACE; /* We want the subtransform to be */
+    flags |=  AV_TX_INPLACE;      /* in-place */
+    flags |=  FF_TX_PRESHUFFLE;   /* This function handles the permute step */
+    flags |=  FF_TX_ASM_CALL;     /* We want an assembly function, not C */
+
+    if ((ret = ff_tx_init_subtx(s, TX_TYPE(FFT), flags, &sub_opts, len >> 1,
+                                inv, scale)))
+        return ret;
+
+    s->map = av_malloc((len >> 1)*sizeof(*s->map));
+    if (!s->map)
+        return AVERROR(ENOMEM);
+
+    /* Invert lookup table, the folded coefficients are scattered */
+    for (int i = 0; i < (len >> 1); i++)
+        s->map[s->sub->map[i]] = i;
+
+    if ((ret = ff_tx_mdct_gen_exp_float(s, NULL)))
+        return ret;
+
+    return 0;
+}
+
 static av_cold int fft_pfa_init(AVTXContext *s,
                                 const FFTXCodelet *cd,
                                 uint64_t flags,
@@ -222,6 +260,7 @@ static av_cold int fft_pfa_init(AVTXContext *s,
 
     if (!(s->tmp = av_malloc(len*sizeof(*s->tmp))))
         return AVERROR(ENOMEM);
+    s->tmp_size = len*sizeof(*s->tmp);
 
     TX_TAB(ff_tx_init_tabs)(len / sub_len);
 
@@ -304,6 +343,8 @@ const FFTXCodelet * const ff_tx_codelet_list_float_x86[] = {
 
     TX_DEF(mdct_inv, MDCT, 16, TX_LEN_UNLIMITED, 2, TX_FACTOR_ANY, 384, m_inv_init, avx2, AVX2,
            FF_TX_INVERSE_ONLY, AV_CPU_FLAG_AVXSLOW | AV_CPU_FLAG_SLOW_GATHER),
+    TX_DEF(mdct_fwd, MDCT, 32, TX_LEN_UNLIMITED, 2, TX_FACTOR_ANY, 384, m_fwd_init, avx2, AVX2,
+           FF_TX_FORWARD_ONLY, AV_CPU_FLAG_AVXSLOW | AV_CPU_FLAG_SLOW_GATHER),
 #endif
 #endif
 
@@ -1125,6 +1125,63 @@ int sws_send_slice(struct SwsContext *c, unsigned int slice_start,
     return 0;
 }
 
+/**
+ * Number of output bands to split a threaded scaling call into.
+ *
+ * There are more bands than threads, so threads finishing early pick up the
+ * remaining bands. Each band starts with an empty vertical filter ring buffer
+ * and scales the input lines it shares with the band above horizontally once
+ * more, so bands are kept tall enough for this overlap to stay small.
+ */
+static int scale_nb_bands(const SwsContext *c, int height)
+{
+    const SwsContext *c0 = c->slice_ctx[0];
+    int64_t min_height;
+    int nb_bands;
+
+    if (c0->dither == SWS_DITHER_ED)
+        return 1;
+    // cascaded contexts run their first stage on the whole frame per band
+    if (c0->cascaded_context[0])
+        return c->nb_slice_ctx;
+
+    min_height = 8LL * FFMAX(c0->vLumFilterSize, 1) * c->dstH / c->srcH;
+    min_height = FFMAX(min_height, c0->dst_slice_align);
+    nb_bands   = FFMIN(c->nb_slice_ctx * 4LL, height / min_height);
+
+    return FFMAX(nb_bands, c->nb_slice_ctx);
+}
+
+static int scale_threaded(SwsContext *c,
+                          const uint8_t * const src[], const int srcStride[],
+                          uint8_t * const dst[], const int dstStride[],
+                          int dst_slice_start, int dst_slice_height)
+{
+    int ret = 0;
+
+    for (int i = 0; i < 4; i++) {
+        c->thread_src[i]        = src[i];
+        c->thread_src_stride[i] = srcStride[i];
+        c->thread_dst[i]        = dst[i];
+        c->thread_dst_stride[i] = dstStride[i];
+    }
+    c->dst_slice_start  = dst_slice_start;
+    c->dst_slice_height = dst_slice_height;
+    memset(c->slice_err, 0, c->nb_slice_ctx * sizeof(*c->slice_err));
+
+    avpriv_slicethread_execute(c->slicethread,
+                               scale_nb_bands(c, dst_slice_height), 0);
+
+    for (int i = 0; i < c->nb_slice_ctx; i++) {
+        if (c->slice_err[i] < 0) {
+            ret = c->slice_err[i];
+            break;
+        }
+    }
+
+    return ret;
+}
+
 unsigned int sws_receive_slice_alignment(const struct SwsContext *c)
 {
     if (c->slice_ctx)
@@ -1153,26 +1210,10 @@ int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
         return AVERROR(EINVAL);
     }
 
-    if (c->slicethread) {
-        int nb_jobs = c->slice_ctx[0]->dither == SWS_DITHER_ED ? 1 : c->nb_slice_ctx;
-        int ret = 0;
-
-        c->dst_slice_start  = slice_start;
-        c->dst_slice_height = slice_height;
-
-        avpriv_slicethread_execute(c->slicethread, nb_jobs, 0);
-
-        for (int i = 0; i < c->nb_slice_ctx; i++) {
-            if (c->slice_err[i] < 0) {
-                ret = c->slice_err[i];
-                break;
-            }
-        }
-
-        memset(c->slice_err, 0, c->nb_slice_ctx * sizeof(*c->slice_err));
-
-        return ret;
-    }
+    if (c->slicethread)
+        return scale_threaded(c, (const uint8_t * const *)c->frame_src->data,
+                              c->frame_src->linesize, c->frame_dst->data,
+                              c->frame_dst->linesize, slice_start, slice_height);
 
     for (int i = 0; i < FF_ARRAY_ELEMS(dst); i++) {
         ptrdiff_t offset = c->frame_dst->linesize[i] * (ptrdiff_t)(slice_start >> c->chrDstVSubSample);
@@ -1211,8 +1252,16 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
                                   int srcSliceH, uint8_t *const dst[],
                                   const int dstStride[])
 {
-    if (c->nb_slice_ctx)
+    if (c->nb_slice_ctx) {
+        // complete frames can be split over the threads by output bands
+        if (c->nb_slice_ctx > 1 && srcSliceY == 0 && srcSliceH == c->srcH &&
+            srcSlice && srcStride && dst && dstStride) {
+            int ret = scale_threaded(c, srcSlice, srcStride, dst, dstStride,
+                                     0, c->dstH);
+            return ret < 0 ? ret : c->dstH;
+        }
         c = c->slice_ctx[0];
+    }
 
     return scale_internal(c, srcSlice, srcStride, srcSliceY, srcSliceH,
                           dst, dstStride, 0, c->dstH);
@@ -1233,19 +1282,20 @@ void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
     if (slice_end > slice_start) {
         uint8_t *dst[4] = { NULL };
 
-        for (int i = 0; i < FF_ARRAY_ELEMS(dst) && parent->frame_dst->data[i]; i++) {
+        for (int i = 0; i < FF_ARRAY_ELEMS(dst) && parent->thread_dst[i]; i++) {
             const int vshift = (i == 1 || i == 2) ? c->chrDstVSubSample : 0;
-            const ptrdiff_t offset = parent->frame_dst->linesize[i] *
+            const ptrdiff_t offset = parent->thread_dst_stride[i] *
                 (ptrdiff_t)((slice_start + parent->dst_slice_start) >> vshift);
 
-            dst[i] = parent->frame_dst->data[i] + offset;
+            dst[i] = parent->thread_dst[i] + offset;
         }
 
-        err = scale_internal(c, (const uint8_t * const *)parent->frame_src->data,
-                             parent->frame_src->linesize, 0, c->srcH,
-                             dst, parent->frame_dst->linesize,
+        err = scale_internal(c, parent->thread_src, parent->thread_src_stride,
+                             0, c->srcH, dst, parent->thread_dst_stride,
                              parent->dst_slice_start + slice_start, slice_end - slice_start);
     }
 
-    parent->slice_err[threadnr] = err;
+    // a thread runs several bands, keep the error of any of them
+    if (err < 0)
+        parent->slice_err[threadnr] = err;
 }
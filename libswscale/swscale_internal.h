@@ -682,6 +682,13 @@ typedef struct SwsContext {
     atomic_int   data_unaligned_warned;
 
     Half2FloatTables *h2f_tables;
+
+    // source and destination of the threaded scaling call in progress,
+    // placed last so the offsets used by the x86 asm above do not change
+    const uint8_t *thread_src[4];
+    int            thread_src_stride[4];
+    uint8_t       *thread_dst[4];
+    int            thread_dst_stride[4];
 } SwsContext;
 //FIXME check init (where 0)
 
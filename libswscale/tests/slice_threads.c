@@ -0,0 +1,95 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/imgutils.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define SRC_W 64
+#define SRC_H 64
+#define DST_W 32
+#define DST_H 32
+
+int main(void)
+{
+    SwsContext *c = sws_alloc_context();
+    uint8_t *src[4] = { NULL }, *dst[4] = { NULL };
+    int src_stride[4], dst_stride[4];
+    int ret = 1, kept, err;
+
+    av_log_set_level(AV_LOG_QUIET);
+
+    if (!c ||
+        av_opt_set_int(c, "srcw",       SRC_W,              0) < 0 ||
+        av_opt_set_int(c, "srch",       SRC_H,              0) < 0 ||
+        av_opt_set_int(c, "dstw",       DST_W,              0) < 0 ||
+        av_opt_set_int(c, "dsth",       DST_H,              0) < 0 ||
+        av_opt_set_int(c, "src_format", AV_PIX_FMT_YUV420P, 0) < 0 ||
+        av_opt_set_int(c, "dst_format", AV_PIX_FMT_YUV420P, 0) < 0 ||
+        av_opt_set_int(c, "sws_flags",  SWS_BILINEAR,       0) < 0 ||
+        av_opt_set_int(c, "threads",    2,                  0) < 0 ||
+        sws_init_context(c, NULL, NULL) < 0 ||
+        c->nb_slice_ctx < 2)
+        goto end;
+
+    if (av_image_alloc(src, src_stride, SRC_W, SRC_H, AV_PIX_FMT_YUV420P, 16) < 0 ||
+        av_image_alloc(dst, dst_stride, DST_W, DST_H, AV_PIX_FMT_YUV420P, 16) < 0)
+        goto end;
+    memset(src[0], 0x80, src_stride[0] * SRC_H);
+    memset(src[1], 0x80, src_stride[1] * SRC_H / 2);
+    memset(src[2], 0x80, src_stride[2] * SRC_H / 2);
+
+    /* Split an output taller than the destination in two bands, the second
+     * one failing, and run the failing band first on the same thread, the way
+     * a thread running several bands may. */
+    for (int i = 0; i < 4; i++) {
+        c->thread_src[i]        = src[i];
+        c->thread_src_stride[i] = src_stride[i];
+        c->thread_dst[i]        = dst[i];
+        c->thread_dst_stride[i] = dst_stride[i];
+    }
+    c->dst_slice_start  = 0;
+    c->dst_slice_height = DST_H * 3 / 2;
+    memset(c->slice_err, 0, c->nb_slice_ctx * sizeof(*c->slice_err));
+
+    ff_sws_slice_worker(c, 1, 0, 2, c->nb_slice_ctx);
+    ff_sws_slice_worker(c, 0, 0, 2, c->nb_slice_ctx);
+    kept = c->slice_err[0] < 0;
+    printf("failed band followed by a successful one: %s\n",
+           kept ? "error kept" : "error lost");
+
+    // the error of a previous call must not leak into the next one
+    err = sws_scale(c, (const uint8_t * const *)src, src_stride, 0, SRC_H,
+                    dst, dst_stride);
+    printf("next frame: %s\n", err == DST_H ? "ok" : "failed");
+
+    ret = !kept || err != DST_H;
+
+end:
+    av_freep(&src[0]);
+    av_freep(&dst[0]);
+    sws_freeContext(c);
+    return ret;
+}
@@ -114,6 +114,9 @@ void checkasm_check_av_tx(void)
     CHECK_TEMPLATE("float_imdct", AV_TX_FLOAT_MDCT, 1, float, float, check_lens,
                    !float_near_abs_eps_array(out_ref, out_new, EPS, len));
 
+    CHECK_TEMPLATE("float_mdct", AV_TX_FLOAT_MDCT, 0, float, float, check_lens,
+                   !float_near_abs_eps_array(out_ref, out_new, EPS, len));
+
     randomize_complex(in, 16384, AVComplexDouble, SCALE_NOOP);
     CHECK_TEMPLATE("double_fft", AV_TX_DOUBLE_FFT, 0, AVComplexDouble, double, check_lens,
                    !double_near_abs_eps_array(out_ref, out_new, EPS, len*2));
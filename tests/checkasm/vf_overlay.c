@@ -0,0 +1,94 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_overlay.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 256
+#define BUF_SIZE (WIDTH * 2)
+#define ALPHA_STRIDE (WIDTH * 4)
+
+#define randomize_buffers(buf, size, depth)                         \
+    do {                                                            \
+        if (depth > 8) {                                            \
+            for (int j = 0; j < size / 2; j++)                      \
+                AV_WN16A(buf + 2 * j, rnd() & ((1 << depth) - 1));  \
+        } else {                                                    \
+            for (int j = 0; j < size; j++)                          \
+                buf[j] = rnd() & 0xFF;                              \
+        }                                                           \
+    } while (0)
+
+static void check_blend_row(int format, enum AVPixelFormat pix_fmt,
+                            int alpha_format, int plane, const char *name,
+                            int depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, alpha,   [ALPHA_STRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [BUF_SIZE]);
+    int bytes = (depth + 7) / 8;
+    OverlayContext s = { 0 };
+
+    declare_func(int, uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                 int w, ptrdiff_t alinesize);
+
+    ff_overlay_init(&s, format, pix_fmt, alpha_format, 0);
+
+    if (check_func(s.blend_row[plane], "overlay_row_%s", name)) {
+        for (int i = 0; i < 4; i++) {
+            /* exercise the leftover pixels as well */
+            int w = WIDTH - (rnd() & 31);
+            int c_ref, c_new;
+
+            randomize_buffers(src, BUF_SIZE, depth);
+            randomize_buffers(alpha, ALPHA_STRIDE * 2, depth);
+            randomize_buffers(dst_ref, BUF_SIZE, depth);
+            memcpy(dst_new, dst_ref, BUF_SIZE);
+
+            c_ref = call_ref(dst_ref, NULL, src, alpha, w, ALPHA_STRIDE);
+            c_new = call_new(dst_new, NULL, src, alpha, w, ALPHA_STRIDE);
+            if (c_new < 0 || c_new > c_ref ||
+                memcmp(dst_ref, dst_new, c_new * bytes))
+                fail();
+        }
+        bench_new(dst_new, NULL, src, alpha, WIDTH, ALPHA_STRIDE);
+    }
+}
+
+void checkasm_check_vf_overlay(void)
+{
+    check_blend_row(OVERLAY_FORMAT_YUV444, AV_PIX_FMT_YUV444P, 0, 0, "44", 8);
+    check_blend_row(OVERLAY_FORMAT_YUV422, AV_PIX_FMT_YUV422P, 0, 1, "22", 8);
+    check_blend_row(OVERLAY_FORMAT_YUV420, AV_PIX_FMT_YUV420P, 0, 1, "20", 8);
+    report("overlay_row");
+
+    check_blend_row(OVERLAY_FORMAT_YUV444, AV_PIX_FMT_YUV444P, 1, 0, "44_pm", 8);
+    check_blend_row(OVERLAY_FORMAT_YUV444, AV_PIX_FMT_YUV444P, 1, 1, "44_pm_uv", 8);
+    check_blend_row(OVERLAY_FORMAT_YUV422, AV_PIX_FMT_YUV422P, 1, 1, "22_pm_uv", 8);
+    check_blend_row(OVERLAY_FORMAT_YUV420, AV_PIX_FMT_YUV420P, 1, 1, "20_pm_uv", 8);
+    report("overlay_row_pm");
+
+    check_blend_row(OVERLAY_FORMAT_YUV444P10, AV_PIX_FMT_YUV444P10, 0, 0, "44_10", 10);
+    check_blend_row(OVERLAY_FORMAT_YUV422P10, AV_PIX_FMT_YUV422P10, 0, 1, "22_10", 10);
+    check_blend_row(OVERLAY_FORMAT_YUV420P10, AV_PIX_FMT_YUV420P10, 0, 1, "20_10", 10);
+    report("overlay_row_10");
+}
@@ -203,6 +203,31 @@ enc_dec_pcm(){
     ffmpeg -auto_conversion_filters -bitexact -i ${encfile} -c:a pcm_${pcm_fmt} -fflags +bitexact -f ${dec_fmt} -
 }
 
+enc_threads_cmp(){
+    out_fmt=$1
+    src_file=$(target_path $2)
+    thread_opts=$3
+    shift 3
+    reffile="${outdir}/${test}.ref.${out_fmt}"
+    encfile="${outdir}/${test}.${out_fmt}"
+    cleanfiles="$cleanfiles $reffile $encfile"
+    ffmpeg -auto_conversion_filters -i $src_file -threads 1 "$@" -f $out_fmt -y $(target_path $reffile) || return
+    ffmpeg -auto_conversion_filters -i $src_file $thread_opts "$@" -f $out_fmt -y $(target_path $encfile) || return
+    cmp $reffile $encfile && echo "threaded output identical"
+}
+
+enc_threads_framecrc(){
+    out_fmt=$1
+    src_file=$(target_path $2)
+    src_opts=$3
+    thread_opts=$4
+    shift 4
+    encfile="${outdir}/${test}.${out_fmt}"
+    cleanfiles="$cleanfiles $encfile"
+    ffmpeg -auto_conversion_filters $src_opts -i $src_file $thread_opts "$@" -f $out_fmt -y $(target_path $encfile) || return
+    framecrc -i $(target_path $encfile)
+}
+
 FLAGS="-flags +bitexact -sws_flags +accurate_rnd+bitexact -fflags +bitexact"
 DEC_OPTS="-threads $threads -thread_type $thread_type -idct simple $FLAGS"
 ENC_OPTS="-threads 1        -idct simple -dct fastint"
@@ -263,9 +263,22 @@ $(FATE_AAC_ALL): FUZZ = 2
 
 FATE_AAC_ENCODE-$(call ENCMUX, AAC, ADTS, ARESAMPLE_FILTER) += $(FATE_AAC_ENCODE)
 
+# the quantizer searches of the channels run in slice threads
+FATE_AAC_ENCODE_THREADS += fate-aac-encode-slice-threads-fast
+fate-aac-encode-slice-threads-fast: CMD = enc_threads_cmp adts ./tests/data/asynth-44100-2.wav "-threads 4 -thread_type slice" -c:a aac -aac_coder fast -b:a 128k -fflags +bitexact -flags +bitexact
+
+FATE_AAC_ENCODE_THREADS += fate-aac-encode-slice-threads-twoloop
+fate-aac-encode-slice-threads-twoloop: CMD = enc_threads_cmp adts ./tests/data/asynth-44100-2.wav "-threads 4 -thread_type slice" -c:a aac -aac_coder twoloop -ac 6 -b:a 256k -fflags +bitexact -flags +bitexact
+
+$(FATE_AAC_ENCODE_THREADS): ./tests/data/asynth-44100-2.wav
+$(FATE_AAC_ENCODE_THREADS): REF = $(SRC_PATH)/tests/ref/fate/aac-encode-slice-threads
+
+FATE_AAC_ENCODE_THREADS-$(call ENCMUX, AAC, ADTS, ARESAMPLE_FILTER WAV_DEMUXER PCM_S16LE_DECODER) += $(FATE_AAC_ENCODE_THREADS)
+
 FATE_AAC_BSF-$(call ALLYES, AAC_DEMUXER AAC_ADTSTOASC_BSF MATROSKA_MUXER) += fate-aac-autobsf-adtstoasc
 
 FATE_SAMPLES_FFMPEG += $(FATE_AAC_ALL) $(FATE_AAC_ENCODE-yes) $(FATE_AAC_BSF-yes)
+FATE_FFMPEG += $(FATE_AAC_ENCODE_THREADS-yes)
 
-fate-aac: $(FATE_AAC_ALL) $(FATE_AAC_ENCODE) $(FATE_AAC_BSF-yes)
+fate-aac: $(FATE_AAC_ALL) $(FATE_AAC_ENCODE) $(FATE_AAC_ENCODE_THREADS-yes) $(FATE_AAC_BSF-yes)
 fate-aac-latm: $(FATE_AAC_LATM-yes)
@@ -249,6 +249,10 @@ $(FATE_AMIX): SRC1 = $(TARGET_PATH)/tests/data/asynth-44100-2-2.wav
 $(FATE_AMIX): CMP  = oneoff
 $(FATE_AMIX): CMP_UNIT = f32
 
+# the frames of the second input are split and mixed from within their buffers
+FATE_AFILTER-$(call FILTERFRAMECRC, AEVALSRC AMIX ARESAMPLE, PCM_F64LE_ENCODER) += fate-filter-amix-frame-sizes
+fate-filter-amix-frame-sizes: CMD = framecrc -auto_conversion_filters -filter_complex "aevalsrc=sin(2*PI*440*t)|cos(2*PI*440*t):n=256:d=1[a];aevalsrc=sin(2*PI*660*t)|cos(2*PI*660*t):n=1000:d=1[b];[a][b]amix=duration=shortest" -c:a pcm_f64le
+
 FATE_AFILTER_SAMPLES-$(CONFIG_ARESAMPLE_FILTER) += fate-filter-aresample
 fate-filter-aresample: SRC = $(TARGET_SAMPLES)/nellymoser/nellymoser-discont.flv
 fate-filter-aresample: CMD = pcm -analyzeduration 10000000 -i $(SRC) -af aresample=min_comp=0.001:min_hard_comp=0.1:first_pts=0
@@ -426,6 +430,14 @@ FATE_AFILTER-yes += fate-filter-formats
 fate-filter-formats: libavfilter/tests/formats$(EXESUF)
 fate-filter-formats: CMD = run libavfilter/tests/formats$(EXESUF)
 
+FATE_AFILTER-$(call ALLYES, TESTSRC2_FILTER FORMAT_FILTER SCALE_FILTER NULLSINK_FILTER SINE_FILTER AFORMAT_FILTER ARESAMPLE_FILTER AMERGE_FILTER ANULLSINK_FILTER) += fate-filter-graph-template
+fate-filter-graph-template: libavfilter/tests/graphtemplate$(EXESUF)
+fate-filter-graph-template: CMD = run libavfilter/tests/graphtemplate$(EXESUF)
+
+FATE_AFILTER-$(call ALLYES, SINE_FILTER AEVALSRC_FILTER ASPLIT_FILTER AFIR_FILTER ARESAMPLE_FILTER) += fate-filter-afir-share
+fate-filter-afir-share: libavfilter/tests/afir$(EXESUF)
+fate-filter-afir-share: CMD = run libavfilter/tests/afir$(EXESUF)
+
 FATE_SAMPLES_AVCONV += $(FATE_AFILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_AFILTER-yes)
 fate-afilter: $(FATE_AFILTER-yes) $(FATE_AFILTER_SAMPLES-yes)
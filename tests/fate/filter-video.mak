@@ -85,6 +85,14 @@ fate-filter-lavd-testsrc: CMD = framecrc -f lavfi -i testsrc=r=7:n=2:d=10
 FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2) += $(addprefix fate-filter-testsrc2-, yuv420p yuv444p rgb24 rgba)
 fate-filter-testsrc2-%: CMD = framecrc -lavfi testsrc2=r=7:d=10 -pix_fmt $(word 4, $(subst -, ,$(@)))
 
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 SPLIT HFLIP NEGATE VFLIP AVGBLUR HSTACK) += fate-filter-pipeline-threads
+fate-filter-pipeline-threads: tests/data/filtergraphs/pipeline-threads
+fate-filter-pipeline-threads: CMD = framecrc -filter_thread_type slice+pipeline -filter_complex_threads 4 -/filter_complex $(TARGET_PATH)/tests/data/filtergraphs/pipeline-threads
+
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 FORMAT SPLIT LUTYUV NEGATE LUT HFLIP HSTACK) += fate-filter-row-threads
+fate-filter-row-threads: tests/data/filtergraphs/row-threads
+fate-filter-row-threads: CMD = framecrc -filter_thread_type slice+rows -filter_complex_threads 4 -/filter_complex $(TARGET_PATH)/tests/data/filtergraphs/row-threads
+
 FATE_FILTER-$(call FILTERFRAMECRC, ALLRGB) += fate-filter-allrgb
 fate-filter-allrgb: CMD = framecrc -lavfi allrgb=rate=5:duration=1 -pix_fmt rgb24
 
@@ -32,5 +32,13 @@ fate-flac-%: FUZZ = 0
 
 FATE_FLAC-$(call ENCMUX, FLAC, FLAC) += $(FATE_FLAC)
 
+# the channels are coded in slice threads
+FATE_FLAC_THREADS-$(call ENCMUX, FLAC, FLAC, WAV_DEMUXER PCM_S16LE_DECODER) += fate-flac-encode-slice-threads
+fate-flac-encode-slice-threads: tests/data/asynth-44100-6.wav
+fate-flac-encode-slice-threads: CMD = enc_threads_cmp flac ./tests/data/asynth-44100-6.wav "-threads 4 -thread_type slice" -c:a flac -compression_level 12 -fflags +bitexact -flags +bitexact
+fate-flac-encode-slice-threads: CMP = diff
+
+FATE_FFMPEG += $(FATE_FLAC_THREADS-yes)
+
 FATE_SAMPLES_AVCONV += $(FATE_FLAC-yes)
-fate-flac: $(FATE_FLAC)
+fate-flac: $(FATE_FLAC) $(FATE_FLAC_THREADS-yes)
@@ -238,6 +238,22 @@ fate-hevc-bsf-mp4toannexb: REF = 73019329ed7f81c24f9af67c34c640c0
 fate-hevc-skiploopfilter: CMD = framemd5 -skip_loop_filter nokey -i $(TARGET_SAMPLES)/hevc-conformance/SAO_D_Samsung_5.bit -sws_flags bitexact
 FATE_HEVC-$(call FRAMEMD5, HEVC, HEVC, HEVC_PARSER) += fate-hevc-skiploopfilter
 
+fate-hevc-skiploopfilter-deferred: CMD = framemd5 -skip_loop_filter nokey -loop_filter_threads 2 -i $(TARGET_SAMPLES)/hevc-conformance/SAO_D_Samsung_5.bit -sws_flags bitexact
+fate-hevc-skiploopfilter-deferred: REF = $(SRC_PATH)/tests/ref/fate/hevc-skiploopfilter
+FATE_HEVC-$(call FRAMEMD5, HEVC, HEVC, HEVC_PARSER) += fate-hevc-skiploopfilter-deferred
+
+# WPP substreams decoded on the executor of each frame thread
+fate-hevc-wpp-executor: CMD = threads=2 thread_type=frame framecrc -wpp_threads 4 -i $(TARGET_SAMPLES)/hevc-conformance/WPP_B_ericsson_MAIN_2.bit -pix_fmt yuv420p
+fate-hevc-wpp-executor: REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-WPP_B_ericsson_MAIN_2
+FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER) += fate-hevc-wpp-executor
+
+# in-loop filters run in a separate pass once each frame is decoded
+HEVC_SAMPLES_LOOP_FILTER_THREADS = DBLK_B_SONY_3 SAO_A_MediaTek_4 SLIST_B_Sony_8
+HEVC_TESTS_LOOP_FILTER_THREADS   = $(addprefix fate-hevc-loop-filter-threads-, $(HEVC_SAMPLES_LOOP_FILTER_THREADS))
+fate-hevc-loop-filter-threads-%: CMD = framecrc -loop_filter_threads 2 -i $(TARGET_SAMPLES)/hevc-conformance/$(subst fate-hevc-loop-filter-threads-,,$(@)).bit -pix_fmt yuv420p
+fate-hevc-loop-filter-threads-%: REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(subst fate-hevc-loop-filter-threads-,,$(@))
+FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER) += $(HEVC_TESTS_LOOP_FILTER_THREADS)
+
 # this sample has two stsd entries and needs to reload extradata
 FATE_HEVC-$(call FRAMEMD5, MOV, HEVC, SCALE_FILTER) += fate-hevc-extradata-reload
 fate-hevc-extradata-reload: CMD = framemd5 -i $(TARGET_SAMPLES)/hevc/extradata-reload-multi-stsd.mov -sws_flags bitexact
@@ -589,6 +589,27 @@ FATE_XBM-$(call DEMDEC, IMAGE2, XBM) += $(FATE_XBM)
 FATE_IMAGE_FRAMECRC += $(FATE_XBM-yes)
 fate-xbm: $(FATE_XBM-yes)
 
+# the rows are filtered and deflated in slice threads
+FATE_IMAGE_ENC_THREADS += fate-png-encode-slice-threads
+fate-png-encode-slice-threads: CMD = enc_threads_framecrc nut tests/data/vsynth1.yuv "$(IMAGE_ENC_THREADS_SRC)" "-threads 4 -thread_type slice" -frames:v 5 $(IMAGE_ENC_THREADS_FLAGS) -c:v png -pix_fmt rgb24
+
+FATE_IMAGE_ENC_THREADS += fate-apng-encode-slice-threads
+fate-apng-encode-slice-threads: CMD = enc_threads_framecrc apng tests/data/vsynth1.yuv "$(IMAGE_ENC_THREADS_SRC)" "-threads 4 -thread_type slice" -frames:v 5 $(IMAGE_ENC_THREADS_FLAGS) -c:v apng -pix_fmt rgb24
+
+FATE_IMAGE_ENC_THREADS += fate-tiff-encode-slice-threads
+fate-tiff-encode-slice-threads: CMD = enc_threads_framecrc mov tests/data/vsynth1.yuv "$(IMAGE_ENC_THREADS_SRC)" "-threads 4 -thread_type slice" -frames:v 5 $(IMAGE_ENC_THREADS_FLAGS) -c:v tiff -compression_algo deflate -pix_fmt rgb24
+
+IMAGE_ENC_THREADS_SRC = -f rawvideo -s 352x288 -pix_fmt yuv420p
+IMAGE_ENC_THREADS_FLAGS = -sws_flags +accurate_rnd+bitexact -fflags +bitexact -flags +bitexact
+
+$(FATE_IMAGE_ENC_THREADS): tests/data/vsynth1.yuv
+
+FATE_IMAGE_ENC_THREADS-$(call ENCDEC, PNG, NUT, ZLIB SCALE_FILTER RAWVIDEO_DEMUXER RAWVIDEO_DECODER FRAMECRC_MUXER) += fate-png-encode-slice-threads
+FATE_IMAGE_ENC_THREADS-$(call ENCDEC, APNG, APNG, ZLIB SCALE_FILTER RAWVIDEO_DEMUXER RAWVIDEO_DECODER FRAMECRC_MUXER) += fate-apng-encode-slice-threads
+FATE_IMAGE_ENC_THREADS-$(call ENCDEC, TIFF, MOV, ZLIB SCALE_FILTER RAWVIDEO_DEMUXER RAWVIDEO_DECODER FRAMECRC_MUXER) += fate-tiff-encode-slice-threads
+
+FATE_FFMPEG += $(FATE_IMAGE_ENC_THREADS-yes)
+
 FATE_IMAGE-$(call ALLYES, FILE_PROTOCOL FRAMECRC_MUXER PIPE_PROTOCOL) += $(FATE_IMAGE_FRAMECRC) $(FATE_IMAGE_FRAMECRC-yes)
 FATE_IMAGE += $(FATE_IMAGE-yes)
 FATE_IMAGE_PROBE += $(FATE_IMAGE_PROBE-yes)
@@ -22,6 +22,15 @@ FATE_LIBAVFORMAT-$(CONFIG_MOV_MUXER) += fate-movenc
 fate-movenc: libavformat/tests/movenc$(EXESUF)
 fate-movenc: CMD = run libavformat/tests/movenc$(EXESUF)
 
+FATE_LIBAVFORMAT-$(call ALLYES, MOV_MUXER MOV_DEMUXER FILE_PROTOCOL) += fate-movindexcache
+fate-movindexcache: libavformat/tests/movindexcache$(EXESUF)
+fate-movindexcache: CMD = run libavformat/tests/movindexcache$(EXESUF) $(TARGET_PATH)/tests/data/fate/movindexcache.mov
+
+FATE_LIBAVFORMAT_MMAP-$(call ALLYES, MOV_MUXER MOV_DEMUXER RAWVIDEO_DEMUXER FILE_PROTOCOL) += fate-filemmap
+fate-filemmap: libavformat/tests/filemmap$(EXESUF)
+fate-filemmap: CMD = run libavformat/tests/filemmap$(EXESUF) $(TARGET_PATH)/tests/data/fate/filemmap.mov $(TARGET_PATH)/tests/data/fate/filemmap.rgb
+FATE_LIBAVFORMAT-$(HAVE_MMAP) += $(FATE_LIBAVFORMAT_MMAP-yes)
+
 FATE_LIBAVFORMAT-$(CONFIG_IMF_DEMUXER) += fate-imf
 fate-imf: libavformat/tests/imf$(EXESUF)
 fate-imf: CMD = run libavformat/tests/imf$(EXESUF)
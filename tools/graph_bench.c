@@ -0,0 +1,153 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the per-frame scheduling overhead of large filter graphs.
+ *
+ * Each graph consists of a small color source split into a number of
+ * branches, every branch being a chain of null filters ending in its own
+ * buffersink. Frames are pulled from the sinks in turn, so the time spent per
+ * frame is dominated by the activation of the filters rather than by any
+ * actual processing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+
+static int build_graph(AVFilterGraph *graph, AVFilterContext **sinks,
+                       int nb_branches, int chain_len)
+{
+    AVFilterContext *src, *split;
+    char args[32];
+    int ret;
+
+    ret = avfilter_graph_create_filter(&src, avfilter_get_by_name("color"),
+                                       "src", "s=16x16:r=25", NULL, graph);
+    if (ret < 0)
+        return ret;
+
+    snprintf(args, sizeof(args), "%d", nb_branches);
+    ret = avfilter_graph_create_filter(&split, avfilter_get_by_name("split"),
+                                       "split", args, NULL, graph);
+    if (ret < 0)
+        return ret;
+    ret = avfilter_link(src, 0, split, 0);
+    if (ret < 0)
+        return ret;
+
+    for (int b = 0; b < nb_branches; b++) {
+        AVFilterContext *prev = split;
+        int prev_pad = b;
+
+        for (int i = 0; i < chain_len; i++) {
+            AVFilterContext *f;
+
+            ret = avfilter_graph_create_filter(&f, avfilter_get_by_name("null"),
+                                               NULL, NULL, NULL, graph);
+            if (ret < 0)
+                return ret;
+            ret = avfilter_link(prev, prev_pad, f, 0);
+            if (ret < 0)
+                return ret;
+            prev     = f;
+            prev_pad = 0;
+        }
+
+        ret = avfilter_graph_create_filter(&sinks[b],
+                                           avfilter_get_by_name("buffersink"),
+                                           NULL, NULL, NULL, graph);
+        if (ret < 0)
+            return ret;
+        ret = avfilter_link(prev, prev_pad, sinks[b], 0);
+        if (ret < 0)
+            return ret;
+    }
+
+    return avfilter_graph_config(graph, NULL);
+}
+
+static int run(int nb_branches, int chain_len, int nb_frames)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterContext **sinks = av_calloc(nb_branches, sizeof(*sinks));
+    AVFrame *frame = av_frame_alloc();
+    int64_t t0, t1;
+    int nb_filters, ret;
+
+    if (!graph || !sinks || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ret = build_graph(graph, sinks, nb_branches, chain_len);
+    if (ret < 0)
+        goto end;
+    nb_filters = graph->nb_filters;
+
+    t0 = av_gettime_relative();
+    for (int n = 0; n < nb_frames; n++) {
+        for (int b = 0; b < nb_branches; b++) {
+            ret = av_buffersink_get_frame(sinks[b], frame);
+            if (ret < 0)
+                goto end;
+            av_frame_unref(frame);
+        }
+    }
+    t1 = av_gettime_relative();
+
+    printf("%5d filters (%3d x %4d): %9.2f us/frame, %7.1f ns/filter\n",
+           nb_filters, nb_branches, chain_len,
+           (double)(t1 - t0) / nb_frames,
+           (t1 - t0) * 1000.0 / nb_frames / nb_filters);
+
+end:
+    if (ret < 0)
+        fprintf(stderr, "Error running a %d x %d graph: %s\n",
+                nb_branches, chain_len, av_err2str(ret));
+    av_frame_free(&frame);
+    av_freep(&sinks);
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    static const int chain_lens[] = { 8, 32, 128, 512 };
+    int nb_branches = argc > 1 ? atoi(argv[1]) : 4;
+    int nb_frames   = argc > 2 ? atoi(argv[2]) : 500;
+
+    if (nb_branches < 1 || nb_frames < 1) {
+        fprintf(stderr, "Usage: %s [branches] [frames]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(chain_lens); i++)
+        if (run(nb_branches, chain_lens[i], nb_frames) < 0)
+            return 1;
+
+    return 0;
+}